@@ -3,6 +3,9 @@
 
 #include <unordered_map>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
@@ -15,6 +18,18 @@ class Algorithm {
 public:
     virtual void offline_industry() = 0;
     virtual bool reachability_query(int source, int target) = 0;
+    // 批量查询，第 i 个查询的结果写到 out[i]，1 可达 0 不可达。num_threads <= 0 时用硬件线程数
+    // 默认实现逐个调用 reachability_query，单线程执行；查询只读的算法各自重写成多线程版本
+    virtual void reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int /*num_threads*/ = 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = reachability_query(queries[i].first, queries[i].second) ? 1 : 0;
+    }
+    void reachability_query_batch(const std::vector<std::pair<int, int>> &queries, std::vector<uint8_t> &out, int num_threads = 0)
+    {
+        out.resize(queries.size());
+        reachability_query_batch(queries.data(), queries.size(), out.data(), num_threads);
+    }
     // 声明测量索引大小的纯虚函数，返回索引名称与大小的键值对
     virtual std::vector<std::pair<std::string, std::string>> getIndexSizes() const = 0;
     virtual ~Algorithm() = default;
@@ -3,6 +3,8 @@
 
 #include "graph.h"
 #include "CSR.h"
+#include "CompressedCSR.h"
+#include "SearchContext.h"
 #include "Algorithm.h"
 #include <vector>
 #include <queue>
@@ -12,26 +14,43 @@
 class BiBFSCSR : public Algorithm {
 public:
     BiBFSCSR(Graph& graph);
+    // 直接用已经加载好的 CSR（例如 CSRGraph::fromBinary 读入的），不需要 Graph
+    explicit BiBFSCSR(shared_ptr<CSRGraph> csr);
+    // 在压缩的 CSR 上搜索，邻居边走边解码
+    explicit BiBFSCSR(shared_ptr<CompressedCSR> compressed);
 
     // bool reachability(int source, int target) override;
 
     void offline_industry() override{}
 
+    // 用当前线程的 SearchContext::local()，可以多个线程同时调用
     bool reachability_query(int source, int target) override;
+    // 显式传入搜索状态，context 里的位图引擎在同一个 CSR 上的多次查询之间复用
+    bool reachability_query(int source, int target, SearchContext &context) const;
+
+    // 批量查询，每个线程一个 SearchContext，在整个批次中复用
+    using Algorithm::reachability_query_batch;
+    void reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads = 0) override;
 
     // 找路径是否可达，如果可达返回路径，否则返回空。第三个参数，分区内搜索的时候要设置成true
-    std::vector<int> findPath(int source, int target, int partition_number = -1); 
+    std::vector<int> findPath(int source, int target, int partition_number = -1);
+    std::vector<int> findPath(int source, int target, int partition_number, SearchContext &context) const;
     std::vector<std::pair<std::string, std::string>> getIndexSizes() const override {
-        return {{"G'CSR", std::to_string(csr->getMemoryUsage())}};
+        return {{"G'CSR", std::to_string(compressed ? compressed->getMemoryUsage() : csr->getMemoryUsage())}};
     }
 
     shared_ptr<CSRGraph> getCSR() {
         return csr;
     }
 
+    shared_ptr<CompressedCSR> getCompressedCSR() {
+        return compressed;
+    }
+
 private:
-    Graph& g;
+    Graph* g; ///< 从 CSR 构造时为空
     shared_ptr<CSRGraph> csr;
+    shared_ptr<CompressedCSR> compressed; ///< 不为空时在它上面搜索，csr 为空
 
 };
 
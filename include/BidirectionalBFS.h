@@ -3,10 +3,11 @@
 
 #include "graph.h"
 #include "CSR.h"
+#include "CompressedCSR.h"
 #include "Algorithm.h"
+#include "SearchContext.h"
 #include <vector>
-#include <queue>
-#include <unordered_set>
+#include <memory>
 
 class BidirectionalBFS : public Algorithm {
 public:
@@ -16,10 +17,19 @@ public:
 
     void offline_industry() override;
 
+    // 把邻接表换成压缩的 CSR（见 CompressedCSR），之后的查询边走边解码，offline_industry 会恢复成邻接表
+    void compress_adjacency();
+
+    // 用当前线程的 SearchContext::local()，可以多个线程同时调用
     bool reachability_query(int source, int target) override;
+    // 显式传入搜索状态，访问标记和队列在多次查询之间复用
+    bool reachability_query(int source, int target, SearchContext &context) const;
+    // 只经过 partition_number 分区里的点（-1 表示不限），只判断可达，不记父节点也不生成路径
+    bool reachability_query(int source, int target, int partition_number, SearchContext &context) const;
 
     // 找路径是否可达，如果可达返回路径，否则返回空。第三个参数，分区内搜索的时候要设置成true
-    std::vector<int> findPath(int source, int target, int partition_number = -1); 
+    std::vector<int> findPath(int source, int target, int partition_number = -1);
+    std::vector<int> findPath(int source, int target, int partition_number, SearchContext &context) const;
     std::vector<std::pair<std::string, std::string>> getIndexSizes() const override {
         return {};
     }
@@ -29,11 +39,19 @@ private:
     CSRGraph csr;
     std::vector<std::vector<int>> adjList;         // 正向邻接表
     std::vector<std::vector<int>> reverseAdjList;  // 逆邻接表
+    std::unique_ptr<CompressedCSR> compressed;     // 不为空时代替两个邻接表
 
     void buildAdjList();
-    bool bfsStep(std::queue<int>& queue, std::unordered_set<int>& visited, 
-                 std::unordered_set<int>& opposite_visited, 
-                 const std::vector<std::vector<int>>& adjList); // 增加邻接表参数，用于选择正向或逆向邻接表
+    // neighbors_of(u) 返回 u 的邻居序列，用于选择正向或逆向邻接表，以及压缩的 CSR
+    // accept(v) 为假的邻居不扩展，用于分区内搜索
+    template <typename Neighbors, typename Accept>
+    static bool bfsStep(SearchContext &context, int side, Neighbors &&neighbors_of, Accept &&accept);
+    template <typename Out, typename In>
+    bool reachable(int source, int target, int partition_number, size_t num_nodes, SearchContext &context,
+                   Out &&out_neighbors, In &&in_neighbors) const;
+    template <typename Out, typename In>
+    std::vector<int> find_path(int source, int target, int partition_number, SearchContext &context,
+                               Out &&out_neighbors, In &&in_neighbors) const;
 };
 
 #endif  // BIDIRECTIONAL_BFS_H
@@ -0,0 +1,231 @@
+#ifndef BITMAP_BIBFS_H
+#define BITMAP_BIBFS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+/**
+ * @brief 按层同步的双向 BFS，访问标记和自底向上用的当前层都是位图。
+ * 每一轮只扩展一侧的一整层，选当前层出边（反向一侧是入边）总数少的那一侧。
+ * 一侧的当前层很大时改成自底向上（Beamer 的 direction-optimizing BFS）：不从当前层往外推，
+ * 而是扫所有还没访问的点，看它的反向邻居里有没有在当前层的，找到一个就停。
+ *   当前层边数 > 剩余未扫过的边数 / ALPHA 时切到自底向上，当前层点数 < 点数 / BETA 时切回自顶向下
+ * reachable 只判断可达，不记录父节点；find_path 额外记录父节点并拼出路径。
+ * 两次查询之间只清掉上次访问过的点，不整段清零。一个对象不能被多个线程同时使用。
+ * Adjacency 是 CSRGraph 或 CompressedCSR，需要 max_node_id、num_edges、outNeighbors、inNeighbors。
+ */
+template <typename Adjacency>
+class BitmapBiBFS
+{
+public:
+    static constexpr uint64_t ALPHA = 14;
+    static constexpr uint64_t BETA = 24;
+
+    explicit BitmapBiBFS(const Adjacency &adjacency)
+        : adjacency_(adjacency), n_(static_cast<size_t>(adjacency.max_node_id) + 1), words_((n_ + 63) / 64)
+    {
+        forward_.forward = true;
+        backward_.forward = false;
+        for (Side *side : {&forward_, &backward_})
+        {
+            side->visited.assign(words_, 0);
+            side->frontier_bits.assign(words_, 0);
+        }
+    }
+
+    // 建立时的点数，图加了点之后要重新建
+    size_t size() const { return n_; }
+    const Adjacency &adjacency() const { return adjacency_; }
+
+    bool reachable(int source, int target)
+    {
+        uint32_t meet;
+        return run<false>(source, target, meet);
+    }
+
+    // 不可达时返回空，source == target 时返回 {source}
+    std::vector<int> find_path(int source, int target)
+    {
+        uint32_t meet;
+        if (!run<true>(source, target, meet))
+            return {};
+        if (source == target)
+            return {source};
+        std::vector<int> path;
+        for (uint32_t node = meet; node != NONE; node = forward_.parent[node])
+            path.push_back(static_cast<int>(node));
+        std::reverse(path.begin(), path.end());
+        for (uint32_t node = backward_.parent[meet]; node != NONE; node = backward_.parent[node])
+            path.push_back(static_cast<int>(node));
+        return path;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Side
+    {
+        bool forward = true;
+        std::vector<uint64_t> visited;
+        std::vector<uint64_t> frontier_bits; ///< 只在自底向上的那一层里有内容
+        std::vector<uint32_t> frontier;
+        std::vector<uint32_t> next;
+        std::vector<uint32_t> touched;       ///< 这次查询访问过的点，下次开始时按它清标记
+        std::vector<uint32_t> parent;        ///< 只有 find_path 用，访问过的点才有意义
+        uint64_t frontier_edges = 0;
+        uint64_t explored_edges = 0;
+        bool bottom_up = false;
+    };
+
+    const Adjacency &adjacency_;
+    size_t n_;
+    size_t words_;
+    Side forward_;
+    Side backward_;
+
+    static bool test(const std::vector<uint64_t> &bits, uint32_t v) { return (bits[v >> 6] >> (v & 63)) & 1; }
+    static void set(std::vector<uint64_t> &bits, uint32_t v) { bits[v >> 6] |= uint64_t(1) << (v & 63); }
+    static void reset(std::vector<uint64_t> &bits, uint32_t v) { bits[v >> 6] &= ~(uint64_t(1) << (v & 63)); }
+
+    // 这一侧往外扩展用的边数
+    uint32_t degree(const Side &side, uint32_t v) const
+    {
+        return side.forward ? adjacency_.outNeighbors(v).size() : adjacency_.inNeighbors(v).size();
+    }
+
+    template <bool TrackParents>
+    void visit(Side &side, uint32_t v, uint32_t parent)
+    {
+        set(side.visited, v);
+        side.touched.push_back(v);
+        if (TrackParents)
+            side.parent[v] = parent;
+    }
+
+    void clear(Side &side)
+    {
+        for (uint32_t v : side.touched)
+            reset(side.visited, v);
+        side.touched.clear();
+        side.frontier.clear();
+        side.next.clear();
+        side.explored_edges = 0;
+        side.bottom_up = false;
+    }
+
+    template <bool TrackParents>
+    bool run(int source, int target, uint32_t &meet)
+    {
+        if (source == target)
+            return true;
+        if (source < 0 || target < 0 || static_cast<size_t>(source) >= n_ || static_cast<size_t>(target) >= n_)
+            return false;
+        clear(forward_);
+        clear(backward_);
+        if (TrackParents && forward_.parent.empty())
+        {
+            forward_.parent.resize(n_);
+            backward_.parent.resize(n_);
+        }
+        visit<TrackParents>(forward_, source, NONE);
+        visit<TrackParents>(backward_, target, NONE);
+        forward_.frontier.push_back(source);
+        backward_.frontier.push_back(target);
+        forward_.frontier_edges = degree(forward_, source);
+        backward_.frontier_edges = degree(backward_, target);
+
+        while (!forward_.frontier.empty() && !backward_.frontier.empty())
+        {
+            bool forward_cheaper = forward_.frontier_edges <= backward_.frontier_edges;
+            Side &side = forward_cheaper ? forward_ : backward_;
+            Side &opposite = forward_cheaper ? backward_ : forward_;
+            if (expand<TrackParents>(side, opposite, meet))
+                return true;
+        }
+        return false;
+    }
+
+    // 扩展 side 的一层，碰到 opposite 访问过的点时把它写到 meet 并返回 true
+    template <bool TrackParents>
+    bool expand(Side &side, const Side &opposite, uint32_t &meet)
+    {
+        side.explored_edges += side.frontier_edges;
+        uint64_t remaining = adjacency_.num_edges > side.explored_edges ? adjacency_.num_edges - side.explored_edges : 0;
+        if (!side.bottom_up && side.frontier_edges * ALPHA > remaining)
+            side.bottom_up = true;
+        else if (side.bottom_up && side.frontier.size() * BETA < n_)
+            side.bottom_up = false;
+
+        side.next.clear();
+        uint64_t next_edges = 0;
+        bool met = false;
+        if (!side.bottom_up)
+        {
+            for (uint32_t u : side.frontier)
+            {
+                auto neighbors = side.forward ? adjacency_.outNeighbors(u) : adjacency_.inNeighbors(u);
+                for (uint32_t v : neighbors)
+                {
+                    if (test(side.visited, v))
+                        continue;
+                    visit<TrackParents>(side, v, u);
+                    if (test(opposite.visited, v))
+                    {
+                        meet = v;
+                        return true;
+                    }
+                    side.next.push_back(v);
+                    next_edges += degree(side, v);
+                }
+            }
+        }
+        else
+        {
+            for (uint32_t u : side.frontier)
+                set(side.frontier_bits, u);
+            for (size_t w = 0; w < words_ && !met; ++w)
+            {
+                uint64_t unvisited = ~side.visited[w];
+                while (unvisited)
+                {
+                    uint32_t v = static_cast<uint32_t>(w * 64 + __builtin_ctzll(unvisited));
+                    unvisited &= unvisited - 1;
+                    if (v >= n_)
+                        break;
+                    // 正向一侧看入边的起点是否在当前层，反向一侧看出边
+                    auto neighbors = side.forward ? adjacency_.inNeighbors(v) : adjacency_.outNeighbors(v);
+                    for (uint32_t u : neighbors)
+                    {
+                        if (!test(side.frontier_bits, u))
+                            continue;
+                        visit<TrackParents>(side, v, u);
+                        if (test(opposite.visited, v))
+                        {
+                            meet = v;
+                            met = true;
+                        }
+                        else
+                        {
+                            side.next.push_back(v);
+                            next_edges += degree(side, v);
+                        }
+                        break;
+                    }
+                    if (met)
+                        break;
+                }
+            }
+            for (uint32_t u : side.frontier)
+                reset(side.frontier_bits, u);
+            if (met)
+                return true;
+        }
+        side.frontier.swap(side.next);
+        side.frontier_edges = next_edges;
+        return false;
+    }
+};
+
+#endif // BITMAP_BIBFS_H
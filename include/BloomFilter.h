@@ -11,6 +11,8 @@ public:
     BloomFilter(Graph& graph);
     void offline_industry() override;
     bool reachability_query(int source, int target) override;
+    using Algorithm::reachability_query_batch;
+    void reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads = 0) override;
     double false_positive_rate(int vertex); // 计算某个顶点的假阳性率
     std::vector<std::pair<std::string, std::string>> getIndexSizes() const override; // 计算索引大小
 
@@ -21,6 +23,7 @@ private:
     std::vector<size_t> insertedElements; // 记录每个顶点插入的元素数量
 
     std::vector<size_t> generateHashes(int key) const;
+    bool contains(int source, int target) const; // 不做越界检查的查询
 };
 
 #endif // BLOOM_FILTER_H
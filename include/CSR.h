@@ -20,6 +20,11 @@ public:
     uint32_t* in_column_indices;   // 存储入边的列索引
     uint32_t* in_row_pointers;     // 存储入边的每一行的起始位置索引
 
+    // 动态模式下每行实际的边数，为空时是紧凑的 CSR。动态模式下 [row_pointers[u], row_pointers[u] + degree)
+    // 是 u 的边，到 row_pointers[u + 1] 之前是留给插入的空隙，直接访问数组时要用 getOutDegree/getInDegree 取行长
+    uint32_t* out_degrees;
+    uint32_t* in_degrees;
+
     // 节点的分区信息
     int16_t* partitions;           // 存储每个节点的分区号，预设值为 -1
 
@@ -31,25 +36,51 @@ public:
     CSRGraph()
         : out_column_indices(nullptr), out_row_pointers(nullptr),
           in_column_indices(nullptr), in_row_pointers(nullptr),
+          out_degrees(nullptr), in_degrees(nullptr),
           partitions(nullptr), max_node_id(0), num_edges(0), num_nodes(0) {}
 
     // 析构函数
     ~CSRGraph() {
-        delete[] out_column_indices;
-        delete[] out_row_pointers;
-        delete[] in_column_indices;
-        delete[] in_row_pointers;
-        delete[] partitions;
+        release();
     }
 
     // 创建空的CSR图
     bool createEmptyCSR(uint32_t num_vertices);
 
     // 从边集文件中读取图数据并构建 CSR 结构
-    bool fromFile(const std::string& filename);
+    // 出边和入边由多个线程一起构建，num_threads <= 0 时用硬件线程数，边少时自动减少线程
+    bool fromFile(const std::string& filename, int num_threads = 0);
+
+    //  从现有的图创建CSR结构，num_threads 同 fromFile
+    bool fromGraph(const Graph& graph, int num_threads = 0);
+
+    /**
+     * 二进制 CSR 文件，写一次之后可以直接 mmap 只读加载，不用再解析文本。格式（版本 1，本机字节序）：
+     *   文件头 72 字节：char[8] "RCCSR" | uint32 版本 | uint32 文件头长度 | uint32 max_node_id | uint32 num_nodes
+     *                  | uint32 num_edges | uint32 保留 | uint64 out_row/in_row/out_col/in_col/partitions 五段的文件偏移
+     *   各段按 64 字节对齐：out_row_pointers[max_node_id+2]、in_row_pointers[max_node_id+2]、
+     *   out_column_indices[num_edges]、in_column_indices[num_edges]、partitions[max_node_id+1]
+     */
+    bool saveBinary(const std::string& filename) const;
+
+    // mmap 加载二进制 CSR，私有映射，修改分区号只会复制被改的页，不会写回文件
+    bool fromBinary(const std::string& filename);
+
+    // 数组是否来自 mmap
+    bool isMapped() const { return mapped_addr != nullptr; }
+
+    /**
+     * 转成动态模式：每行末尾留出空隙，插边时只在行内移动。行满了按 PMA（packed memory array）的方式
+     * 依次找包含它的 2、4、8... 行的对齐窗口，窗口密度低于阈值时在窗口内按度数重新分配空隙，
+     * 整个数组都超过阈值时扩容一倍，插入的均摊代价是 O(log^2 |V| + 度数)。删边只在行内移动。
+     * 每行仍然连续，getOutgoingEdges/getIncomingEdges 的用法不变。addEdge/removeEdge 第一次调用时会自动转换。
+     */
+    void enableDynamic();
 
-    //  从现有的图创建CSR结构
-    bool fromGraph(const Graph& graph);
+    // 去掉空隙，转回紧凑的 CSR
+    void compact();
+
+    bool isDynamic() const { return out_degrees != nullptr; }
 
     // 获取某个节点的所有出边
     uint32_t* getOutgoingEdges(uint32_t node, uint32_t& degree) const;
@@ -57,6 +88,28 @@ public:
     // 获取某个节点的所有入边
     uint32_t* getIncomingEdges(uint32_t node, uint32_t& degree) const;
 
+    // 一行邻居的区间，可以直接 range-for，和 CompressedCSR::NeighborRange 的用法相同
+    struct NeighborRange {
+        const uint32_t* first;
+        const uint32_t* last;
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+        uint32_t size() const { return static_cast<uint32_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    NeighborRange outNeighbors(uint32_t node) const {
+        if (node > max_node_id) return {nullptr, nullptr};
+        const uint32_t* first = out_column_indices + out_row_pointers[node];
+        return {first, first + (out_degrees ? out_degrees[node] : out_row_pointers[node + 1] - out_row_pointers[node])};
+    }
+
+    NeighborRange inNeighbors(uint32_t node) const {
+        if (node > max_node_id) return {nullptr, nullptr};
+        const uint32_t* first = in_column_indices + in_row_pointers[node];
+        return {first, first + (in_degrees ? in_degrees[node] : in_row_pointers[node + 1] - in_row_pointers[node])};
+    }
+
     // 获取某个节点的出度
     uint32_t getOutDegree(uint32_t node) const;
 
@@ -106,7 +159,14 @@ public:
     void resetNodesNum(){};
 
 private:
-
+    // mmap 的区域，为空时各数组是 new 出来的
+    void* mapped_addr = nullptr;
+    size_t mapped_bytes = 0;
+
+    // 释放所有数组
+    void release();
+    // 增删点和边会重新分配数组，之前先把 mmap 的数据复制到堆上
+    void detachMapping();
 };
 
 #endif // CSR_H
\ No newline at end of file
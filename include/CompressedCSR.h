@@ -0,0 +1,125 @@
+#ifndef COMPRESSED_CSR_H
+#define COMPRESSED_CSR_H
+
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include "CSR.h"
+
+/**
+ * @brief 压缩的出边和入边 CSR，每行升序的邻居差分后存成变长整数（LEB128，每字节 7 位，最高位表示后面还有字节）。
+ * 一行的字节串：varint(度数) | varint(zigzag(第一个邻居 - 行号)) | varint(相邻两个邻居之差 - 1) ...
+ * 行偏移是 uint32_t，度数就是行首的一个 varint，取度数和行首都是 O(1)，遍历邻居时边走边解码。
+ * 邻居点号越集中（例如重排过的图），差值越小，多数一个字节就能放下，原来每条边固定占 4 字节。
+ *
+ * 接口和 CSRGraph 对齐：getOutDegree/getInDegree/getPartition/nodeExist，以及返回邻居序列的
+ * outNeighbors/inNeighbors，搜索和划分的代码对两种存储写一份模板即可。
+ */
+class CompressedCSR {
+public:
+    // 顺序解码一行的迭代器，只能向前走
+    class NeighborIterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+        NeighborIterator() = default;
+        NeighborIterator(const uint8_t* bytes, uint32_t remaining, uint32_t value)
+            : bytes_(bytes), remaining_(remaining), value_(value) {}
+
+        uint32_t operator*() const { return value_; }
+        NeighborIterator& operator++() {
+            if (--remaining_ > 0) value_ += decode(bytes_) + 1;
+            return *this;
+        }
+        // 同一行的迭代器只按剩余个数比较
+        bool operator==(const NeighborIterator& other) const { return remaining_ == other.remaining_; }
+        bool operator!=(const NeighborIterator& other) const { return remaining_ != other.remaining_; }
+
+    private:
+        const uint8_t* bytes_ = nullptr;
+        uint32_t remaining_ = 0;
+        uint32_t value_ = 0;
+    };
+
+    struct NeighborRange {
+        NeighborIterator first;
+        uint32_t degree;
+        NeighborIterator begin() const { return first; }
+        NeighborIterator end() const { return NeighborIterator(); }
+        uint32_t size() const { return degree; }
+        bool empty() const { return degree == 0; }
+    };
+
+    // 从紧凑或动态模式的 CSRGraph 压缩，字节数超过 uint32_t 能表示的范围时返回 false
+    bool fromCSR(const CSRGraph& csr);
+
+    bool fromGraph(const Graph& graph);
+
+    // 解压回普通的 CSRGraph
+    void toCSR(CSRGraph& csr) const;
+
+    uint32_t getOutDegree(uint32_t node) const { return degree(out_, node); }
+    uint32_t getInDegree(uint32_t node) const { return degree(in_, node); }
+
+    NeighborRange outNeighbors(uint32_t node) const { return row(out_, node); }
+    NeighborRange inNeighbors(uint32_t node) const { return row(in_, node); }
+
+    int getPartition(uint32_t node) const {
+        if (node >= partitions_.size()) return -1;
+        return partitions_[node];
+    }
+
+    bool nodeExist(uint32_t node) const { return getOutDegree(node) > 0 || getInDegree(node) > 0; }
+
+    // 行偏移、字节串和分区数组占的字节数
+    uint64_t getMemoryUsage() const;
+
+    uint32_t max_node_id = 0;
+    uint32_t num_edges = 0;
+    uint32_t num_nodes = 0;
+
+    // 读一个 varint 并前移指针
+    static uint32_t decode(const uint8_t*& bytes) {
+        uint32_t value = *bytes++;
+        if (value < 0x80) return value;
+        value &= 0x7f;
+        for (int shift = 7;; shift += 7) {
+            uint32_t byte = *bytes++;
+            value |= (byte & 0x7f) << shift;
+            if (byte < 0x80) return value;
+        }
+    }
+
+private:
+    struct Direction {
+        std::vector<uint32_t> offsets; ///< max_node_id + 1 项
+        std::vector<uint8_t> bytes;
+    };
+    Direction out_;
+    Direction in_;
+    std::vector<int16_t> partitions_;
+
+    static uint32_t degree(const Direction& direction, uint32_t node) {
+        if (node >= direction.offsets.size()) return 0;
+        const uint8_t* bytes = direction.bytes.data() + direction.offsets[node];
+        return decode(bytes);
+    }
+    static NeighborRange row(const Direction& direction, uint32_t node) {
+        if (node >= direction.offsets.size()) return {NeighborIterator(), 0};
+        const uint8_t* bytes = direction.bytes.data() + direction.offsets[node];
+        uint32_t count = decode(bytes);
+        if (count == 0) return {NeighborIterator(), 0};
+        uint32_t zigzag = decode(bytes);
+        int64_t first = int64_t(node) + (int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1));
+        return {NeighborIterator(bytes, count, static_cast<uint32_t>(first)), count};
+    }
+    // 把 csr 一个方向的所有行编码到 direction，超过 4GB 时返回 false
+    static bool encode(const uint32_t* row_pointers, const uint32_t* degrees, const uint32_t* columns,
+                       uint32_t rows, Direction& direction);
+};
+
+#endif // COMPRESSED_CSR_H
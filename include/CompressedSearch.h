@@ -2,7 +2,6 @@
 #ifndef COMPRESSED_SEARCH_H
 #define COMPRESSED_SEARCH_H
 #include <sstream>
-#include <bitset>
 #include <memory>
 #include <unordered_map>
 #include "pll.h"
@@ -17,6 +16,8 @@
 #include "BidirectionalBFS.h"
 #include "BiBFSCSR.h"
 #include "TreeCover.h"
+#include "QueryTrace.h"
+#include "utils/BitMatrix.h"
 
 using namespace std;
 /**
@@ -45,9 +46,9 @@ public:
     }
     ~CompressedSearch() override
     {
-        for (auto &pll : pll_index_)
+        for (auto *pll : pll_index_)
         {
-            delete pll.second;
+            delete pll;
         }
         //delete csr;
     }
@@ -59,10 +60,43 @@ public:
 
     void offline_industry(size_t num_vertices, float ratio, string mapping_file = "");
 
+    /**
+     * @brief 等价信息已经在内存里（SCCCondenser 的结果）时使用，g 应当是压缩后的 DAG。
+     * @param equivalence 每个原图点所在强连通分量的代表点
+     */
+    void offline_industry(size_t num_vertices, float ratio, const std::vector<uint32_t> &equivalence);
+
     bool reachability_query(int source, int target) override;
 
+    // 批量查询，每个线程用自己的 QueryScratch，不记录查询阶段耗时
+    using Algorithm::reachability_query_batch;
+    void reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads = 0) override;
+
     std::vector<std::string> get_index_info();
 
+    /**
+     * @brief 最近一次建分区索引时每个分区的耗时，按耗时从大到小排列。
+     */
+    std::vector<std::string> get_build_report() const;
+
+    // 建分区索引和分区连接图 PLL 用的线程数，<= 0 时使用硬件线程数
+    // 不调用时分区索引用硬件线程数，分区连接图 PLL 仍然逐个构建
+    void set_build_threads(int num_threads)
+    {
+        this->build_threads_ = num_threads;
+        this->boundary_build_threads_ = num_threads;
+    }
+    // 分区内 PLL 和分区连接图 PLL 的路标点顺序
+    void set_landmark_strategy(LandmarkOrdering::Strategy strategy)
+    {
+        this->landmark_strategy_ = strategy;
+    }
+    // 建完分区内 PLL 和分区连接图 PLL 之后把标签压缩（见 PLLLabelStore），分区多时省内存，查询略慢
+    void set_compress_labels(bool compress)
+    {
+        this->compress_labels_ = compress;
+    }
+
 
     PartitionManager &get_partition_manager()
     {
@@ -71,6 +105,15 @@ public:
 
     BidirectionalBFS bfs; ///< 原图上的双向BFS算法。
 
+    /**
+     * @brief 设置查询阶段耗时的记录缓冲区，传 nullptr 关闭。
+     * 只有编译时定义了 REACH_QUERY_TRACE 才会真正记录，否则查询路径上不做任何事。
+     */
+    void set_query_trace(QueryTraceBuffer *trace)
+    {
+        this->scratch_.trace = trace;
+    }
+
 std::vector<std::pair<std::string, std::string>> getIndexSizes() const override
 {
     std::vector<std::pair<std::string, std::string>> index_sizes;
@@ -82,13 +125,21 @@ std::vector<std::pair<std::string, std::string>> getIndexSizes() const override
     index_sizes.emplace_back("PLL_out_pointers", "0");
     index_sizes.emplace_back("PLL_in_sets", "0");
     index_sizes.emplace_back("PLL_out_sets", "0");
+    index_sizes.emplace_back("PLL_bit_parallel", "0");
+    index_sizes.emplace_back("PLL_compressed_labels", "0");
+    index_sizes.emplace_back("PLL_compressed_offsets", "0");
+    index_sizes.emplace_back("PLL_compressed_bit_parallel", "0");
     index_sizes.emplace_back("Reachable Matrix", "0");
     index_sizes.emplace_back("Unreachable Index", "0");
     index_sizes.emplace_back("Total", "0");
 
-    // 计算 PLL 索引的大小
-    for (const auto &pll : pll_index_) {
-        auto pll_sizes = pll.second->getIndexSizes();
+    // 计算 PLL 索引的大小，分区内的 PLL 和出入口图上的 PLL 都算
+    std::vector<const PLL *> plls(pll_index_.begin(), pll_index_.end());
+    plls.push_back(pll_connect_g.get());
+    for (const auto *pll : plls) {
+        if (pll == nullptr)
+            continue;
+        auto pll_sizes = pll->getIndexSizes();
         for (const auto &size : pll_sizes) {
             if (size.first == "in_pointers") {
                 index_sizes[4].second = std::to_string(std::stoull(index_sizes[4].second) + std::stoull(size.second));
@@ -98,20 +149,27 @@ std::vector<std::pair<std::string, std::string>> getIndexSizes() const override
                 index_sizes[6].second = std::to_string(std::stoull(index_sizes[6].second) + std::stoull(size.second));
             } else if (size.first == "out_sets") {
                 index_sizes[7].second = std::to_string(std::stoull(index_sizes[7].second) + std::stoull(size.second));
+            } else if (size.first == "bit_parallel") {
+                index_sizes[8].second = std::to_string(std::stoull(index_sizes[8].second) + std::stoull(size.second));
+            } else if (size.first == "compressed_labels") {
+                index_sizes[9].second = std::to_string(std::stoull(index_sizes[9].second) + std::stoull(size.second));
+            } else if (size.first == "compressed_offsets") {
+                index_sizes[10].second = std::to_string(std::stoull(index_sizes[10].second) + std::stoull(size.second));
+            } else if (size.first == "compressed_bit_parallel") {
+                index_sizes[11].second = std::to_string(std::stoull(index_sizes[11].second) + std::stoull(size.second));
             }
         }
     }
 
     // 计算小分区索引的大小
-    for (const auto &small_index : small_index_) {
-        int a = small_index.second.size();
-        index_sizes[8].second = std::to_string(std::stoull(index_sizes[8].second) + a * a);
+    for (const auto &matrix : small_index_) {
+        index_sizes[12].second = std::to_string(std::stoull(index_sizes[12].second) + matrix.getMemoryUsage());
     }
 
     // 计算不可达索引的大小
     for (const auto &unreachable_index : unreachable_index_) {
-        for (const auto &row : unreachable_index.second) {
-            index_sizes[9].second = std::to_string(std::stoull(index_sizes[9].second) + row.size() * sizeof(size_t));
+        for (const auto &row : unreachable_index) {
+            index_sizes[13].second = std::to_string(std::stoull(index_sizes[13].second) + row.size() * sizeof(uint32_t));
         }
     }
 
@@ -137,7 +195,7 @@ std::vector<std::pair<std::string, std::string>> getIndexSizes() const override
     index_sizes[4].second = std::to_string(partition_connection_memory);
 
     // 计算等价类大小
-    if (partition_manager_.equivalence_mapping != nullptr) {
+    if (partition_manager_.has_equivalence_info()) {
         index_sizes[0].second = std::to_string(std::stoull(index_sizes[0].second) + partition_manager_.get_equivalence_mapping_size());
     }
 
@@ -145,7 +203,7 @@ std::vector<std::pair<std::string, std::string>> getIndexSizes() const override
     for (const auto &i : index_sizes) {
         total += std::stoull(i.second);
     }
-    index_sizes[11].second = std::to_string(total);
+    index_sizes[15].second = std::to_string(total);
 
     return index_sizes;
 }
@@ -160,21 +218,81 @@ std::vector<std::pair<std::string, std::string>> getIndexSizes() const override
     size_t num_vertices = 0;
 
 private:
+    // 过滤器类型，查询时用枚举判断，避免每次做字符串比较
+    enum class FilterKind
+    {
+        None,
+        Unreachable,
+        Reachable
+    };
+
+    /**
+     * @brief 查询过程中的临时空间，离线阶段按分区数预先分配，在线查询只复用不再申请内存。
+     */
+    struct QueryScratch
+    {
+        std::vector<int> source_set;       ///< 源点能到达的出口点
+        std::vector<int> target_set;       ///< 能到达目标点的入口点
+        std::vector<uint32_t> hub_mark;    ///< 出入口图上 PLL 的中转点标记，存的是查询轮次
+        uint32_t hub_round = 0;            ///< 当前查询轮次
+        QueryTraceBuffer *trace = nullptr; ///< 阶段耗时记录，可为空
+    };
+
+    // 分区内索引的类型，建索引时确定，查询时不再看子图的点数和可达比例
+    enum class PartitionIndexKind : uint8_t
+    {
+        None,
+        Small,
+        PLL,
+        Unreachable
+    };
+
+    // 建分区索引时每个线程自己的BFS标记和队列
+    struct BuildScratch
+    {
+        std::vector<uint32_t> visited;
+        std::vector<uint32_t> queue;
+    };
+
+    // 一个分区建索引的记录
+    struct PartitionBuildStat
+    {
+        int partition_id = -1;
+        PartitionIndexKind kind = PartitionIndexKind::None;
+        uint32_t num_vertices = 0;
+        uint32_t num_edges = 0;
+        int thread_id = 0;
+        double seconds = 0;
+    };
+
+    // 每个分区所有的出口点和入口点，升序去重，按分区号下标
+    struct BoundaryNodes
+    {
+        std::vector<int> exits;
+        std::vector<int> entries;
+    };
+
+    bool query(int origin_source, int origin_target, QueryScratch &scratch);
+    void prepare_query_scratch(QueryScratch &scratch) const;
+
+    void build_offline_index(size_t num_vertices, float ratio);                  ///< 读完等价信息后的离线流程
     void partition_graph();                                                      ///< 图分区算法
     bool query_within_partition(int source, int target);                         ///< 同分区查询
     bool query_index_within_partition(int source, int target, int partition_id); ///< 同分区查询
-    bool query_across_partitions(int source, int target);                        ///< 跨分区查询
-    bool query_across_partitions_with_all_paths(int source, int target);
-    bool dfs_paths_search(int current_partition, int target_partition, std::vector<int> &path, std::vector<std::vector<int>> &all_paths, std::unordered_set<int> &visited, int source, int target);
-    bool dfs_partition_search(int u, std::vector<std::pair<int, int>> edges, std::vector<int> path, int target);
-    bool part_connection_graph_search(std::vector<int> path, int source, int target);
+    bool query_intra_probe(int source, int target, int partition_id);             ///< 分区内查询，按 is_index 选索引或BFS
+    bool query_across_partitions(int source, int target, QueryScratch &scratch); ///< 经出入口点的跨分区查询
     void build_partition_index(float ratio, size_t num_vertices); ///< 构建分区索引
+    PartitionIndexKind build_single_partition_index(int partition_id, BuildScratch &scratch); ///< 构建一个分区的索引
+    PartitionIndexKind get_index_kind(int partition_id) const;
+    void build_boundary_index();                                  ///< 构建出入口点集合和出入口图上的PLL
     void construct_filter(float ratio);
-    bool set_reachability(vector<int> source_set, vector<int> target_set);
+    bool set_reachability(const vector<int> &source_set, const vector<int> &target_set, QueryScratch &scratch) const;
 
     // std::unique_ptr<BidirectionalBFS> part_bfs;           ///< 分区图上的双向BFS类。
     std::unique_ptr<Algorithm> filter; ///< 过滤器，看a来实现
     std::string filter_name_;
+    FilterKind filter_kind_ = FilterKind::None;
+    QueryScratch scratch_; ///< 单线程查询使用的临时空间
     std::unique_ptr<BidirectionalBFS> part_bfs;
     std::unique_ptr<BiBFSCSR> part_bfs_csr;
     Graph &g; ///< 处理的图。
@@ -183,11 +301,19 @@ private:
     std::unique_ptr<GraphPartitioner> partitioner_; ///< 图分区器，支持多种分区算法。
     std::string partitioner_name_;
     shared_ptr<PLL> pll_connect_g; ///< 分区间的联系的可达查询
-    unordered_map<size_t, vector<vector<size_t>>> unreachable_index_;          ///< 不可达分区索引，存储分区内的不可达点对的邻接表。
-    unordered_map<size_t, unordered_map<size_t, size_t>> unreachable_mapping_; ///< 不可达分区里面的点的映射关系，不连续点到连续的数据结构的映射关系
-    unordered_map<size_t, vector<vector<bitset<1>>>> small_index_;             ///< 小分区索引,存储可达点对的邻接矩阵。
-    unordered_map<size_t, unordered_map<size_t, size_t>> small_mapping_;       ///< 小分区分区里面点的映射关系，不连续点到连续的数据结构的映射关系
-    std::unordered_map<size_t, PLL *> pll_index_;                              ///< PLL索引，用于存储每个节点的PLL索引。
+    std::vector<BoundaryNodes> boundary_nodes_; ///< 每个分区的出口和入口点
+    // 以下分区内索引都按分区子图的局部编号存储，不再需要全局点号到连续编号的映射表
+    // 都按分区号下标并在建索引前分配好，各线程只写自己分区的位置，不需要加锁
+    std::vector<vector<vector<uint32_t>>> unreachable_index_; ///< 不可达分区索引，存储分区内的不可达点对的邻接表，每行升序。
+    std::vector<BitMatrix> small_index_;                      ///< 小分区索引，传递闭包位矩阵
+    std::vector<PLL *> pll_index_;                            ///< PLL索引，没有建PLL的分区为空
+    std::vector<std::unique_ptr<Graph>> pll_graphs_;          ///< PLL索引引用的局部编号子图
+    std::vector<PartitionIndexKind> index_kind_;              ///< 每个分区用的是哪种索引
+    std::vector<PartitionBuildStat> build_stats_;             ///< 最近一次建索引的耗时记录
+    int build_threads_ = 0;                                   ///< 建分区索引的线程数
+    int boundary_build_threads_ = 1;                          ///< 建分区连接图 PLL 的线程数，只由 set_build_threads 改
+    LandmarkOrdering::Strategy landmark_strategy_ = LandmarkOrdering::Strategy::DEGREE_PRODUCT; ///< PLL 的路标点顺序
+    bool compress_labels_ = false;                            ///< 建完 PLL 后是否压缩标签
     bool is_index;                                                             ///< 是否使用索引
 };
 #endif // COMPRESSED_SEARCH_H
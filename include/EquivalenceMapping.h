@@ -0,0 +1,54 @@
+#ifndef EQUIVALENCE_MAPPING_H
+#define EQUIVALENCE_MAPPING_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 强连通分量压缩的等价信息：点 -> 代表点，存成一个连续的 uint32_t 数组。
+ * 没有记录的点在建立时就填成自身，查询只是一次数组访问，不做哨兵判断。
+ * 数组可以从二进制文件直接 mmap 进来，二进制格式：
+ *   char[4] "RCEQ" | uint32_t 版本号 | uint64_t 点数 | uint32_t 代表点[点数]
+ */
+class EquivalenceMapping
+{
+public:
+    EquivalenceMapping() = default;
+    ~EquivalenceMapping();
+    EquivalenceMapping(const EquivalenceMapping &) = delete;
+    EquivalenceMapping &operator=(const EquivalenceMapping &) = delete;
+
+    // representative[u] 是 u 的代表点，999999999 或者越界的值按自身处理；num_vertices 大于数组长度时补成自身
+    void assign(const std::vector<uint32_t> &representative, size_t num_vertices = 0);
+    // 所有点都是自己的代表点
+    void identity(size_t num_vertices);
+    // mmap 读取二进制文件，文件头不对时返回 false 且不改变当前内容
+    bool load_binary(const std::string &filename);
+    bool save_binary(const std::string &filename) const;
+    void clear();
+
+    uint32_t operator[](uint32_t node) const { return data_[node]; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const uint32_t *data() const { return data_; }
+    bool is_mapped() const { return mapped_ != nullptr; }
+
+    // 数组占的字节数，mmap 进来的也算
+    size_t getMemoryUsage() const;
+
+    static constexpr uint32_t UNRECORDED = 999999999;
+
+private:
+    void unmap();
+
+    const uint32_t *data_ = nullptr; ///< 指向 storage_ 或者 mmap 的区域
+    size_t size_ = 0;
+    std::vector<uint32_t> storage_;
+    void *mapped_ = nullptr;
+    size_t mapped_bytes_ = 0;
+};
+
+#endif // EQUIVALENCE_MAPPING_H
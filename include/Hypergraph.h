@@ -15,6 +15,7 @@
 #include "UndirectedPLL.h"
 #include "WeightedGraph.h"
 #include "UWeightedPLL.h"
+#include "utils/TextParser.h"
 
 using namespace std;
 
@@ -453,42 +454,25 @@ public:
     // 文件格式：每行是一个超边，包含所有顶点ID，以空格分隔
     static Hypergraph fromFile(const std::string &filename)
     {
-        std::ifstream file(filename);
-        if (!file.is_open())
+        // 每行一条超边，文件 mmap 后多线程解析
+        std::vector<size_t> offsets;
+        std::vector<int> vertex_ids;
+        if (!TextParser::parse_rows(filename, offsets, vertex_ids))
         {
             throw std::runtime_error("Cannot open file: " + filename);
         }
-
-        std::string line;
         int max_vertex_id = -1;
-        std::vector<std::vector<int>> edge_data;
-
-        // 第一遍扫描，找出最大顶点ID并收集边数据
-        while (std::getline(file, line))
-        {
-            std::istringstream iss(line);
-            int vertex_id;
-            std::vector<int> edge;
-
-            while (iss >> vertex_id)
-            {
-                edge.push_back(vertex_id);
-                max_vertex_id = std::max(max_vertex_id, vertex_id);
-            }
-
-            if (!edge.empty())
-            {
-                edge_data.push_back(std::move(edge));
-            }
-        }
+        for (int vertex_id : vertex_ids)
+            max_vertex_id = std::max(max_vertex_id, vertex_id);
 
         // 创建超图并添加顶点和边
-        Hypergraph hg(max_vertex_id + 1, edge_data.size());
+        size_t num_edges = offsets.size() - 1;
+        Hypergraph hg(max_vertex_id + 1, num_edges);
         hg.addVertices(max_vertex_id + 1);
 
-        for (const auto &edge : edge_data)
+        for (size_t i = 0; i < num_edges; i++)
         {
-            hg.addHyperedge(edge);
+            hg.addHyperedge(std::vector<int>(vertex_ids.begin() + offsets[i], vertex_ids.begin() + offsets[i + 1]));
         }
 
         return hg;
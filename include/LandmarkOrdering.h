@@ -0,0 +1,68 @@
+#ifndef LANDMARK_ORDERING_H
+#define LANDMARK_ORDERING_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.h"
+
+/**
+ * @brief PLL 路标点的处理顺序。越早处理的路标点覆盖的点对越多，后面的 BFS 剪得越早，标签越少。
+ *   DEGREE_PRODUCT (入度 + 1) * (出度 + 1) 降序，PLL 原来的顺序
+ *   DEGREE_SUM     入度 + 出度 降序
+ *   SAMPLED_REACH  随机取一些采样点，能到达 v 的采样点数 * v 能到达的采样点数 降序，
+ *                  近似经过 v 的可达点对数，用多源 BFS 一次推进 64 个采样点
+ *   TOPOLOGICAL    强连通分量压缩后，(到 v 所在分量的最长路 + 1) * (从它出发的最长路 + 1) 降序，
+ *                  处在长链中间的点优先
+ * 几种顺序都只包含有边的点，分数相同时按度数积、再按点号。
+ * 同一张图上各种顺序的标签数、索引大小、构建和查询耗时可以用 evaluate 比较，按数据集挑。
+ */
+class LandmarkOrdering
+{
+public:
+    enum class Strategy
+    {
+        DEGREE_PRODUCT,
+        DEGREE_SUM,
+        SAMPLED_REACH,
+        TOPOLOGICAL
+    };
+
+    static const char *name(Strategy strategy);
+    // 名字不认识时返回 false
+    static bool parse(const std::string &name, Strategy &strategy);
+    static std::vector<Strategy> all();
+
+    // 按 strategy 排好的路标点。samples 是 SAMPLED_REACH 的采样点数，num_threads <= 0 时用硬件线程数
+    static std::vector<int> compute(const Graph &g, Strategy strategy, size_t samples = 256, unsigned seed = 0,
+                                    int num_threads = 0);
+    /**
+     * @brief 把外部给的顺序补全成路标点顺序：去掉越界、重复和没有边的点，
+     * 没列出的有边的点按度数积追加在后面，否则这些点之间的可达性没有标签覆盖。
+     */
+    static std::vector<int> complete(const Graph &g, const std::vector<int> &order);
+
+    // 一种顺序在一张图上建 PLL 的结果
+    struct Evaluation
+    {
+        Strategy strategy;
+        size_t labels;        ///< IN 和 OUT 标签总数，包括每个点自己
+        size_t bytes;         ///< 标签和位并行字占的字节数
+        double order_ms;      ///< 算顺序的耗时
+        double build_ms;      ///< 建标签的耗时，不含算顺序
+        double query_ns;      ///< queries 的平均查询耗时
+        size_t reachable;     ///< queries 里可达的个数，各种顺序应该相同
+    };
+
+    /**
+     * @brief 每种顺序各建一次 PLL，跑一遍 queries。build_threads 和 bit_parallel_roots 直接交给 PLL。
+     */
+    static std::vector<Evaluation> evaluate(Graph &g, const std::vector<Strategy> &strategies,
+                                            const std::vector<std::pair<int, int>> &queries, int build_threads = 1,
+                                            int bit_parallel_roots = 0);
+    // evaluate 的结果排成表，第一行是表头
+    static std::vector<std::string> format_report(const std::vector<Evaluation> &evaluations);
+};
+
+#endif // LANDMARK_ORDERING_H
@@ -0,0 +1,338 @@
+#ifndef MULTI_SOURCE_BFS_H
+#define MULTI_SOURCE_BFS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "graph.h"
+#include "CSR.h"
+#include "PartitionSubgraphs.h"
+#include "utils/BatchScheduler.h"
+#include "utils/SetIntersection.h"
+
+template <typename Adjacency>
+class WideMultiSourceBFS;
+
+/**
+ * @brief 多源 BFS（MS-BFS）：一次遍历同时推进最多 64 个起点。每个点一个 64 位字，第 i 位表示第 i 个起点，
+ * 一层里每条边只扫一次，把当前层上所有起点的位一起传给邻居，从所有点出发的 BFS 可以共享大部分遍历。
+ *   seen[v]  已经到达 v 的起点，visit[v] 当前层里刚到达 v 的起点，next[v] 下一层刚到达 v 的起点
+ * visit(v, mask) 在 mask 里的起点第一次到达 v 时调用，起点自己在第 0 层也会调用一次。
+ * accept(v) 为 false 的点不会被进入（起点除外），用于只在分区内遍历。
+ * forward 为 false 时沿入边走，得到的是能到达起点的点。一个对象同一时间只能被一个线程用。
+ * Adjacency 需要 max_node_id、outNeighbors、inNeighbors，CSRGraph、CompressedCSR 以及下面两个适配器都可以。
+ * for_each_group 在 CPU 支持 AVX2 且起点超过 64 个时改用 WideMultiSourceBFS，一遍推进 256 个起点。
+ */
+template <typename Adjacency>
+class MultiSourceBFS
+{
+public:
+    static constexpr size_t WIDTH = 64;
+
+    struct AcceptAll
+    {
+        bool operator()(uint32_t) const { return true; }
+    };
+
+    explicit MultiSourceBFS(const Adjacency &adjacency, bool forward = true)
+        : adjacency_(adjacency), forward_(forward), seen_(static_cast<size_t>(adjacency.max_node_id) + 1, 0),
+          visit_(seen_.size(), 0), next_(seen_.size(), 0)
+    {
+    }
+
+    // sources 最多 WIDTH 个，可以有重复，重复的起点各自占一位
+    template <typename Visit, typename Accept = AcceptAll>
+    void run(const uint32_t *sources, size_t count, Visit &&visit, Accept &&accept = Accept())
+    {
+        frontier_.clear();
+        for (size_t i = 0; i < count && i < WIDTH; ++i)
+        {
+            uint32_t s = sources[i];
+            if (s >= seen_.size())
+                continue;
+            if (!visit_[s])
+                frontier_.push_back(s);
+            visit_[s] |= uint64_t(1) << i;
+        }
+        touched_ = frontier_;
+        for (uint32_t s : frontier_)
+        {
+            seen_[s] = visit_[s];
+            visit(s, visit_[s]);
+        }
+
+        while (!frontier_.empty())
+        {
+            next_frontier_.clear();
+            for (uint32_t u : frontier_)
+            {
+                uint64_t mask = visit_[u];
+                auto neighbors = forward_ ? adjacency_.outNeighbors(u) : adjacency_.inNeighbors(u);
+                for (auto neighbor : neighbors)
+                {
+                    uint32_t v = static_cast<uint32_t>(neighbor);
+                    uint64_t arriving = mask & ~seen_[v];
+                    if (!arriving || !accept(v))
+                        continue;
+                    if (!next_[v])
+                        next_frontier_.push_back(v);
+                    next_[v] |= arriving;
+                }
+            }
+            for (uint32_t u : frontier_)
+                visit_[u] = 0;
+            for (uint32_t v : next_frontier_)
+            {
+                seen_[v] |= next_[v];
+                visit_[v] = next_[v];
+                next_[v] = 0;
+                visit(v, visit_[v]);
+            }
+            touched_.insert(touched_.end(), next_frontier_.begin(), next_frontier_.end());
+            frontier_.swap(next_frontier_);
+        }
+        // 只清这一遍到达过的点，下一遍不用整段清零
+        for (uint32_t v : touched_)
+            seen_[v] = 0;
+    }
+
+    /**
+     * @brief 把 sources 按 WIDTH 个一组分给多个线程，每个线程一个 MultiSourceBFS。
+     * visit(thread_id, group, v, mask)：group 指向这一组的起点，mask 的第 i 位对应 group[i]。
+     * 同一组只由一个线程处理，按起点写的结果不需要加锁。num_threads <= 0 时用硬件线程数。
+     */
+    template <typename Visit, typename Accept = AcceptAll>
+    static void for_each_group(const Adjacency &adjacency, bool forward, const std::vector<uint32_t> &sources,
+                               int num_threads, Visit &&visit, Accept &&accept = Accept())
+    {
+#ifdef SET_INTERSECTION_X86
+        // 和 SetIntersection 一样按运行时检测的指令集分派，回调的 group 和 mask 含义不变
+        if (sources.size() > WIDTH && SetIntersection::has_avx2())
+        {
+            WideMultiSourceBFS<Adjacency>::for_each_group(adjacency, forward, sources, num_threads, visit, accept);
+            return;
+        }
+#endif
+        size_t groups = (sources.size() + WIDTH - 1) / WIDTH;
+        int threads = BatchScheduler::resolve_threads(num_threads, groups, 1);
+        std::vector<std::unique_ptr<MultiSourceBFS>> engines(threads);
+        BatchScheduler::run_dynamic(groups, threads, [&](int thread_id, size_t group) {
+            if (!engines[thread_id])
+                engines[thread_id].reset(new MultiSourceBFS(adjacency, forward));
+            const uint32_t *first = sources.data() + group * WIDTH;
+            size_t count = std::min(WIDTH, sources.size() - group * WIDTH);
+            engines[thread_id]->run(first, count, [&](uint32_t v, uint64_t mask) {
+                visit(thread_id, first, v, mask);
+            }, accept);
+        });
+    }
+
+    // 每个起点能到达的点数（包括自己），counts[i] 对应 sources[i]
+    template <typename Accept = AcceptAll>
+    static void reach_counts(const Adjacency &adjacency, bool forward, const std::vector<uint32_t> &sources,
+                             std::vector<uint64_t> &counts, int num_threads, Accept &&accept = Accept())
+    {
+        counts.assign(sources.size(), 0);
+        for_each_group(adjacency, forward, sources, num_threads, [&](int, const uint32_t *group, uint32_t, uint64_t mask) {
+            size_t base = group - sources.data();
+            for (; mask; mask &= mask - 1)
+                ++counts[base + __builtin_ctzll(mask)];
+        }, accept);
+    }
+
+    // 所有起点能到达的点数之和（包括起点自己）
+    template <typename Accept = AcceptAll>
+    static uint64_t total_reach(const Adjacency &adjacency, bool forward, const std::vector<uint32_t> &sources,
+                                int num_threads, Accept &&accept = Accept())
+    {
+        int threads = BatchScheduler::resolve_threads(num_threads, (sources.size() + WIDTH - 1) / WIDTH, 1);
+        std::vector<uint64_t> per_thread(threads, 0);
+        for_each_group(adjacency, forward, sources, threads,
+                       [&](int thread_id, const uint32_t *, uint32_t, uint64_t mask) {
+                           per_thread[thread_id] += __builtin_popcountll(mask);
+                       }, accept);
+        uint64_t total = 0;
+        for (uint64_t count : per_thread)
+            total += count;
+        return total;
+    }
+
+private:
+    const Adjacency &adjacency_;
+    bool forward_;
+    std::vector<uint64_t> seen_;
+    std::vector<uint64_t> visit_;
+    std::vector<uint64_t> next_;
+    std::vector<uint32_t> frontier_;
+    std::vector<uint32_t> next_frontier_;
+    std::vector<uint32_t> touched_;
+};
+
+#ifdef SET_INTERSECTION_X86
+/**
+ * @brief 256 位宽的多源 BFS：每个点 4 个 64 位字，一遍推进最多 256 个起点，逐边的与非、判零和或用 AVX2 做。
+ * 只能在支持 AVX2 的 CPU 上调用，MultiSourceBFS::for_each_group 检测到 AVX2 时才会选它。
+ * visit(v, word, mask)：mask 是第 word 个 64 位字里刚到达 v 的起点（第 i 位对应起点 word * 64 + i），只对非零的字调用。
+ * 其余约定和 MultiSourceBFS 一样。
+ */
+template <typename Adjacency>
+class WideMultiSourceBFS
+{
+public:
+    static constexpr size_t WORDS = 4;
+    static constexpr size_t WIDTH = 64 * WORDS;
+
+    explicit WideMultiSourceBFS(const Adjacency &adjacency, bool forward = true)
+        : adjacency_(adjacency), forward_(forward), num_vertices_(static_cast<size_t>(adjacency.max_node_id) + 1),
+          seen_(num_vertices_ * WORDS, 0), visit_(seen_.size(), 0), next_(seen_.size(), 0)
+    {
+    }
+
+    // sources 最多 WIDTH 个，可以有重复，重复的起点各自占一位
+    template <typename Visit, typename Accept = typename MultiSourceBFS<Adjacency>::AcceptAll>
+    __attribute__((target("avx2"))) void run(const uint32_t *sources, size_t count, Visit &&visit,
+                                             Accept &&accept = Accept())
+    {
+        frontier_.clear();
+        for (size_t i = 0; i < count && i < WIDTH; ++i)
+        {
+            uint32_t s = sources[i];
+            if (s >= num_vertices_)
+                continue;
+            uint64_t *lanes = visit_.data() + static_cast<size_t>(s) * WORDS;
+            if (!(lanes[0] | lanes[1] | lanes[2] | lanes[3]))
+                frontier_.push_back(s);
+            lanes[i / 64] |= uint64_t(1) << (i % 64);
+        }
+        touched_ = frontier_;
+        for (uint32_t s : frontier_)
+        {
+            store(seen_, s, load(visit_, s));
+            emit(s, visit);
+        }
+
+        const __m256i zero = _mm256_setzero_si256();
+        while (!frontier_.empty())
+        {
+            next_frontier_.clear();
+            for (uint32_t u : frontier_)
+            {
+                __m256i mask = load(visit_, u);
+                auto neighbors = forward_ ? adjacency_.outNeighbors(u) : adjacency_.inNeighbors(u);
+                for (auto neighbor : neighbors)
+                {
+                    uint32_t v = static_cast<uint32_t>(neighbor);
+                    __m256i arriving = _mm256_andnot_si256(load(seen_, v), mask);
+                    if (_mm256_testz_si256(arriving, arriving) || !accept(v))
+                        continue;
+                    __m256i next = load(next_, v);
+                    if (_mm256_testz_si256(next, next))
+                        next_frontier_.push_back(v);
+                    store(next_, v, _mm256_or_si256(next, arriving));
+                }
+            }
+            for (uint32_t u : frontier_)
+                store(visit_, u, zero);
+            for (uint32_t v : next_frontier_)
+            {
+                __m256i next = load(next_, v);
+                store(seen_, v, _mm256_or_si256(load(seen_, v), next));
+                store(visit_, v, next);
+                store(next_, v, zero);
+                emit(v, visit);
+            }
+            touched_.insert(touched_.end(), next_frontier_.begin(), next_frontier_.end());
+            frontier_.swap(next_frontier_);
+        }
+        for (uint32_t v : touched_)
+            store(seen_, v, zero);
+    }
+
+    // 和 MultiSourceBFS::for_each_group 相同，只是每组 WIDTH 个起点；visit 收到的 group 已经按 64 位字偏移过
+    template <typename Visit, typename Accept = typename MultiSourceBFS<Adjacency>::AcceptAll>
+    static void for_each_group(const Adjacency &adjacency, bool forward, const std::vector<uint32_t> &sources,
+                               int num_threads, Visit &&visit, Accept &&accept = Accept())
+    {
+        size_t groups = (sources.size() + WIDTH - 1) / WIDTH;
+        int threads = BatchScheduler::resolve_threads(num_threads, groups, 1);
+        std::vector<std::unique_ptr<WideMultiSourceBFS>> engines(threads);
+        BatchScheduler::run_dynamic(groups, threads, [&](int thread_id, size_t group) {
+            if (!engines[thread_id])
+                engines[thread_id].reset(new WideMultiSourceBFS(adjacency, forward));
+            const uint32_t *first = sources.data() + group * WIDTH;
+            size_t count = std::min(WIDTH, sources.size() - group * WIDTH);
+            engines[thread_id]->run(first, count, [&](uint32_t v, size_t word, uint64_t mask) {
+                visit(thread_id, first + word * 64, v, mask);
+            }, accept);
+        });
+    }
+
+private:
+    __attribute__((target("avx2"))) static __m256i load(const std::vector<uint64_t> &lanes, uint32_t v)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lanes.data() + static_cast<size_t>(v) * WORDS));
+    }
+    __attribute__((target("avx2"))) static void store(std::vector<uint64_t> &lanes, uint32_t v, __m256i value)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes.data() + static_cast<size_t>(v) * WORDS), value);
+    }
+    template <typename Visit>
+    void emit(uint32_t v, Visit &visit) const
+    {
+        const uint64_t *lanes = visit_.data() + static_cast<size_t>(v) * WORDS;
+        for (size_t word = 0; word < WORDS; ++word)
+        {
+            if (lanes[word])
+                visit(v, word, lanes[word]);
+        }
+    }
+
+    const Adjacency &adjacency_;
+    bool forward_;
+    size_t num_vertices_;
+    std::vector<uint64_t> seen_;
+    std::vector<uint64_t> visit_;
+    std::vector<uint64_t> next_;
+    std::vector<uint32_t> frontier_;
+    std::vector<uint32_t> next_frontier_;
+    std::vector<uint32_t> touched_;
+};
+#endif
+
+// 邻接表形式的 Graph 当作 MultiSourceBFS 的 Adjacency，不用先建 CSR
+struct GraphAdjacency
+{
+    const Graph &graph;
+    uint32_t max_node_id;
+
+    explicit GraphAdjacency(const Graph &graph)
+        : graph(graph), max_node_id(graph.vertices.empty() ? 0 : static_cast<uint32_t>(graph.vertices.size() - 1)) {}
+    const std::vector<int> &outNeighbors(uint32_t u) const { return graph.vertices.out_edges[u]; }
+    const std::vector<int> &inNeighbors(uint32_t u) const { return graph.vertices.in_edges[u]; }
+};
+
+// 分区子图（局部编号）当作 MultiSourceBFS 的 Adjacency
+struct SubgraphAdjacency
+{
+    const PartitionSubgraphs::View &view;
+    uint32_t max_node_id;
+
+    explicit SubgraphAdjacency(const PartitionSubgraphs::View &view)
+        : view(view), max_node_id(view.num_vertices == 0 ? 0 : view.num_vertices - 1) {}
+    CSRGraph::NeighborRange outNeighbors(uint32_t u) const
+    {
+        uint32_t degree;
+        const uint32_t *first = view.out_neighbors(u, degree);
+        return {first, first + degree};
+    }
+    CSRGraph::NeighborRange inNeighbors(uint32_t u) const
+    {
+        uint32_t degree;
+        const uint32_t *first = view.in_neighbors(u, degree);
+        return {first, first + degree};
+    }
+};
+
+#endif // MULTI_SOURCE_BFS_H
@@ -0,0 +1,146 @@
+#ifndef PLL_LABEL_STORE_H
+#define PLL_LABEL_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 压缩后的只读 PLL 标签。每个点的标签是升序的秩，存相邻两项的差，差值按 7 位一组的变长整数
+ * （LEB128）写成字节流，大多数差值只占 1 到 2 个字节。查询时一边解码一边做归并求交，不先解成数组。
+ * 位并行的字（见 PLL::set_bit_parallel_roots）原样存。可以写成二进制文件，之后 mmap 只读加载，不用重建。
+ * 文件格式（版本 1，本机字节序）：
+ *   文件头 96 字节：char[8] "RCPLL" | uint32 版本 | uint32 文件头长度 | uint32 点数 | uint32 位并行组数
+ *                  | uint64 IN 字节数 | uint64 OUT 字节数 | uint64 七段的文件偏移
+ *   各段按 64 字节对齐：in_offsets[点数+1]、out_offsets[点数+1]（uint64）、IN 字节流、OUT 字节流、
+ *   order[点数]（秩 -> 点号，int32）、bp_in[点数*组数]、bp_out[点数*组数]（uint64）
+ */
+class PLLLabelStore
+{
+public:
+    PLLLabelStore() = default;
+    ~PLLLabelStore() { clear(); }
+    PLLLabelStore(const PLLLabelStore &) = delete;
+    PLLLabelStore &operator=(const PLLLabelStore &) = delete;
+
+    /**
+     * @brief 从 PLL 的标签建。in/out 每个点按秩严格升序，order[r] 是秩为 r 的点，
+     * bp_in/bp_out 按 [点 * bp_groups + 组] 排列，bp_groups 为 0 时可以是空的。
+     */
+    void build(const std::vector<std::vector<int>> &in, const std::vector<std::vector<int>> &out,
+               const std::vector<int> &order, int bp_groups, const std::vector<uint64_t> &bp_in,
+               const std::vector<uint64_t> &bp_out);
+
+    bool save(const std::string &filename) const;
+    // mmap 只读加载，文件头不对时返回 false 且不改变当前内容
+    bool load(const std::string &filename);
+    void clear();
+    // 交换两份标签，owned_ 里的数组整体换过去，指针仍然有效
+    void swap(PLLLabelStore &other);
+
+    bool empty() const { return num_vertices_ == 0; }
+    bool isMapped() const { return mapped_addr_ != nullptr; }
+    uint32_t num_vertices() const { return num_vertices_; }
+    int bp_groups() const { return bp_groups_; }
+    int landmark(int rank) const { return order_[rank]; }
+
+    // u 能否到达 v，u、v 必须小于点数，u == v 由调用方处理
+    bool query(uint32_t u, uint32_t v) const
+    {
+        if (bp_groups_ > 0)
+        {
+            const uint64_t *out = bp_out_ + static_cast<size_t>(u) * bp_groups_;
+            const uint64_t *in = bp_in_ + static_cast<size_t>(v) * bp_groups_;
+            for (int k = 0; k < bp_groups_; ++k)
+            {
+                if (out[k] & in[k])
+                    return true;
+            }
+        }
+        Cursor a(out_bytes_ + out_offsets_[u], out_bytes_ + out_offsets_[u + 1]);
+        Cursor b(in_bytes_ + in_offsets_[v], in_bytes_ + in_offsets_[v + 1]);
+        if (!a.next() || !b.next())
+            return false;
+        while (true)
+        {
+            if (a.value == b.value)
+                return true;
+            if (a.value < b.value ? !a.next() : !b.next())
+                return false;
+        }
+    }
+
+    // 按升序把 v 的每个 IN / OUT 标签（秩）交给 f
+    template <typename F>
+    void for_each_in(uint32_t v, F &&f) const
+    {
+        for (Cursor c(in_bytes_ + in_offsets_[v], in_bytes_ + in_offsets_[v + 1]); c.next();)
+            f(static_cast<int>(c.value));
+    }
+    template <typename F>
+    void for_each_out(uint32_t v, F &&f) const
+    {
+        for (Cursor c(out_bytes_ + out_offsets_[v], out_bytes_ + out_offsets_[v + 1]); c.next();)
+            f(static_cast<int>(c.value));
+    }
+
+    // 各部分占的字节数，加载的文件按映射的长度算
+    size_t label_bytes() const { return in_size_ + out_size_; }
+    size_t offset_bytes() const { return num_vertices_ == 0 ? 0 : (size_t(num_vertices_) + 1) * 2 * sizeof(uint64_t); }
+    size_t bit_parallel_bytes() const { return size_t(num_vertices_) * bp_groups_ * 2 * sizeof(uint64_t); }
+    size_t bytes() const { return label_bytes() + offset_bytes() + bit_parallel_bytes() + size_t(num_vertices_) * sizeof(int32_t); }
+
+private:
+    // 顺序解码一个点的标签，value 是当前的秩
+    struct Cursor
+    {
+        const uint8_t *p;
+        const uint8_t *end;
+        uint32_t value = 0;
+
+        Cursor(const uint8_t *first, const uint8_t *last) : p(first), end(last) {}
+        bool next()
+        {
+            if (p == end)
+                return false;
+            uint32_t delta = 0;
+            int shift = 0;
+            uint8_t byte;
+            do
+            {
+                byte = *p++;
+                delta |= uint32_t(byte & 0x7f) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            value += delta;
+            return true;
+        }
+    };
+
+    uint32_t num_vertices_ = 0;
+    int bp_groups_ = 0;
+    uint64_t in_size_ = 0;
+    uint64_t out_size_ = 0;
+    // 下面的指针指向 owned_ 里的数组或者映射的文件
+    const uint64_t *in_offsets_ = nullptr;
+    const uint64_t *out_offsets_ = nullptr;
+    const uint8_t *in_bytes_ = nullptr;
+    const uint8_t *out_bytes_ = nullptr;
+    const int32_t *order_ = nullptr;
+    const uint64_t *bp_in_ = nullptr;
+    const uint64_t *bp_out_ = nullptr;
+
+    struct Owned
+    {
+        std::vector<uint64_t> in_offsets, out_offsets;
+        std::vector<uint8_t> in_bytes, out_bytes;
+        std::vector<int32_t> order;
+        std::vector<uint64_t> bp_in, bp_out;
+    } owned_;
+
+    void *mapped_addr_ = nullptr;
+    size_t mapped_bytes_ = 0;
+};
+
+#endif // PLL_LABEL_STORE_H
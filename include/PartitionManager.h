@@ -10,6 +10,8 @@
 #include "graph.h"
 #include "CSR.h"
 #include "Algorithm.h"
+#include "PartitionSubgraphs.h"
+#include "EquivalenceMapping.h"
 
 using namespace std;
 //分区的出口和入口点集
@@ -102,30 +104,24 @@ public:
     void print_equivalence_mapping() const;
 
     // 从文件中读取节点的分区信息，更新到图中，有些从边集没有读取到的边会在这里补全
+    // 文件可以是 "node scc_id" 文本，也可以是 EquivalenceMapping 的二进制格式（直接 mmap）
     void read_equivalance_info(const std::string &filename);
 
+    // 直接设置每个点的等价类代表点（SCCCondenser 的结果），不经过文件；equivalence[u] == u 表示 u 自己是代表点
+    void set_equivalence_info(const std::vector<uint32_t> &equivalence);
+
+    // 没有读等价信息时是恒等映射，查询只访问一次数组
     uint32_t get_equivalance_mapping(int node) const
     {
-        if (equivalence_mapping == nullptr)
-            return node;
-        uint32_t eq = *equivalence_mapping[node];
-        return ((eq == 999999999) ? static_cast<uint32_t>(node) : eq);
+        return equivalence_mapping[node];
     };
 
+    // 是否读入过等价信息
+    bool has_equivalence_info() const { return equivalence_loaded_; }
+
     uint32_t get_equivalence_mapping_size() const
     {
-
-        uint32_t total_size = 0;
-        uint32_t num_vertices = csr->max_node_id + 1;
-        for (uint32_t i = 0; i < num_vertices; ++i)
-        {
-            if (equivalence_mapping[i] != nullptr)
-            {
-                total_size += sizeof(uint32_t);
-            }
-            total_size += sizeof(uint32_t);
-        }
-        return total_size;
+        return static_cast<uint32_t>(equivalence_mapping.getMemoryUsage());
     }
     const std::map<int, std::set<int>> &get_mapping() const{return mapping;}
 
@@ -209,14 +205,19 @@ public:
     // 分区之间的邻接表
     std::unordered_map<int, std::unordered_map<int, PartitionEdge>> partition_adjacency;
 
-    // 每个分区对应的子图
-    std::unordered_map<int, Graph> partition_subgraphs;
-    std::map<uint32_t, std::shared_ptr<CSRGraph>> partition_subgraphs_csr;
+    // 每个分区对应的子图，局部编号的紧凑CSR，所有分区共用一块存储
+    PartitionSubgraphs partition_subgraphs;
 
-    // 等价类的二维数组映射,第一位是原始节点，第二位是映射后的节点。在g中的vertex结构体里也有这个
-    uint32_t **equivalence_mapping = nullptr;
+    // 等价类映射，原始节点 -> 代表点。在g中的vertex结构体里也有这个
+    // 读入等价信息前是恒等映射
+    EquivalenceMapping equivalence_mapping;
 
 private:
+    // 把 equivalence_mapping 同步到 g 的 vertex 里，点数不够时补全
+    void sync_equivalence_to_graph();
+
+    bool equivalence_loaded_ = false;
+
     std::string getCurrentTimes()
     {
         auto now = std::chrono::system_clock::now();
@@ -0,0 +1,89 @@
+#ifndef PARTITION_SUBGRAPHS_H
+#define PARTITION_SUBGRAPHS_H
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include "graph.h"
+
+/**
+ * @brief 所有分区子图的紧凑存储。
+ * 每个分区内的点按全局点号升序重新编号为 0..n-1（局部编号），只保留分区内部的边，
+ * 存成以局部编号表示的 CSR。所有分区的行指针和列数组拼在同一块共享数组里，
+ * 每个分区只记录自己在共享数组中的起点，总空间为 O(|V| + |E_intra|)，与分区数无关。
+ */
+class PartitionSubgraphs
+{
+public:
+    static constexpr uint32_t INVALID_ID = UINT32_MAX;
+
+    // 一个分区子图的只读视图，点号都是局部编号
+    struct View
+    {
+        const uint32_t *out_row = nullptr; // 指向本分区第一行，值是共享数组里的绝对下标
+        const uint32_t *in_row = nullptr;
+        const uint32_t *out_col = nullptr; // 共享列数组的起点
+        const uint32_t *in_col = nullptr;
+        const uint32_t *global = nullptr;  // 局部编号 -> 全局点号
+        uint32_t num_vertices = 0;         // 分区内的点数
+        uint32_t num_connected = 0;        // 有分区内边的点数
+        uint32_t num_edges = 0;
+
+        const uint32_t *out_neighbors(uint32_t u, uint32_t &degree) const
+        {
+            degree = out_row[u + 1] - out_row[u];
+            return out_col + out_row[u];
+        }
+        const uint32_t *in_neighbors(uint32_t u, uint32_t &degree) const
+        {
+            degree = in_row[u + 1] - in_row[u];
+            return in_col + in_row[u];
+        }
+        uint32_t out_degree(uint32_t u) const { return out_row[u + 1] - out_row[u]; }
+        uint32_t in_degree(uint32_t u) const { return in_row[u + 1] - in_row[u]; }
+        uint32_t global_id(uint32_t u) const { return global[u]; }
+    };
+
+    // 按 mapping 重新构建所有分区子图，分区号为 -1 的点不建子图
+    void build(const Graph &g, const std::map<int, std::set<int>> &mapping);
+    void clear();
+
+    bool contains(int partition_id) const { return slices_.find(partition_id) != slices_.end(); }
+    // 分区不存在时返回空视图
+    View get(int partition_id) const;
+    // 全局点号 -> 分区内局部编号，不在任何子图里时返回 INVALID_ID
+    uint32_t local_id(int node) const
+    {
+        if (node < 0 || static_cast<size_t>(node) >= local_id_.size())
+            return INVALID_ID;
+        return local_id_[node];
+    }
+    // 所有已建子图的分区号，升序
+    const std::vector<int> &partition_ids() const { return partition_ids_; }
+    size_t size() const { return partition_ids_.size(); }
+
+    size_t getMemoryUsage() const;
+
+private:
+    // 分区在共享数组中的位置
+    struct Slice
+    {
+        uint32_t vertex_offset = 0;
+        uint32_t num_vertices = 0;
+        uint32_t num_connected = 0;
+        uint32_t num_edges = 0;
+    };
+
+    std::vector<uint32_t> local_id_;  // 全局点号 -> 局部编号
+    std::vector<uint32_t> global_id_; // vertex_offset + 局部编号 -> 全局点号
+    std::vector<uint32_t> out_row_;   // 长度为总点数 + 1
+    std::vector<uint32_t> in_row_;
+    std::vector<uint32_t> out_col_;   // 存局部编号
+    std::vector<uint32_t> in_col_;
+    std::unordered_map<int, Slice> slices_;
+    std::vector<int> partition_ids_;
+};
+
+#endif // PARTITION_SUBGRAPHS_H
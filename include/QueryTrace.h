@@ -0,0 +1,158 @@
+#ifndef QUERY_TRACE_H
+#define QUERY_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <vector>
+
+// 在线查询的各个阶段，用于分阶段统计耗时
+enum class QueryStage : uint8_t
+{
+    EquivalenceMapping = 0, // 等价类映射
+    Filter,                 // 过滤器判断
+    PartitionLookup,        // 确定分区号
+    IntraIndexProbe,        // 分区内索引查询
+    CrossPartitionSearch,   // 跨分区查询
+    Count
+};
+
+// 阶段判定结果
+enum QueryTraceResult : uint8_t
+{
+    TRACE_UNREACHABLE = 0,
+    TRACE_REACHABLE = 1,
+    TRACE_UNDECIDED = 2 // 该阶段没有给出结论，交给下一阶段
+};
+
+// 一条查询阶段记录
+struct QueryTraceRecord
+{
+    int32_t source;
+    int32_t target;
+    QueryStage stage;
+    uint8_t result;
+    uint64_t nanos; // 该阶段耗时，纳秒
+};
+
+/**
+ * @brief 查询阶段耗时的环形缓冲区。
+ * 容量在构造时一次性分配，之后记录不会再申请内存，写满后覆盖最旧的记录。
+ * 可选注册一个回调，每条记录写入时同步调用。非线程安全，每个查询线程各用一个。
+ */
+class QueryTraceBuffer
+{
+public:
+    using Callback = void (*)(const QueryTraceRecord &record, void *user_data);
+
+    // capacity 会向上取整到 2 的幂
+    explicit QueryTraceBuffer(size_t capacity = 4096)
+    {
+        size_t cap = 1;
+        while (cap < capacity)
+            cap <<= 1;
+        ring_.resize(cap);
+        mask_ = cap - 1;
+        clear();
+    }
+
+    void set_callback(Callback callback, void *user_data = nullptr)
+    {
+        callback_ = callback;
+        user_data_ = user_data;
+    }
+
+    void record(QueryStage stage, int source, int target, uint8_t result,
+                std::chrono::steady_clock::time_point start) noexcept
+    {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        QueryTraceRecord &slot = ring_[head_ & mask_];
+        slot.source = source;
+        slot.target = target;
+        slot.stage = stage;
+        slot.result = result;
+        slot.nanos = static_cast<uint64_t>(nanos);
+        ++head_;
+        stage_nanos_[static_cast<size_t>(stage)] += slot.nanos;
+        stage_count_[static_cast<size_t>(stage)]++;
+        if (callback_ != nullptr)
+            callback_(slot, user_data_);
+    }
+
+    // 当前缓冲区内有效的记录数
+    size_t size() const { return head_ < ring_.size() ? static_cast<size_t>(head_) : ring_.size(); }
+    size_t capacity() const { return ring_.size(); }
+    // 累计写入过的记录数（包括已被覆盖的）
+    uint64_t total_records() const { return head_; }
+
+    // 第 i 条记录，0 是缓冲区中最旧的一条
+    const QueryTraceRecord &at(size_t i) const
+    {
+        uint64_t first = head_ - size();
+        return ring_[(first + i) & mask_];
+    }
+
+    // 各阶段的累计耗时和次数，不受覆盖影响
+    uint64_t stage_nanos(QueryStage stage) const { return stage_nanos_[static_cast<size_t>(stage)]; }
+    uint64_t stage_count(QueryStage stage) const { return stage_count_[static_cast<size_t>(stage)]; }
+
+    void clear()
+    {
+        head_ = 0;
+        for (size_t i = 0; i < static_cast<size_t>(QueryStage::Count); ++i)
+        {
+            stage_nanos_[i] = 0;
+            stage_count_[i] = 0;
+        }
+    }
+
+    static const char *stage_name(QueryStage stage)
+    {
+        switch (stage)
+        {
+        case QueryStage::EquivalenceMapping:
+            return "EquivalenceMapping";
+        case QueryStage::Filter:
+            return "Filter";
+        case QueryStage::PartitionLookup:
+            return "PartitionLookup";
+        case QueryStage::IntraIndexProbe:
+            return "IntraIndexProbe";
+        case QueryStage::CrossPartitionSearch:
+            return "CrossPartitionSearch";
+        default:
+            return "Unknown";
+        }
+    }
+
+private:
+    std::vector<QueryTraceRecord> ring_;
+    uint64_t mask_ = 0;
+    uint64_t head_ = 0;
+    uint64_t stage_nanos_[static_cast<size_t>(QueryStage::Count)];
+    uint64_t stage_count_[static_cast<size_t>(QueryStage::Count)];
+    Callback callback_ = nullptr;
+    void *user_data_ = nullptr;
+};
+
+// 编译时开关：不定义 REACH_QUERY_TRACE 时下面的宏全部展开为空，查询路径上没有任何额外开销
+#ifdef REACH_QUERY_TRACE
+#define QUERY_TRACE_START(name) const auto name = std::chrono::steady_clock::now()
+#define QUERY_TRACE(buffer, stage, start, source, target, result)     \
+    do                                                                \
+    {                                                                 \
+        if ((buffer) != nullptr)                                      \
+            (buffer)->record((stage), (source), (target), (result), (start)); \
+    } while (0)
+#else
+#define QUERY_TRACE_START(name) \
+    do                          \
+    {                           \
+    } while (0)
+#define QUERY_TRACE(buffer, stage, start, source, target, result) \
+    do                                                            \
+    {                                                             \
+    } while (0)
+#endif
+
+#endif // QUERY_TRACE_H
@@ -22,6 +22,9 @@ float compute_reach_ratio(Graph& graph);
 
 float compute_reach_ratio(CSRGraph * csr);
 
+// 计算局部编号分区子图的可达性比例，分母按有分区内边的点数算，和 Graph 版本一致
+float compute_reach_ratio(const PartitionSubgraphs::View &view);
+
 //使用pll方法计算全图可达比例
 float compute_reach_ratio_bfs(Graph& graph);
 
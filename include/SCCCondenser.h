@@ -0,0 +1,115 @@
+#ifndef SCC_CONDENSER_H
+#define SCC_CONDENSER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "CSR.h"
+#include "graph.h"
+
+/**
+ * @brief 强连通分量压缩，代替 CompresstoDAG.py / convertToDAG.py。
+ * 结果和脚本的约定一致：每个分量用分量内最小的点号作代表，component[u] 是 u 所在分量的代表点，
+ * 压缩后的 DAG 仍然用原图的点号，非代表点在 DAG 里是孤立点。
+ * component 可以直接交给 CompressedSearch::offline_industry 作等价信息，不再需要读写 mapping 文件。
+ */
+class SCCCondenser
+{
+public:
+    /**
+     * @brief 迭代版 Tarjan，不递归，大图上不会爆栈。
+     * @return 强连通分量个数（孤立点也算一个分量）
+     */
+    static uint32_t tarjan(const CSRGraph &csr, std::vector<uint32_t> &component);
+
+    /**
+     * @brief tarjan 的核心，Adjacency 需要 max_node_id 和 outNeighbors（返回可按下标访问、有 size() 的区间），
+     * CSRGraph 和 MultiSourceBFS.h 里的 SubgraphAdjacency 都可以。
+     * 分量按逆拓扑序（汇点在前）完成，每完成一个分量调用 on_component(members, count)，
+     * 这时它的所有后继分量都已经回调过。
+     */
+    template <typename Adjacency, typename OnComponent>
+    static void tarjan_components(const Adjacency &adjacency, OnComponent &&on_component);
+
+    /**
+     * @brief 并行的前向-后向（FW-BW）算法，先剪掉分区内入度或出度为 0 的点，
+     * 再从枢轴点做前向和后向BFS，交集是一个分量，剩下的三部分作为新任务交给线程池。
+     * 结果和 tarjan 完全相同。
+     * @param num_threads <= 0 时使用硬件线程数
+     */
+    static uint32_t forward_backward(const CSRGraph &csr, std::vector<uint32_t> &component, int num_threads = 0);
+
+    // 按 component 把 csr 压缩成 DAG，去掉分量内部的边和重复边，每行升序
+    static void condense(const CSRGraph &csr, const std::vector<uint32_t> &component, CSRGraph &dag);
+    // 同上，结果放进 Graph，可以直接构造 CompressedSearch
+    static void condense(const CSRGraph &csr, const std::vector<uint32_t> &component, Graph &dag);
+
+    static constexpr uint32_t UNASSIGNED = UINT32_MAX;
+
+private:
+    // 把压缩后的边按代表点分行收集，out_row 长度为点数 + 1
+    static void collect_condensed_edges(const CSRGraph &csr, const std::vector<uint32_t> &component,
+                                        std::vector<uint32_t> &out_row, std::vector<uint32_t> &out_col);
+};
+
+template <typename Adjacency, typename OnComponent>
+void SCCCondenser::tarjan_components(const Adjacency &adjacency, OnComponent &&on_component)
+{
+    const uint32_t n = adjacency.max_node_id + 1;
+    std::vector<uint32_t> order(n, UNASSIGNED); // DFS 序
+    std::vector<uint32_t> low(n, 0);
+    std::vector<uint8_t> on_stack(n, 0);
+    std::vector<uint32_t> tarjan_stack;
+    std::vector<std::pair<uint32_t, uint32_t>> call_stack; // (点, 下一条要看的出边的下标)
+    uint32_t next_order = 0;
+
+    for (uint32_t root = 0; root < n; ++root)
+    {
+        if (order[root] != UNASSIGNED)
+            continue;
+        order[root] = low[root] = next_order++;
+        tarjan_stack.push_back(root);
+        on_stack[root] = 1;
+        call_stack.emplace_back(root, 0);
+        while (!call_stack.empty())
+        {
+            uint32_t u = call_stack.back().first;
+            uint32_t edge = call_stack.back().second;
+            auto neighbors = adjacency.outNeighbors(u);
+            if (edge < neighbors.size())
+            {
+                call_stack.back().second++;
+                uint32_t w = static_cast<uint32_t>(neighbors.begin()[edge]);
+                if (order[w] == UNASSIGNED)
+                {
+                    order[w] = low[w] = next_order++;
+                    tarjan_stack.push_back(w);
+                    on_stack[w] = 1;
+                    call_stack.emplace_back(w, 0);
+                }
+                else if (on_stack[w])
+                {
+                    low[u] = std::min(low[u], order[w]);
+                }
+                continue;
+            }
+            call_stack.pop_back();
+            if (!call_stack.empty())
+            {
+                uint32_t parent = call_stack.back().first;
+                low[parent] = std::min(low[parent], low[u]);
+            }
+            if (low[u] != order[u])
+                continue;
+
+            // u 是分量的根，栈上 u 及以上的点是一个分量
+            size_t first = std::find(tarjan_stack.rbegin(), tarjan_stack.rend(), u).base() - 1 - tarjan_stack.begin();
+            for (size_t i = first; i < tarjan_stack.size(); ++i)
+                on_stack[tarjan_stack[i]] = 0;
+            on_component(static_cast<const uint32_t *>(tarjan_stack.data() + first), tarjan_stack.size() - first);
+            tarjan_stack.resize(first);
+        }
+    }
+}
+
+#endif // SCC_CONDENSER_H
@@ -0,0 +1,120 @@
+#ifndef SEARCH_CONTEXT_H
+#define SEARCH_CONTEXT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CSR.h"
+#include "CompressedCSR.h"
+#include "BitmapBiBFS.h"
+
+/**
+ * @brief 一次 BFS 查询用到的临时空间，多次查询之间复用，不在每次查询里分配。
+ * 访问标记是按代（epoch）记录的时间戳：stamp[side][v] == epoch 表示这次查询里 side 一侧访问过 v，
+ * 开始新查询只要把 epoch 加一，不用清空数组；epoch 用完一轮（回到 0）时才整段清零一次。
+ * side 取 FORWARD 或 BACKWARD，单向 BFS 只用 FORWARD。队列是 vector 加队头下标，push 不会反复分配。
+ * 另外带着 BiBFSCSR 用的位图搜索引擎（见 BitmapBiBFS），第一次在某个 CSR 上查询时建立，之后同一个 CSR 上复用。
+ * 一个对象同一时间只能被一个线程用；多线程时每个线程一份，或者用 local() 取本线程的那一份。
+ */
+class SearchContext
+{
+public:
+    static constexpr int FORWARD = 0;
+    static constexpr int BACKWARD = 1;
+
+    // 当前线程的那一份，不显式传 context 的查询用它
+    static SearchContext &local()
+    {
+        thread_local SearchContext context;
+        return context;
+    }
+
+    /**
+     * @brief 开始一次新的查询，点号范围是 [0, num_nodes)。只在点数变多时扩容，
+     * 其余情况只是 epoch 加一、清空两个队列。记录父节点的空间要用 parents 时才分配。
+     */
+    void reset(size_t num_nodes)
+    {
+        if (num_nodes > capacity_)
+        {
+            for (int side : {FORWARD, BACKWARD})
+            {
+                stamps_[side].resize(num_nodes, 0);
+                if (!parents_[side].empty())
+                    parents_[side].resize(num_nodes, -1);
+            }
+            capacity_ = num_nodes;
+        }
+        if (++epoch_ == 0)
+        {
+            for (int side : {FORWARD, BACKWARD})
+                std::fill(stamps_[side].begin(), stamps_[side].end(), 0);
+            epoch_ = 1;
+        }
+        for (int side : {FORWARD, BACKWARD})
+        {
+            queues_[side].clear();
+            heads_[side] = 0;
+        }
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    bool visited(int side, uint32_t v) const { return stamps_[side][v] == epoch_; }
+    void visit(int side, uint32_t v) { stamps_[side][v] = epoch_; }
+    // v 这次查询里第一次被 side 访问时标记并返回 true
+    bool try_visit(int side, uint32_t v)
+    {
+        if (stamps_[side][v] == epoch_)
+            return false;
+        stamps_[side][v] = epoch_;
+        return true;
+    }
+
+    void push(int side, int v) { queues_[side].push_back(v); }
+    bool queue_empty(int side) const { return heads_[side] == queues_[side].size(); }
+    int pop(int side) { return queues_[side][heads_[side]++]; }
+    // 这次查询里 side 一侧进过队列的点，按入队顺序
+    const std::vector<int> &queue(int side) const { return queues_[side]; }
+
+    // 父节点数组，只有访问过的点的值有意义
+    std::vector<int> &parents(int side)
+    {
+        if (parents_[side].size() < capacity_)
+            parents_[side].resize(capacity_, -1);
+        return parents_[side];
+    }
+
+    // BiBFSCSR 的位图搜索引擎，adjacency 变了或者点数变了时重新建立
+    BitmapBiBFS<CSRGraph> &bitmap_engine(const CSRGraph &csr)
+    {
+        return engine(csr_engine_, csr);
+    }
+    BitmapBiBFS<CompressedCSR> &bitmap_engine(const CompressedCSR &compressed)
+    {
+        return engine(compressed_engine_, compressed);
+    }
+
+private:
+    std::vector<uint32_t> stamps_[2];
+    std::vector<int> parents_[2];
+    std::vector<int> queues_[2];
+    size_t heads_[2] = {0, 0};
+    size_t capacity_ = 0;
+    uint32_t epoch_ = 0;
+
+    std::unique_ptr<BitmapBiBFS<CSRGraph>> csr_engine_;
+    std::unique_ptr<BitmapBiBFS<CompressedCSR>> compressed_engine_;
+
+    template <typename Adjacency>
+    static BitmapBiBFS<Adjacency> &engine(std::unique_ptr<BitmapBiBFS<Adjacency>> &slot, const Adjacency &adjacency)
+    {
+        if (!slot || &slot->adjacency() != &adjacency || slot->size() != static_cast<size_t>(adjacency.max_node_id) + 1)
+            slot.reset(new BitmapBiBFS<Adjacency>(adjacency));
+        return *slot;
+    }
+};
+
+#endif // SEARCH_CONTEXT_H
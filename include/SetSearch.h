@@ -29,6 +29,8 @@ public:
     ~SetSearch() override;
     vector<pair<int, int>> set_reachability_query(vector<int> source_set, vector<int> target_set);
     bool reachability_query(int source, int target) override;
+    using Algorithm::reachability_query_batch;
+    void reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads = 0) override;
     void offline_industry() override;
     std::vector<std::pair<std::string, std::string>> getIndexSizes() const override;
 
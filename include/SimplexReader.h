@@ -8,6 +8,7 @@
 #include <vector>
 #include <stdexcept>
 #include "Hypergraph.h"
+#include "utils/TextParser.h"
 
 /**
  * 用于处理Cornell单纯形数据集的工具类
@@ -26,52 +27,46 @@ public:
         const std::string &simplicesPath, 
         const std::string &outputPath)
     {
-        // 打开输入文件
-        std::ifstream nVertsFile(nVertsPath);
-        std::ifstream simplicesFile(simplicesPath);
-        
-        if (!nVertsFile.is_open()) {
+        // 两个文件都是每行一个数，mmap 后多线程解析
+        std::vector<size_t> nverts_offsets, simplex_offsets;
+        std::vector<int> nverts, simplices;
+        if (!TextParser::parse_rows(nVertsPath, nverts_offsets, nverts)) {
             throw std::runtime_error("Cannot open nverts file: " + nVertsPath);
         }
-        if (!simplicesFile.is_open()) {
+        if (!TextParser::parse_rows(simplicesPath, simplex_offsets, simplices)) {
             throw std::runtime_error("Cannot open simplices file: " + simplicesPath);
         }
-        
+
         // 打开输出文件
         std::ofstream outputFile(outputPath);
         if (!outputFile.is_open()) {
             throw std::runtime_error("Cannot open output file: " + outputPath);
         }
-        
-        std::string line;
-        int nVerts;
-        
-        // 逐行读取单纯形顶点数并处理
-        while (std::getline(nVertsFile, line)) {
-            // 获取当前单纯形的顶点数
-            nVerts = std::stoi(line);
-            
-            // 一行输出表示一个超边（单纯形）
+
+        // 一行输出表示一个超边（单纯形），依次取 nVerts 个顶点
+        std::string buffer;
+        size_t next = 0;
+        for (int nVerts : nverts) {
+            if (nVerts < 0 || next + nVerts > simplices.size()) {
+                throw std::runtime_error("Simplices file ended unexpectedly.");
+            }
             for (int i = 0; i < nVerts; ++i) {
-                if (std::getline(simplicesFile, line)) {
-                    // 第一个顶点前不加空格，其他顶点前加空格
-                    if (i > 0) {
-                        outputFile << " ";
-                    }
-                    outputFile << line;
-                } else {
-                    throw std::runtime_error("Simplices file ended unexpectedly.");
+                // 第一个顶点前不加空格，其他顶点前加空格
+                if (i > 0) {
+                    buffer += ' ';
                 }
+                buffer += std::to_string(simplices[next++]);
             }
             // 每个超边结束后换行
-            outputFile << std::endl;
+            buffer += '\n';
+            if (buffer.size() >= (1 << 20)) {
+                outputFile << buffer;
+                buffer.clear();
+            }
         }
-        
-        // 关闭文件
-        nVertsFile.close();
-        simplicesFile.close();
+        outputFile << buffer;
         outputFile.close();
-        
+
         std::cout << "Conversion completed. Hypergraph saved to: " << outputPath << std::endl;
     }
 
@@ -83,36 +78,23 @@ public:
      */
     static Hypergraph fromHypergraphFile(const std::string &filename)
     {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
+        // 每行一条超边，文件 mmap 后多线程解析
+        std::vector<size_t> offsets;
+        std::vector<int> vertex_ids;
+        if (!TextParser::parse_rows(filename, offsets, vertex_ids)) {
             throw std::runtime_error("Cannot open file: " + filename);
         }
-
-        std::string line;
         int max_vertex_id = -1;
-        std::vector<std::vector<int>> edge_data;
-
-        // 第一遍扫描，找出最大顶点ID并收集边数据
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            int vertex_id;
-            std::vector<int> edge;
-
-            while (iss >> vertex_id) {
-                edge.push_back(vertex_id);
-                max_vertex_id = std::max(max_vertex_id, vertex_id);
-            }
-
-            if (!edge.empty()) {
-                edge_data.push_back(std::move(edge));
-            }
+        for (int vertex_id : vertex_ids) {
+            max_vertex_id = std::max(max_vertex_id, vertex_id);
         }
 
         // 创建超图并添加顶点和边
-        Hypergraph hg(max_vertex_id + 1, edge_data.size());
-        
-        for (const auto &edge : edge_data) {
-            hg.addHyperedge(edge);
+        size_t num_edges = offsets.size() - 1;
+        Hypergraph hg(max_vertex_id + 1, num_edges);
+
+        for (size_t i = 0; i < num_edges; i++) {
+            hg.addHyperedge(std::vector<int>(vertex_ids.begin() + offsets[i], vertex_ids.begin() + offsets[i + 1]));
         }
 
         return hg;
@@ -41,6 +41,8 @@ public:
     void offline_industry() override;
     void printIndex();
     bool reachability_query(int source, int target) override;
+    using Algorithm::reachability_query_batch;
+    void reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads = 0) override;
     std::vector<std::pair<std::string, std::string>> getIndexSizes() const override
     {
         std::vector<std::pair<std::string, std::string>> index_sizes;
@@ -10,6 +10,7 @@
 #include <fstream>
 #include <sstream>
 #include <stdexcept> // For std::invalid_argument
+#include "utils/SetIntersection.h"
 /*
  * WeightedPrunedLandmarkIndex 实现了基于 2-hop 索引的无向加权图可达性（LCR）查询。
  *
@@ -46,6 +47,12 @@ public:
     // 离线构建索引，函数名为 offline_industry()
     void offline_industry(std::string cache_path = "");
 
+    // 指定路标点顺序，默认按邻接边数降序。没列出的点按默认顺序接在后面，要在 offline_industry 之前设置
+    void set_landmark_order(std::vector<int> order)
+    {
+        landmark_order_ = std::move(order);
+    }
+
     // 查询可达性，函数名为 reachability_query(u, v, queryThreshold)
     // 如果在查询时 u 与 v 存在公共 landmark，其记录的瓶颈值（取二者较小值） ≥ queryThreshold，则返回 true
     bool reachability_query(int u, int v, int queryThreshold) const;
@@ -87,6 +94,7 @@ public:
 
 private:
     const WeightedGraph &g;
+    std::vector<int> landmark_order_;
 
     // 在有序 vector 中插入或更新 (landmark, bw) 记录
     void insertOrUpdateLabel(std::vector<std::pair<int, int>> &vec, int landmark, int bw) const;
@@ -232,9 +240,18 @@ void WeightedPrunedLandmarkIndex::offline_industry(std::string cache_path /* = "
     std::sort(deg.begin(), deg.end(), [](const auto &a, const auto &b) {
         return a.first > b.first; // Sort by degree descending
     });
-    std::vector<int> order(n);
+    // 先放指定的顺序（去掉越界和重复的点），剩下的按度数顺序接在后面
+    std::vector<int> order;
+    std::vector<char> listed(n, 0);
+    for (int v : landmark_order_) {
+        if (v >= 0 && v < n && !listed[v]) {
+            listed[v] = 1;
+            order.push_back(v);
+        }
+    }
     for (int i = 0; i < n; ++i) {
-        order[i] = deg[i].second;
+        if (!listed[deg[i].second])
+            order.push_back(deg[i].second);
     }
 
     // 按降序顺序依次将每个顶点作为 Landmark 进行 BFS 扩展
@@ -298,29 +315,7 @@ bool WeightedPrunedLandmarkIndex::hopQuery(int curLandmark, int node, int candid
     if (node == curLandmark)
         return true;
 
-    const auto &vec1 = label[curLandmark];
-    const auto &vec2 = label[node];
-    int i = 0, j = 0;
-    while (i < (int)vec1.size() && j < (int)vec2.size())
-    {
-        if (vec1[i].first == vec2[j].first)
-        {
-            int bw = std::min(vec1[i].second, vec2[j].second);
-            if (bw >= candidateBW)
-                return true;
-            ++i;
-            ++j;
-        }
-        else if (vec1[i].first < vec2[j].first)
-        {
-            ++i;
-        }
-        else
-        {
-            ++j;
-        }
-    }
-    return false;
+    return intersectWithThreshold(label[curLandmark], label[node], candidateBW);
 }
 
 bool WeightedPrunedLandmarkIndex::intersectWithThreshold(
@@ -328,27 +323,8 @@ bool WeightedPrunedLandmarkIndex::intersectWithThreshold(
     const std::vector<std::pair<int, int>> &b,
     int threshold) const
 {
-    int i = 0, j = 0;
-    while (i < (int)a.size() && j < (int)b.size())
-    {
-        if (a[i].first == b[j].first)
-        {
-            int bw = std::min(a[i].second, b[j].second);
-            if (bw >= threshold)
-                return true;
-            ++i;
-            ++j;
-        }
-        else if (a[i].first < b[j].first)
-        {
-            ++i;
-        }
-        else
-        {
-            ++j;
-        }
-    }
-    return false;
+    // 按 landmark 分块比较，命中后再检查瓶颈值
+    return SetIntersection::intersect_with_threshold(a, b, threshold);
 }
 
 void WeightedPrunedLandmarkIndex::prunedBFS(int curLandmark)
@@ -9,6 +9,7 @@
 #include <queue>
 #include <utility>
 #include <algorithm>
+#include "utils/SetIntersection.h"
 
 
 using namespace std;
@@ -31,9 +32,13 @@ private:
     // 内部存储的图引用
     const WeightedGraph &g;
 
-    // label[v]：存储所有能使v和其他点相通的Landmark
+    // label[v]：存储所有能使v和其他点相通的Landmark，存的是 Landmark 的秩（第几个被处理），按秩升序
     std::vector<std::vector<int>> label;
 
+    // rank[v] 是点 v 的秩，order[r] 是秩为 r 的点
+    std::vector<int> rank;
+    std::vector<int> order;
+
     // threshold: 边权小于 threshold 的边将被忽略，视为不存在
     int weightThreshold = 0; 
 
@@ -44,9 +49,6 @@ private:
     // 判断是否可以通过已有标签推断 curLandmark 与 node 可达
     bool hopQuery(int curLandmark, int node) const;
 
-    // 辅助函数：在有序的 label[node] 中插入 val（若不存在则插入）
-    void insertSorted(std::vector<int> &vec, int val) const;
-
     // 判断两个有序 vector 是否有交集
     bool intersect(const std::vector<int> &vec1,
                    const std::vector<int> &vec2) const;
@@ -76,23 +78,20 @@ void PrunedLandmarkIndex::offline_industry()
     std::sort(degrees.begin(), degrees.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b)
               { return a.first > b.first; });
 
-    // 根据排序结果生成遍历顺序
-    std::vector<int> verticesOrder(n);
+    // 根据排序结果生成遍历顺序，秩就是在这个顺序里的位置
+    order.resize(n);
+    rank.resize(n);
     for (int i = 0; i < n; ++i)
     {
-        verticesOrder[i] = degrees[i].second;
+        order[i] = degrees[i].second;
+        rank[order[i]] = i;
     }
 
-    // 按照降序度序依次对每个顶点做 BFS 扩展
-    for (int landmark : verticesOrder)
+    // 按照降序度序依次对每个顶点做 BFS 扩展，每个点在自己的 BFS 里加上自己的标签
+    for (int landmark : order)
     {
         prunedBFS(landmark);
     }
-    // 将每个点加入自己的标签集合
-    for (int i = 0; i < n; ++i)
-    {
-        insertSorted(label[i], i);
-    }
 }
 // ============ prunedBFS 实现：只做无向 BFS，忽略小权重边 ============
 void PrunedLandmarkIndex::prunedBFS(int curLandmark)
@@ -104,6 +103,8 @@ void PrunedLandmarkIndex::prunedBFS(int curLandmark)
     // BFS 队列
     std::queue<int> q;
     q.push(curLandmark);
+    // 按秩处理，curLandmark 的秩比所有已有标签都大，直接追加就是有序的
+    const int curRank = rank[curLandmark];
 
     while (!q.empty())
     {
@@ -117,11 +118,8 @@ void PrunedLandmarkIndex::prunedBFS(int curLandmark)
             continue;
         }
 
-        // 否则，把 curLandmark 这个标签加入 current 的 label
-        if (current != curLandmark)
-        {
-            insertSorted(label[current], curLandmark);
-        }
+        // 否则，把 curLandmark 这个标签加入 current 的 label（起点自己也加）
+        label[current].push_back(curRank);
 
         // 扩展 current 的邻居
         // 忽略 weight < threshold 的边
@@ -162,37 +160,11 @@ bool PrunedLandmarkIndex::hopQuery(int curLandmark, int node) const
     return intersect(label[curLandmark], label[node]);
 }
 
-// ============ 插入 val 到 vec 中（有序，不重复） ============
-void PrunedLandmarkIndex::insertSorted(std::vector<int> &vec, int val) const
-{
-    auto it = std::lower_bound(vec.begin(), vec.end(), val);
-    if (it == vec.end() || *it != val)
-    {
-        vec.insert(it, val);
-    }
-}
-
 // ============ 有序vector是否有交集 ============
 bool PrunedLandmarkIndex::intersect(const std::vector<int> &vec1,
                                     const std::vector<int> &vec2) const
 {
-    int i = 0, j = 0;
-    while (i < (int)vec1.size() && j < (int)vec2.size())
-    {
-        if (vec1[i] == vec2[j])
-        {
-            return true;
-        }
-        else if (vec1[i] < vec2[j])
-        {
-            i++;
-        }
-        else
-        {
-            j++;
-        }
-    }
-    return false;
+    return SetIntersection::intersect(vec1, vec2);
 }
 
 // ============ 对外查询 ============
@@ -10,22 +10,99 @@
 #include <iomanip>
 #include <sstream>
 #include <sys/resource.h>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+
+
+/**
+ * @brief 点集，各字段分开存成数组（SoA）。按分区号或度数扫一遍所有点时只读对应的一列，
+ * 不用把整个点（两个 vector 加几个整数）都带进缓存，热点扫描直接用 partition_ids/out_degrees 等列。
+ * vertices[u] 返回一组指向各列第 u 项的引用，原来 Vertex 结构体的写法
+ * vertices[u].LOUT.push_back(v)、vertices[u].partition_id = p 不用改。
+ * 注意 auto v = vertices[u] 拿到的也是引用而不是副本，要改时写 auto && 或 VertexTable::VertexRef，
+ * 要副本时自己复制需要的列。
+ */
+class VertexTable {
+public:
+    static constexpr uint32_t NO_EQUIVALENCE = 999999999;
+
+    std::vector<int> partition_ids;        // 分区ID，默认 -1
+    std::vector<int> out_degrees;          // 出度
+    std::vector<int> in_degrees;           // 入度
+    std::vector<uint32_t> equivalences;    // 等价类ID（强连通分量压缩用），默认 999999999
+    std::vector<std::vector<int>> out_edges;  // 出边
+    std::vector<std::vector<int>> in_edges;   // 入边
+
+    // 兼容原来 Vertex 结构体的访问方式，成员都是引用
+    template <bool Const>
+    struct Ref {
+        template <typename T>
+        using field = typename std::conditional<Const, const T, T>::type;
+        field<int> &partition_id;
+        field<std::vector<int>> &LOUT;  // 出度
+        field<std::vector<int>> &LIN;   // 入度
+        field<int> &in_degree;
+        field<int> &out_degree;
+        field<uint32_t> &equivalance;
+    };
+    using VertexRef = Ref<false>;
+    using ConstVertexRef = Ref<true>;
+
+    template <typename Table, typename Value>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Value;
+
+        Iterator(Table *table, size_t index) : table(table), index(index) {}
+        Value operator*() const { return (*table)[index]; }
+        Iterator &operator++() { ++index; return *this; }
+        bool operator==(const Iterator &other) const { return index == other.index; }
+        bool operator!=(const Iterator &other) const { return index != other.index; }
+
+    private:
+        Table *table;
+        size_t index;
+    };
+    using iterator = Iterator<VertexTable, VertexRef>;
+    using const_iterator = Iterator<const VertexTable, ConstVertexRef>;
+
+    VertexRef operator[](size_t u) {
+        return {partition_ids[u], out_edges[u], in_edges[u], in_degrees[u], out_degrees[u], equivalences[u]};
+    }
+    ConstVertexRef operator[](size_t u) const {
+        return {partition_ids[u], out_edges[u], in_edges[u], in_degrees[u], out_degrees[u], equivalences[u]};
+    }
 
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    size_t size() const { return partition_ids.size(); }
+    bool empty() const { return partition_ids.empty(); }
+
+    // 新增的点没有边，分区号 -1，没有等价类
+    void resize(size_t n) {
+        partition_ids.resize(n, -1);
+        out_degrees.resize(n, 0);
+        in_degrees.resize(n, 0);
+        equivalences.resize(n, NO_EQUIVALENCE);
+        out_edges.resize(n);
+        in_edges.resize(n);
+    }
 
-// 表示节点的结构
-struct Vertex {
-    int partition_id = -1;  // 分区ID
-    std::vector<int> LOUT;  // 出度
-    std::vector<int> LIN;   // 入度
-    int in_degree = 0;
-    int out_degree = 0;
-    uint32_t equivalance = 999999999; //等价类ID（强连通分量压缩用）
+    void clear() { resize(0); }
 };
 
 // 图的结构，支持可选的邻接表逆邻接表存储
 class Graph {
 public:
-    std::vector<Vertex> vertices;  //点集
+    VertexTable vertices;  //点集
     std::vector<std::vector<int>> adjList;  //邻接表
     std::vector<std::vector<int>> reverseAdjList; //逆邻接表
     // 构造函数，控制是否存储边集
@@ -40,6 +117,13 @@ public:
     // 添加边
     void addEdge(int u, int v, bool is_directed = true);
 
+    /**
+     * @brief 批量加边，结果和逐条 addEdge 相同（去掉自环和重复边，每个表升序），但不做逐条的有序插入：
+     * 先把所有边追加到各点的 LOUT/LIN 后面，再按点并行地排序去重一次，同时算出度数、点数和边数。
+     * 已有的边会保留并一起去重。num_threads <= 0 时使用硬件线程数。
+     */
+    void bulk_load(const std::vector<std::pair<int, int>> &edges, int num_threads = 0);
+
     bool hasEdge(int u, int v);
     // 删除边
     void removeEdge(int u, int v, bool is_directed = true);
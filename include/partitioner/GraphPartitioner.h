@@ -5,6 +5,7 @@
 #include "graph.h"
 #include "PartitionManager.h"
 #include "BidirectionalBFS.h"
+#include "SearchContext.h"
 #include <vector>
 #include <memory>
 #include <stack>
@@ -45,51 +46,53 @@ public:
     vector<map<int, PartitionReachable>> get_reachable_partitions(Graph& graph, int max_depth){
         BidirectionalBFS bibfs(graph);
         vector<map<int, PartitionReachable>> partition_reachable(graph.vertices.size(), map<int, PartitionReachable>());
+        // 每个点一次深度受限的 DFS，里面还要做可达性查询，两边的访问标记都按代复用，不在循环里分配
+        SearchContext query_context, dfs_context;
 
 
+        const vector<int> &partition_ids = graph.vertices.partition_ids;
+        const vector<int> &out_degrees = graph.vertices.out_degrees;
+        const vector<int> &in_degrees = graph.vertices.in_degrees;
         unordered_set<int> partitions;
         for(int i = 0; i < graph.vertices.size(); i++){
-            if(graph.vertices[i].out_degree == 0 && graph.vertices[i].in_degree == 0) continue;
-            partitions.insert(graph.vertices[i].partition_id);
+            if(out_degrees[i] == 0 && in_degrees[i] == 0) continue;
+            partitions.insert(partition_ids[i]);
         }
 
+        vector<pair<int,int>> stack;
         for(int i = 0; i < graph.vertices.size(); i++){
             int vertex = i;
-            if(graph.vertices[i].out_degree == 0 && graph.vertices[i].in_degree == 0) continue;
-            if(graph.vertices[i].partition_id == -1) continue;
+            if(out_degrees[i] == 0 && in_degrees[i] == 0) continue;
+            if(partition_ids[i] == -1) continue;
 
 
-            stack<pair<int,int>> stack;
-            stack.push(make_pair(i,0));
-            unordered_set<int> visited; 
-            vector<int> result;
+            stack.clear();
+            stack.push_back(make_pair(i,0));
+            dfs_context.reset(graph.vertices.size());
 
             while(!stack.empty()){
-                pair<int,int> p = stack.top();
-                stack.pop();
+                pair<int,int> p = stack.back();
+                stack.pop_back();
                 auto node = p.first;
                 auto cur_depth = p.second;
                 if(cur_depth > max_depth) continue;
                 
-                if(visited.find(node) != visited.end()) continue; // 如果节点已访问，跳过
-                
-                visited.insert(node); // 标记节点为已访问
+                if(!dfs_context.try_visit(SearchContext::FORWARD, node)) continue; // 如果节点已访问，跳过，否则标记为已访问
 
-                result.push_back(node);
                 //标记分区可达性
-                if(node != graph.vertices[vertex].partition_id && partitions.find(node) != partitions.end()){
-                    if(!partition_reachable[vertex][node].out  && bibfs.reachability_query(vertex, node)){
+                if(node != partition_ids[vertex] && partitions.find(node) != partitions.end()){
+                    if(!partition_reachable[vertex][node].out  && bibfs.reachability_query(vertex, node, query_context)){
                         partition_reachable[vertex][node].out = true;
                     }
-                    if(!partition_reachable[vertex][node].in && bibfs.reachability_query(node, vertex)){
+                    if(!partition_reachable[vertex][node].in && bibfs.reachability_query(node, vertex, query_context)){
                         partition_reachable[vertex][node].in = true;
                     }
                 }
-                for(auto neighbor : graph.vertices[node].LOUT){
-                    stack.push(make_pair(neighbor, cur_depth + 1));
+                for(auto neighbor : graph.vertices.out_edges[node]){
+                    stack.push_back(make_pair(neighbor, cur_depth + 1));
                 }
-                for(auto neighbor : graph.vertices[node].LIN){
-                    stack.push(make_pair(neighbor, cur_depth + 1));
+                for(auto neighbor : graph.vertices.in_edges[node]){
+                    stack.push_back(make_pair(neighbor, cur_depth + 1));
                 }
             }
         }
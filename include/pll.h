@@ -4,8 +4,12 @@
 #include "graph.h"
 #include "CSR.h"
 #include "Algorithm.h"
+#include "SearchContext.h"
+#include "LandmarkOrdering.h"
+#include "PLLLabelStore.h"
 #include <vector>
 #include <set>
+#include <utility>
 
 class PLL : public Algorithm
 {
@@ -13,14 +17,52 @@ public:
     PLL(Graph &graph); // 构造函数，传入图的引用
     ~PLL();
 
-    // IN和OUT集合的有序插入
-    void insertSorted(std::vector<int> &labelVec, int val);
-
     void offline_industry() override;
     bool reachability_query(int source, int target) override;
+    using Algorithm::reachability_query_batch;
+    void reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads = 0) override;
 
-    // 构建PLL标签
+    // 构建PLL标签，建标签的线程数不是 1 时用 buildPLLLabelsParallel
     void buildPLLLabels();
+    /**
+     * @brief 分批并行构建标签。按路标点顺序把它们分成若干批，批大小从 1 开始翻倍到 MAX_BATCH，
+     * 和线程数无关。同一批里的路标点各自做剪枝 BFS，只用之前各批已经合并的标签剪枝，
+     * 新标签先记在每个路标点自己的列表里，整批做完后再按点合并进 IN/OUT。
+     * 同一批的路标点互相看不到对方的标签，剪枝比逐个构建弱，标签可能多一些，但查询结果和逐个构建相同；
+     * 批的划分是固定的，所以任意线程数得到的标签完全一样。num_threads <= 0 时用硬件线程数。
+     */
+    void buildPLLLabelsParallel(int num_threads);
+    // offline_industry 建标签用的线程数，默认 1 是原来的逐个构建，其它值走 buildPLLLabelsParallel
+    void set_build_threads(int num_threads)
+    {
+        this->build_threads_ = num_threads;
+    }
+    static constexpr size_t MAX_BATCH = 256;
+
+    /**
+     * @brief 位并行路标。按路标点顺序取 num_roots 个根，每个根和它最多 63 个还没用过的邻居组成一组，
+     * 组内第 i 个点占一位。每个点每组存两个 64 位字：
+     *   bp_in  组内哪些点能到达它，bp_out 它能到达组内哪些点
+     * 查询 u -> v 先看某一组的 bp_out[u] & bp_in[v] 是否非零，再做标签求交。这些点不再做普通的剪枝 BFS，
+     * 其它路标点的 BFS 也用这几个字剪枝，普通标签会少很多。默认 0 组，和原来一样。要在 offline_industry 之前设置。
+     */
+    void set_bit_parallel_roots(int num_roots)
+    {
+        this->bit_parallel_roots_ = num_roots < 0 ? 0 : num_roots;
+    }
+    // 路标点顺序，默认度数积，见 LandmarkOrdering。要在 offline_industry 之前设置
+    void set_landmark_strategy(LandmarkOrdering::Strategy strategy)
+    {
+        this->landmark_strategy_ = strategy;
+        this->landmark_order_.clear();
+    }
+    // 直接指定路标点顺序，经过 LandmarkOrdering::complete 补全，优先于 set_landmark_strategy
+    void set_landmark_order(std::vector<int> order)
+    {
+        this->landmark_order_ = std::move(order);
+    }
+    // 实际建了多少组，点不够时可能比设置的少
+    int num_bit_parallel_roots() const { return bp_groups_; }
     // 完全体标签
     void buildPLLLabelsUnpruned();
     // 可达性查询
@@ -28,8 +70,48 @@ public:
     // 用构造的数组做可达性查询
     bool queryinArray(int source, int target);
 
+    /**
+     * @brief 标签里存的是路标点的秩（第几个被处理），不是点号。路标点按秩从小到大处理，
+     * 新标签总是比已有的大，建标签时直接追加就是有序的，不用有序插入。用 landmark() 换回点号。
+     */
     std::vector<std::vector<int>> IN;
     std::vector<std::vector<int>> OUT;
+    // 秩和点号互换，建完标签后才有意义；压缩或者从文件加载之后只能用 landmark，rank 返回 -1
+    int landmark(int rank) const { return order_.empty() ? labels_.landmark(rank) : order_[rank]; }
+    int rank(int v) const { return rank_.empty() ? -1 : rank_[v]; }
+
+    /**
+     * @brief 把 IN/OUT 和位并行的字压成 PLLLabelStore，然后释放 IN/OUT 和建标签用的邻接表，
+     * 之后的查询在压缩的标签上边解码边求交。IN/OUT 变成空的，要遍历标签用 for_each_in_label / for_each_out_label。
+     */
+    void compress_labels();
+    bool labels_compressed() const { return !labels_.empty(); }
+    // 把标签写成二进制文件，没压缩过时先临时压一份，不改变当前状态
+    bool save_labels(const std::string &filename) const;
+    // mmap 加载 save_labels 写的文件，代替 offline_industry。点数和图不一致时返回 false
+    bool load_labels(const std::string &filename);
+    // 标签覆盖的点数，压缩前后都可以用
+    size_t num_label_vertices() const { return labels_compressed() ? labels_.num_vertices() : OUT.size(); }
+
+    // 按升序把 v 的每个 IN / OUT 标签（秩）交给 f，压缩前后都可以用
+    template <typename F>
+    void for_each_in_label(int v, F &&f) const
+    {
+        if (labels_compressed())
+            labels_.for_each_in(v, f);
+        else
+            for (int r : IN[v])
+                f(r);
+    }
+    template <typename F>
+    void for_each_out_label(int v, F &&f) const
+    {
+        if (labels_compressed())
+            labels_.for_each_out(v, f);
+        else
+            for (int r : OUT[v])
+                f(r);
+    }
 
 
 
@@ -64,10 +146,22 @@ public:
         outSetsSize = out_sets_length * sizeof(uint32_t);
 
         std::vector<std::pair<std::string, std::string>> index_sizes;
-        index_sizes.emplace_back("in_pointers", std::to_string(inPointersSize));
-        index_sizes.emplace_back("out_pointers", std::to_string(outPointersSize));
-        index_sizes.emplace_back("in_sets", std::to_string(inSetsSize));
-        index_sizes.emplace_back("out_sets", std::to_string(outSetsSize));
+        // 压缩后标签只在 labels_ 里，数组的几项不再输出
+        if (!labels_compressed())
+        {
+            index_sizes.emplace_back("in_pointers", std::to_string(inPointersSize));
+            index_sizes.emplace_back("out_pointers", std::to_string(outPointersSize));
+            index_sizes.emplace_back("in_sets", std::to_string(inSetsSize));
+            index_sizes.emplace_back("out_sets", std::to_string(outSetsSize));
+        }
+        if (bp_groups_ > 0)
+            index_sizes.emplace_back("bit_parallel", std::to_string((bp_in_.size() + bp_out_.size()) * sizeof(uint64_t)));
+        if (labels_compressed())
+        {
+            index_sizes.emplace_back("compressed_labels", std::to_string(labels_.label_bytes()));
+            index_sizes.emplace_back("compressed_offsets", std::to_string(labels_.offset_bytes()));
+            index_sizes.emplace_back("compressed_bit_parallel", std::to_string(labels_.bit_parallel_bytes()));
+        }
 
         return index_sizes;
     }
@@ -78,17 +172,17 @@ private:
     std::vector<std::vector<int>> adjList;        // 正向邻接表
     std::vector<std::vector<int>> reverseAdjList; // 逆邻接表
 
-    uint32_t *in_pointers;
-    uint32_t *out_pointers;
-    uint32_t *in_sets;
-    uint32_t *out_sets;
+    uint32_t *in_pointers = nullptr;
+    uint32_t *out_pointers = nullptr;
+    uint32_t *in_sets = nullptr;
+    uint32_t *out_sets = nullptr;
 
-    // pointer的长度
-    uint32_t pointer_length;
+    // pointer的长度，没有调用 convertToArray 时为 0
+    uint32_t pointer_length = 0;
 
     // in和out sets的长度
-    uint32_t in_sets_length;
-    uint32_t out_sets_length;
+    uint32_t in_sets_length = 0;
+    uint32_t out_sets_length = 0;
 
     void buildAdjList();
     void buildInOut();
@@ -99,13 +193,53 @@ private:
     // IN和OUT集合去重
     void simplifyInOutSets();
 
+    // 位并行的组：第 k 组在每个点上的两个字是 bp_in_[u * bp_groups_ + k] 和 bp_out_[u * bp_groups_ + k]
+    int bit_parallel_roots_ = 0;
+    int bp_groups_ = 0;
+    std::vector<uint64_t> bp_in_;
+    std::vector<uint64_t> bp_out_;
+    // 建位并行的组，返回普通标签要处理的路标点（去掉了组里的点），顺序和 orderLandmarks 相同
+    std::vector<int> buildBitParallelLabels();
+    bool bitParallelQuery(int u, int v) const
+    {
+        const uint64_t *out = bp_out_.data() + static_cast<size_t>(u) * bp_groups_;
+        const uint64_t *in = bp_in_.data() + static_cast<size_t>(v) * bp_groups_;
+        for (int k = 0; k < bp_groups_; ++k)
+        {
+            if (out[k] & in[k])
+                return true;
+        }
+        return false;
+    }
+
     void bfsUnpruned(int start, bool is_reversed);
     void bfsPruned(int start);
-
+    // 和 bfsPruned 一样的剪枝 BFS，但不改 IN/OUT，要加 start 的点（包括 start 自己）分别记到 in_vertices 和 out_vertices
+    void bfsPrunedCollect(int start, SearchContext &context, std::vector<uint32_t> &in_vertices,
+                          std::vector<uint32_t> &out_vertices);
+
+    int build_threads_ = 1;
+
+    // 压缩后的标签，compress_labels 或 load_labels 之后不为空，查询走这里
+    PLLLabelStore labels_;
+    // 压缩或加载之后释放 IN/OUT、邻接表、位并行的字和秩
+    void releaseBuildLabels();
+    // 建标签前丢掉旧的标签（包括压缩的），邻接表被释放过时重新建
+    void resetBuildLabels();
+
+    // rank_[v] 是点 v 的秩，order_[r] 是秩为 r 的点
+    std::vector<int> rank_;
+    std::vector<int> order_;
+    // 路标点按 nodes 的顺序排在前面，其余的点（位并行组里的点、孤立点）按点号排在后面
+    void assignRanks(const std::vector<int> &nodes);
+
+    // 没当过路标点的点补上自己的标签，路标点在自己的 BFS 里已经加过
     void add_self();
 
-    // 确定剪枝顺序
-    std::vector<int> orderByDegree();
+    LandmarkOrdering::Strategy landmark_strategy_ = LandmarkOrdering::Strategy::DEGREE_PRODUCT;
+    std::vector<int> landmark_order_;
+    // 确定剪枝顺序：指定了顺序时用它，否则按 landmark_strategy_ 算
+    std::vector<int> orderLandmarks();
 
     // 转换成类CSR格式用于查询
     bool convertToArray();
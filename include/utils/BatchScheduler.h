@@ -0,0 +1,131 @@
+#ifndef BATCH_SCHEDULER_H
+#define BATCH_SCHEDULER_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+/**
+ * @brief 批量查询和离线建索引用的多线程调度。
+ * [0, count) 先按线程数平均切成若干段，每个线程从自己那一段的游标上按块取任务；
+ * 自己的段做完后依次去别的线程的段上取剩下的块，直到所有段都取空。
+ * 每段只有一个原子游标，线程自己取和别人来偷用的是同一个 fetch_add，不需要锁。
+ */
+class BatchScheduler
+{
+public:
+    // num_threads <= 0 时使用硬件线程数，且不超过块的数量
+    static int resolve_threads(int num_threads, size_t count, size_t chunk_size = default_chunk_size)
+    {
+        if (num_threads <= 0)
+            num_threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (num_threads <= 0)
+            num_threads = 4;
+        size_t chunks = (count + chunk_size - 1) / chunk_size;
+        if (chunks < static_cast<size_t>(num_threads))
+            num_threads = static_cast<int>(std::max<size_t>(chunks, 1));
+        return num_threads;
+    }
+
+    /**
+     * @brief 并行执行 func(thread_id, begin, end)，thread_id 在 [0, num_threads) 内，
+     * 可以用来索引每个线程自己的临时空间。num_threads 需要先经过 resolve_threads。
+     * 0 号线程就是调用线程。
+     */
+    template <typename Func>
+    static void run(size_t count, int num_threads, Func &&func, size_t chunk_size = default_chunk_size)
+    {
+        if (count == 0)
+            return;
+        if (num_threads <= 1)
+        {
+            func(0, static_cast<size_t>(0), count);
+            return;
+        }
+
+        std::vector<Range> ranges(num_threads);
+        size_t per_thread = (count + num_threads - 1) / num_threads;
+        for (int t = 0; t < num_threads; ++t)
+        {
+            size_t begin = std::min(count, per_thread * t);
+            ranges[t].next.store(begin, std::memory_order_relaxed);
+            ranges[t].end = std::min(count, begin + per_thread);
+        }
+
+        auto worker = [&](int thread_id)
+        {
+            // 先自己的段，再按顺序偷后面线程的段
+            for (int k = 0; k < num_threads; ++k)
+            {
+                Range &range = ranges[(thread_id + k) % num_threads];
+                while (true)
+                {
+                    size_t begin = range.next.fetch_add(chunk_size, std::memory_order_relaxed);
+                    if (begin >= range.end)
+                        break;
+                    func(thread_id, begin, std::min(begin + chunk_size, range.end));
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (int t = 1; t < num_threads; ++t)
+            threads.emplace_back(worker, t);
+        worker(0);
+        for (auto &th : threads)
+            th.join();
+    }
+
+    /**
+     * @brief 按下标顺序逐个分发任务，执行 func(thread_id, index)。
+     * 所有线程共用一个原子游标，先取到的下标先做。适合任务少、耗时差别大的场景，
+     * 调用方把耗时长的任务排在前面就是最长任务优先的调度。
+     */
+    template <typename Func>
+    static void run_dynamic(size_t count, int num_threads, Func &&func)
+    {
+        if (count == 0)
+            return;
+        if (num_threads <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+                func(0, i);
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        auto worker = [&](int thread_id)
+        {
+            while (true)
+            {
+                size_t index = next.fetch_add(1, std::memory_order_relaxed);
+                if (index >= count)
+                    break;
+                func(thread_id, index);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (int t = 1; t < num_threads; ++t)
+            threads.emplace_back(worker, t);
+        worker(0);
+        for (auto &th : threads)
+            th.join();
+    }
+
+    static constexpr size_t default_chunk_size = 1024;
+
+private:
+    // 每段单独占一个缓存行，避免不同线程的游标伪共享
+    struct alignas(64) Range
+    {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+};
+
+#endif // BATCH_SCHEDULER_H
@@ -0,0 +1,68 @@
+#ifndef BIT_MATRIX_H
+#define BIT_MATRIX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 连续存储的位矩阵，每行按 64 位字对齐，一个点对只占 1 位。
+ * 用来存小分区的传递闭包，行之间可以整字做或运算。
+ */
+class BitMatrix
+{
+public:
+    // 重新分配为 rows x cols 的全 0 矩阵
+    void assign(uint32_t rows, uint32_t cols)
+    {
+        rows_ = rows;
+        cols_ = cols;
+        words_per_row_ = (cols + 63) / 64;
+        words_.assign(static_cast<size_t>(rows) * words_per_row_, 0);
+    }
+
+    bool test(uint32_t row, uint32_t col) const
+    {
+        return (words_[static_cast<size_t>(row) * words_per_row_ + (col >> 6)] >> (col & 63)) & 1;
+    }
+    void set(uint32_t row, uint32_t col)
+    {
+        words_[static_cast<size_t>(row) * words_per_row_ + (col >> 6)] |= uint64_t(1) << (col & 63);
+    }
+
+    uint64_t *row(uint32_t row) { return words_.data() + static_cast<size_t>(row) * words_per_row_; }
+    const uint64_t *row(uint32_t row) const { return words_.data() + static_cast<size_t>(row) * words_per_row_; }
+
+    // dst 行 |= src 行
+    void or_row(uint32_t dst, uint32_t src)
+    {
+        uint64_t *d = row(dst);
+        const uint64_t *s = row(src);
+        for (uint32_t i = 0; i < words_per_row_; ++i)
+            d[i] |= s[i];
+    }
+    // dst 行 = src 行
+    void copy_row(uint32_t dst, uint32_t src)
+    {
+        if (dst == src)
+            return;
+        uint64_t *d = row(dst);
+        const uint64_t *s = row(src);
+        for (uint32_t i = 0; i < words_per_row_; ++i)
+            d[i] = s[i];
+    }
+
+    uint32_t rows() const { return rows_; }
+    uint32_t cols() const { return cols_; }
+    bool empty() const { return words_.empty(); }
+
+    size_t getMemoryUsage() const { return words_.size() * sizeof(uint64_t); }
+
+private:
+    uint32_t rows_ = 0;
+    uint32_t cols_ = 0;
+    uint32_t words_per_row_ = 0;
+    std::vector<uint64_t> words_;
+};
+
+#endif // BIT_MATRIX_H
@@ -0,0 +1,238 @@
+#ifndef SET_INTERSECTION_H
+#define SET_INTERSECTION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SET_INTERSECTION_X86 1
+#endif
+
+/**
+ * @brief 有序集合求交的内核，用于 2-hop 标签查询，只回答两个集合是否有公共元素。
+ * 集合必须升序且无重复。提供标量归并、SSE（4x4 分块）、AVX2（8x8 分块）三种实现，
+ * 第一次调用时按 CPU 支持的指令集选一个，之后都走同一个函数指针。
+ * 带瓶颈值的标签 (landmark, bottleneck) 只比较 landmark，命中后再在块内按阈值检查。
+ */
+class SetIntersection
+{
+public:
+    using IntKernel = bool (*)(const int32_t *a, size_t na, const int32_t *b, size_t nb);
+    using PairKernel = bool (*)(const std::pair<int, int> *a, size_t na, const std::pair<int, int> *b, size_t nb, int threshold);
+
+    // 两个升序集合是否有交集
+    static bool intersect(const int32_t *a, size_t na, const int32_t *b, size_t nb)
+    {
+        return int_kernel()(a, na, b, nb);
+    }
+    static bool intersect(const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+    {
+        // 只比较相等和大小，顶点号都小于 2^31，按有符号处理结果一样
+        return int_kernel()(reinterpret_cast<const int32_t *>(a), na, reinterpret_cast<const int32_t *>(b), nb);
+    }
+    static bool intersect(const std::vector<int> &a, const std::vector<int> &b)
+    {
+        return int_kernel()(a.data(), a.size(), b.data(), b.size());
+    }
+
+    // 两个按 first 升序的 (landmark, bottleneck) 集合是否有公共 landmark 且 min(bottleneck) >= threshold
+    static bool intersect_with_threshold(const std::vector<std::pair<int, int>> &a,
+                                         const std::vector<std::pair<int, int>> &b,
+                                         int threshold)
+    {
+        return pair_kernel()(a.data(), a.size(), b.data(), b.size(), threshold);
+    }
+
+    // 当前选用的实现名
+    static const char *kernel_name()
+    {
+        static const char *name = select_name();
+        return name;
+    }
+
+    //=================== 各个实现，测试和性能对比时可以直接调用 ===================
+
+    static bool intersect_scalar(const int32_t *a, size_t na, const int32_t *b, size_t nb)
+    {
+        size_t i = 0, j = 0;
+        while (i < na && j < nb)
+        {
+            if (a[i] == b[j])
+                return true;
+            else if (a[i] < b[j])
+                ++i;
+            else
+                ++j;
+        }
+        return false;
+    }
+
+    static bool intersect_with_threshold_scalar(const std::pair<int, int> *a, size_t na,
+                                                const std::pair<int, int> *b, size_t nb, int threshold)
+    {
+        size_t i = 0, j = 0;
+        while (i < na && j < nb)
+        {
+            if (a[i].first == b[j].first)
+            {
+                if (std::min(a[i].second, b[j].second) >= threshold)
+                    return true;
+                ++i;
+                ++j;
+            }
+            else if (a[i].first < b[j].first)
+                ++i;
+            else
+                ++j;
+        }
+        return false;
+    }
+
+#ifdef SET_INTERSECTION_X86
+    // 4x4 分块：a 的 4 个元素和 b 的 4 个元素的 4 种轮转两两比较
+    __attribute__((target("sse4.2"))) static bool intersect_sse(const int32_t *a, size_t na, const int32_t *b, size_t nb)
+    {
+        size_t i = 0, j = 0;
+        while (i + 4 <= na && j + 4 <= nb)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j));
+            if (any_equal_4x4(va, vb))
+                return true;
+            int32_t a_max = a[i + 3], b_max = b[j + 3];
+            if (a_max <= b_max)
+                i += 4;
+            if (b_max <= a_max)
+                j += 4;
+        }
+        return intersect_scalar(a + i, na - i, b + j, nb - j);
+    }
+
+    // 8x8 分块
+    __attribute__((target("avx2"))) static bool intersect_avx2(const int32_t *a, size_t na, const int32_t *b, size_t nb)
+    {
+        size_t i = 0, j = 0;
+        const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+        while (i + 8 <= na && j + 8 <= nb)
+        {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+            __m256i eq = _mm256_cmpeq_epi32(va, vb);
+            for (int k = 1; k < 8; ++k)
+            {
+                vb = _mm256_permutevar8x32_epi32(vb, rotate);
+                eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+            }
+            if (!_mm256_testz_si256(eq, eq))
+                return true;
+            int32_t a_max = a[i + 7], b_max = b[j + 7];
+            if (a_max <= b_max)
+                i += 8;
+            if (b_max <= a_max)
+                j += 8;
+        }
+        // 剩下不足 8 个的部分交给 SSE
+        return intersect_sse(a + i, na - i, b + j, nb - j);
+    }
+
+    // 每次取 4 个 (landmark, bottleneck)，把 landmark 拼到一个寄存器里比较，命中了再在这两块里按阈值检查
+    __attribute__((target("sse4.2"))) static bool intersect_with_threshold_sse(const std::pair<int, int> *a, size_t na,
+                                                                              const std::pair<int, int> *b, size_t nb, int threshold)
+    {
+        static_assert(sizeof(std::pair<int, int>) == 2 * sizeof(int32_t), "pair<int,int> must be two packed int32");
+        size_t i = 0, j = 0;
+        while (i + 4 <= na && j + 4 <= nb)
+        {
+            __m128i va = load_keys(a + i);
+            __m128i vb = load_keys(b + j);
+            if (any_equal_4x4(va, vb) &&
+                intersect_with_threshold_scalar(a + i, 4, b + j, 4, threshold))
+                return true;
+            int a_max = a[i + 3].first, b_max = b[j + 3].first;
+            if (a_max <= b_max)
+                i += 4;
+            if (b_max <= a_max)
+                j += 4;
+        }
+        return intersect_with_threshold_scalar(a + i, na - i, b + j, nb - j, threshold);
+    }
+
+    static bool has_sse()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2");
+    }
+    static bool has_avx2()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#else
+    static bool has_sse() { return false; }
+    static bool has_avx2() { return false; }
+#endif
+
+private:
+#ifdef SET_INTERSECTION_X86
+    __attribute__((target("sse4.2"))) static bool any_equal_4x4(__m128i va, __m128i vb)
+    {
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        return !_mm_testz_si128(eq, eq);
+    }
+
+    // 4 个 pair 的 first 放到一个寄存器里
+    __attribute__((target("sse4.2"))) static __m128i load_keys(const std::pair<int, int> *p)
+    {
+        __m128 lo = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        __m128 hi = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 2)));
+        return _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#endif
+
+    static IntKernel int_kernel()
+    {
+        static const IntKernel kernel = select_int_kernel();
+        return kernel;
+    }
+    static PairKernel pair_kernel()
+    {
+        static const PairKernel kernel = select_pair_kernel();
+        return kernel;
+    }
+
+    static IntKernel select_int_kernel()
+    {
+#ifdef SET_INTERSECTION_X86
+        if (has_avx2())
+            return intersect_avx2;
+        if (has_sse())
+            return intersect_sse;
+#endif
+        return intersect_scalar;
+    }
+    static PairKernel select_pair_kernel()
+    {
+#ifdef SET_INTERSECTION_X86
+        if (has_sse())
+            return intersect_with_threshold_sse;
+#endif
+        return intersect_with_threshold_scalar;
+    }
+    static const char *select_name()
+    {
+        if (has_avx2())
+            return "avx2";
+        if (has_sse())
+            return "sse4.2";
+        return "scalar";
+    }
+};
+
+#endif // SET_INTERSECTION_H
@@ -0,0 +1,214 @@
+#ifndef TEXT_PARSER_H
+#define TEXT_PARSER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "utils/BatchScheduler.h"
+
+/**
+ * @brief 文本边集和超图文件的读取。整个文件 mmap 进来，按字节数切成若干块，每块的边界向后挪到换行符之后，
+ * 各线程用 std::from_chars 解析自己的块，最后按块的顺序拼接，结果和逐行读取的顺序一致。
+ * 一行里的数之间可以是空格、制表符或者逗号；遇到不是数字的内容时这一行后面的部分忽略，
+ * 和原来 istringstream 逐个读整数的行为相同。只有头文件，超图这种 header-only 的代码也能直接用。
+ */
+class TextParser
+{
+public:
+    // 每个线程至少分到的字节数
+    static constexpr size_t MIN_BYTES_PER_CHUNK = size_t(1) << 20;
+
+    /**
+     * @brief 边集，每行 "u v"，取一行的前两个数。不足两个数的行（注释、表头）和解析不成 T 的行
+     * （例如 T 是无符号类型时的负数）跳过。打不开文件时返回 false。
+     */
+    template <typename T>
+    static bool parse_edges(const std::string &filename, std::vector<std::pair<T, T>> &edges, int num_threads = 0)
+    {
+        edges.clear();
+        MappedFile file;
+        if (!file.open(filename))
+            return false;
+        std::vector<std::vector<std::pair<T, T>>> parts;
+        parse_chunks(file, num_threads, parts, [](const char *p, const char *end, std::vector<std::pair<T, T>> &out) {
+            T values[2];
+            if (parse_line(p, end, values, 2) == 2)
+                out.emplace_back(values[0], values[1]);
+        });
+        concat(parts, edges);
+        return true;
+    }
+
+    /**
+     * @brief 每行一组数，例如一行一条超边。空行跳过，结果按行展平：第 i 行是 values[offsets[i], offsets[i + 1])。
+     * 打不开文件时返回 false。
+     */
+    template <typename T>
+    static bool parse_rows(const std::string &filename, std::vector<size_t> &offsets, std::vector<T> &values, int num_threads = 0)
+    {
+        offsets.assign(1, 0);
+        values.clear();
+        MappedFile file;
+        if (!file.open(filename))
+            return false;
+        // 每块先记录各行的长度，拼接时再换成全局偏移
+        std::vector<std::vector<T>> part_values;
+        std::vector<std::vector<size_t>> part_lengths;
+        parse_chunks(file, num_threads, part_values, [](const char *p, const char *end, std::vector<T> &out) {
+            parse_row(p, end, out);
+        }, &part_lengths);
+        for (size_t chunk = 0; chunk < part_values.size(); ++chunk)
+        {
+            for (size_t length : part_lengths[chunk])
+                offsets.push_back(offsets.back() + length);
+        }
+        concat(part_values, values);
+        return true;
+    }
+
+private:
+    // 只读映射整个文件，空文件不映射
+    struct MappedFile
+    {
+        const char *data = nullptr;
+        size_t size = 0;
+
+        bool open(const std::string &filename)
+        {
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                std::cerr << "无法打开文件: " << filename << std::endl;
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            size = static_cast<size_t>(st.st_size);
+            if (size > 0)
+            {
+                void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED)
+                {
+                    ::close(fd);
+                    std::cerr << "mmap 失败: " << filename << std::endl;
+                    size = 0;
+                    return false;
+                }
+                madvise(addr, size, MADV_SEQUENTIAL);
+                data = static_cast<const char *>(addr);
+            }
+            ::close(fd);
+            return true;
+        }
+
+        ~MappedFile()
+        {
+            if (data)
+                munmap(const_cast<char *>(data), size);
+        }
+    };
+
+    static bool is_separator(char c) { return c == ' ' || c == '\t' || c == ',' || c == '\r'; }
+
+    // 从 p 开始解析一行里最多 capacity 个数，返回解析出的个数，p 停在行尾
+    template <typename T>
+    static size_t parse_line(const char *&p, const char *end, T *values, size_t capacity)
+    {
+        size_t count = 0;
+        while (count < capacity)
+        {
+            while (p < end && is_separator(*p))
+                ++p;
+            auto result = std::from_chars(p, end, values[count]);
+            if (result.ec != std::errc())
+                break;
+            p = result.ptr;
+            ++count;
+        }
+        return count;
+    }
+
+    // 解析一整行追加到 out，返回个数
+    template <typename T>
+    static size_t parse_row(const char *&p, const char *end, std::vector<T> &out)
+    {
+        size_t count = 0;
+        T value;
+        while (parse_line(p, end, &value, 1) == 1)
+        {
+            out.push_back(value);
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief 把文件切块并行解析，parts[chunk] 是第 chunk 块的结果。parse_one(p, line_end, out) 解析一行。
+     * lengths 不为空时记录每个非空行往 out 里追加了多少个元素。
+     */
+    template <typename Part, typename ParseOne>
+    static void parse_chunks(const MappedFile &file, int num_threads, std::vector<Part> &parts, ParseOne &&parse_one,
+                             std::vector<std::vector<size_t>> *lengths = nullptr)
+    {
+        int threads = BatchScheduler::resolve_threads(num_threads, file.size, MIN_BYTES_PER_CHUNK);
+        // 块数多于线程数，解析快慢不均时可以互相偷
+        size_t chunks = threads <= 1 ? 1 : size_t(threads) * 4;
+        std::vector<size_t> bounds(chunks + 1, file.size);
+        bounds[0] = 0;
+        for (size_t chunk = 1; chunk < chunks; ++chunk)
+        {
+            size_t pos = std::max(bounds[chunk - 1], file.size / chunks * chunk);
+            while (pos > 0 && pos < file.size && file.data[pos - 1] != '\n')
+                ++pos;
+            bounds[chunk] = pos;
+        }
+        parts.assign(chunks, Part());
+        if (lengths)
+            lengths->assign(chunks, std::vector<size_t>());
+        BatchScheduler::run_dynamic(chunks, threads, [&](int, size_t chunk) {
+            const char *p = file.data + bounds[chunk];
+            const char *end = file.data + bounds[chunk + 1];
+            Part &out = parts[chunk];
+            while (p < end)
+            {
+                const char *line_end = static_cast<const char *>(memchr(p, '\n', end - p));
+                if (!line_end)
+                    line_end = end;
+                size_t before = out.size();
+                parse_one(p, line_end, out);
+                if (lengths && out.size() > before)
+                    (*lengths)[chunk].push_back(out.size() - before);
+                p = line_end + 1;
+            }
+        });
+    }
+
+    template <typename Part, typename Out>
+    static void concat(std::vector<Part> &parts, Out &out)
+    {
+        size_t total = 0;
+        for (const auto &part : parts)
+            total += part.size();
+        out.reserve(total);
+        for (auto &part : parts)
+        {
+            out.insert(out.end(), part.begin(), part.end());
+            Part().swap(part);
+        }
+    }
+};
+
+#endif // TEXT_PARSER_H
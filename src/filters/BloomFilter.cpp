@@ -1,7 +1,8 @@
 #include "BloomFilter.h"
-#include "BidirectionalBFS.h"
+#include "MultiSourceBFS.h"
 #include <cmath>
 #include <functional>
+#include "utils/BatchScheduler.h"
 
 // 构造函数
 BloomFilter::BloomFilter(Graph& graph)
@@ -11,21 +12,31 @@ BloomFilter::BloomFilter(Graph& graph)
     insertedElements.resize(numVertices, 0); // 初始化每个顶点的插入计数
 }
 
-// 离线初始化
+// 离线初始化：从所有点出发做多源BFS，u 能到达的每个点（包括 u 自己）都插入 u 的过滤器
 void BloomFilter::offline_industry() {
-    BidirectionalBFS bfs(graph);
     size_t numVertices = graph.vertices.size(); // 修改为 graph.vertices().size()
-    for (int u = 0; u < numVertices; ++u) {
-        for (int v = 0; v < numVertices; ++v) {
-            if (bfs.reachability_query(u, v)) {
-                auto hashes = generateHashes(v);
-                for (size_t h : hashes) {
-                    filters[u].set(h); // 设置对应的位
-                }
-                insertedElements[u]++; // 插入计数
-            }
+    if (numVertices == 0) {
+        return;
+    }
+    // 每个点的哈希位只算一次
+    std::vector<uint64_t> hashBits(numVertices, 0);
+    std::vector<uint32_t> sources(numVertices);
+    for (size_t v = 0; v < numVertices; ++v) {
+        for (size_t h : generateHashes(static_cast<int>(v))) {
+            hashBits[v] |= uint64_t(1) << h;
         }
+        sources[v] = static_cast<uint32_t>(v);
     }
+    // 一组起点只由一个线程处理，写 filters[u] 不需要加锁
+    GraphAdjacency adjacency(graph);
+    MultiSourceBFS<GraphAdjacency>::for_each_group(adjacency, true, sources, 0,
+        [&](int, const uint32_t *group, uint32_t v, uint64_t mask) {
+            for (; mask; mask &= mask - 1) {
+                uint32_t u = group[__builtin_ctzll(mask)];
+                filters[u] |= std::bitset<64>(hashBits[v]); // 设置对应的位
+                insertedElements[u]++; // 插入计数
+            }
+        });
 }
 
 // 计算假阳性率
@@ -47,15 +58,38 @@ bool BloomFilter::reachability_query(int source, int target) {
     if (source < 0 || source >= filters.size() || target < 0 || target >= filters.size()) {
         return false; // 非法索引返回不可达
     }
-    auto hashes = generateHashes(target);
-    for (size_t h : hashes) {
-        if (!filters[source].test(h)) {
+    return contains(source, target);
+}
+
+// 和 generateHashes 的哈希序列一致，但不生成临时数组，查询时不申请内存
+bool BloomFilter::contains(int source, int target) const {
+    std::hash<int> hasher;
+    size_t seed = target;
+    for (size_t i = 0; i < numHashFunctions; ++i) {
+        seed = hasher(seed);
+        if (!filters[source].test(seed % 64)) {
             return false; // 如果某一位没有被置1，则不可达
         }
     }
     return true; // 可能可达
 }
 
+// 批量查询，过滤器只读，多线程直接并发调用
+void BloomFilter::reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads) {
+    auto worker = [&](int, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            int source = queries[i].first;
+            int target = queries[i].second;
+            if (source < 0 || source >= filters.size() || target < 0 || target >= filters.size()) {
+                out[i] = 0;
+                continue;
+            }
+            out[i] = contains(source, target) ? 1 : 0;
+        }
+    };
+    BatchScheduler::run(count, BatchScheduler::resolve_threads(num_threads, count), worker);
+}
+
 // 计算索引大小
 std::vector<std::pair<std::string, std::string>> BloomFilter::getIndexSizes() const {
     std::vector<std::pair<std::string, std::string>> indexSizes;
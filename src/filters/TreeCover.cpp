@@ -1,6 +1,7 @@
 #include <vector>
 
 #include "TreeCover.h"
+#include "utils/BatchScheduler.h"
 
 using namespace std;
 
@@ -86,3 +87,13 @@ bool TreeCover::reachability_query(int source, int target)
     return false;
 }
 
+// 区间判断只读索引，多线程直接并发调用
+void TreeCover::reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads)
+{
+    auto worker = [&](int, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            out[i] = reachability_query(queries[i].first, queries[i].second) ? 1 : 0;
+    };
+    BatchScheduler::run(count, BatchScheduler::resolve_threads(num_threads, count), worker);
+}
@@ -26,15 +26,11 @@ void LabelPropagationPartitioner::partition(Graph& graph, PartitionManager& part
                     continue; // 忽略无连接的节点
                 std::unordered_map<int, int> label_counts;
                 // 统计邻居的分区
-                uint32_t out_degree = csr.getOutDegree(node);
-                uint32_t in_degree = csr.getInDegree(node);
-                for (uint32_t i = 0; i < out_degree; ++i) {
-                    int neighbor = csr.out_column_indices[csr.out_row_pointers[node] + i];
+                for (uint32_t neighbor : csr.outNeighbors(node)) {
                     if (partitions[neighbor] != -1)
                         label_counts[partitions[neighbor]]++;
                 }
-                for (uint32_t i = 0; i < in_degree; ++i) {
-                    int neighbor = csr.in_column_indices[csr.in_row_pointers[node] + i];
+                for (uint32_t neighbor : csr.inNeighbors(node)) {
                     if (partitions[neighbor] != -1)
                         label_counts[partitions[neighbor]]++;
                 }
@@ -38,8 +38,8 @@ double LouvainPartitioner::compute_gain(int node, int target_partition, Graph& g
 void LouvainPartitioner::partition(Graph& graph, PartitionManager& partition_manager) {
     // 计算总边数 m
     double m = 0.0;
-    for (const auto& vertex : graph.vertices) {
-        m += vertex.LOUT.size();
+    for (int degree : graph.vertices.out_degrees) {
+        m += degree;
     }
 
     // 初始化：每个节点初始在自己的社区中
@@ -52,7 +52,7 @@ void LouvainPartitioner::partition(Graph& graph, PartitionManager& partition_man
         improvement = false;
         for (size_t node = 0; node < graph.vertices.size(); ++node) {
             // 检查当前节点是否存在相邻节点
-            if (graph.vertices[node].LOUT.empty() && graph.vertices[node].LIN.empty()) {
+            if (graph.vertices.out_degrees[node] == 0 && graph.vertices.in_degrees[node] == 0) {
                 continue; 
             }
 
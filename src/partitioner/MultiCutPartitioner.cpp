@@ -18,8 +18,9 @@ int max_partitions_count = 6; // 最大分区数，大于这个会停止迭代
 
 int force_times = 5; // 强制划分次数
 
-// 辅助函数：划分弱连通分量，先做初步分区
-void initial_partition(CSRGraph &csr, std::vector<int> &partition)
+// 辅助函数：划分弱连通分量，先做初步分区。Adjacency 是 CSRGraph 或 CompressedCSR
+template <typename Adjacency>
+void initial_partition(const Adjacency &csr, std::vector<int> &partition)
 {
     int num_nodes = csr.max_node_id + 1;
     for (int i = 0; i < num_nodes; ++i)
@@ -57,22 +58,18 @@ void initial_partition(CSRGraph &csr, std::vector<int> &partition)
             visited[node] = true;
             component.push_back(node);
 
-            uint32_t out_degree = 0;
-            auto *out_neighbors = csr.getOutgoingEdges(node, out_degree);
-            for (int j = 0; j < out_degree; ++j)
+            for (int neighbor : csr.outNeighbors(node))
             {
-                if (!visited[out_neighbors[j]] && partition[out_neighbors[j]] == out_neighbors[j])
+                if (!visited[neighbor] && partition[neighbor] == neighbor)
                 {
-                    stack.push_back(out_neighbors[j]);
+                    stack.push_back(neighbor);
                 }
             }
-            uint32_t in_degree = 0;
-            auto *in_neighbors = csr.getIncomingEdges(node, in_degree);
-            for (int j = 0; j < in_degree; ++j)
+            for (int neighbor : csr.inNeighbors(node))
             {
-                if (!visited[in_neighbors[j]] && partition[in_neighbors[j]] == in_neighbors[j])
+                if (!visited[neighbor] && partition[neighbor] == neighbor)
                 {
-                    stack.push_back(in_neighbors[j]);
+                    stack.push_back(neighbor);
                 }
             }
         }
@@ -117,7 +114,8 @@ void Union(std::vector<int> &parent, std::vector<int> &rank, int x, int y)
 }
 
 // Karger实现
-pair<int, int> kargerMinCutCSR(CSRGraph &csr, std::vector<int> &partition, int partition_id)
+template <typename Adjacency>
+pair<int, int> kargerMinCutCSR(const Adjacency &csr, std::vector<int> &partition, int partition_id)
 {
 
     std::vector<std::pair<int, int>> edges;
@@ -128,13 +126,11 @@ pair<int, int> kargerMinCutCSR(CSRGraph &csr, std::vector<int> &partition, int p
             continue; 
         }
 
-        uint32_t degree;
-        uint32_t *neighbors = csr.getOutgoingEdges(u, degree);
-        for (int i = 0; i < degree; ++i)
+        for (int neighbor : csr.outNeighbors(u))
         {
-            if (partition[neighbors[i]] == partition_id)
+            if (partition[neighbor] == partition_id)
             {
-                edges.emplace_back(u, neighbors[i]);
+                edges.emplace_back(u, neighbor);
             }
         }
     }
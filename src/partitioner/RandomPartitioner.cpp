@@ -13,7 +13,7 @@ void RandomPartitioner::partition(Graph &graph, PartitionManager &partition_mana
     
     vector<int> nodes(graph.get_num_vertices()+10, -1);
     for(int i = 0; i<graph.vertices.size(); i++){
-        if(graph.vertices[i].out_degree == 0 && graph.vertices[i].in_degree == 0) {
+        if(graph.vertices.out_degrees[i] == 0 && graph.vertices.in_degrees[i] == 0) {
             continue;
         }
         nodes.push_back(i);
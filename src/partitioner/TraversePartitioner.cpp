@@ -87,16 +87,12 @@ vector<u32> TraversePartitioner::dfs(
             }
         }
 
-        u32 degree;
-        auto out_neighbors = csr_->getOutgoingEdges(node, degree);
-        for(auto i = 0; i < degree; i++){
-            stack.push(make_pair(out_neighbors[i], cur_depth + 1));
+        for(auto neighbor : csr_->outNeighbors(node)){
+            stack.push(make_pair(neighbor, cur_depth + 1));
         }
 
-        degree = 0;
-        auto in_neighbors = csr_->getIncomingEdges(node, degree);
-        for(auto i = 0; i < degree; i++){
-            stack.push(make_pair(in_neighbors[i], cur_depth + 1));
+        for(auto neighbor : csr_->inNeighbors(node)){
+            stack.push(make_pair(neighbor, cur_depth + 1));
         }
     }
 
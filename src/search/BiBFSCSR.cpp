@@ -1,111 +1,51 @@
 #include "BiBFSCSR.h"
 #include "graph.h"
 #include "CSR.h"
+#include "utils/BatchScheduler.h"
 
-BiBFSCSR::BiBFSCSR(Graph &graph) : g(graph) {
+BiBFSCSR::BiBFSCSR(Graph &graph) : g(&graph) {
     csr = make_shared<CSRGraph>();
-    csr->fromGraph(g);
+    csr->fromGraph(graph);
+}
+
+BiBFSCSR::BiBFSCSR(shared_ptr<CSRGraph> csr) : g(nullptr), csr(std::move(csr)) {
+}
+
+BiBFSCSR::BiBFSCSR(shared_ptr<CompressedCSR> compressed) : g(nullptr), compressed(std::move(compressed)) {
 }
 
 bool BiBFSCSR::reachability_query(int source, int target)
 {
-    auto result = findPath(source, target);
-    if (!result.empty()) {
-        return true;
-    }
-    return false;
+    return reachability_query(source, target, SearchContext::local());
 }
 
-std::vector<int> BiBFSCSR::findPath(int source, int target, int partition_number)
+bool BiBFSCSR::reachability_query(int source, int target, SearchContext &context) const
 {
-    if (source == target) {
-        return {source};
-    }
-
-    std::queue<int> queue_forward, queue_backward;
-    std::unordered_set<int> visited_forward, visited_backward;
-    std::unordered_map<int, int> parent_forward, parent_backward;
-
-    queue_forward.push(source);
-    visited_forward.insert(source);
-    parent_forward[source] = -1;
-
-    queue_backward.push(target);
-    visited_backward.insert(target);
-    parent_backward[target] = -1;
-
-    while (!queue_forward.empty() && !queue_backward.empty()) {
-        // 正向搜索
-        if (!queue_forward.empty()) {
-            int current = queue_forward.front();
-            queue_forward.pop();
-
-            uint32_t degree;
-            uint32_t* neighbors = csr->getOutgoingEdges(current, degree);
-            if (neighbors != nullptr) {
-                for (uint32_t i = 0; i < degree; ++i) {
-                    int neighbor = neighbors[i];
-                    if (visited_backward.find(neighbor) != visited_backward.end()) {
-                        // 找到路径
-                        std::vector<int> path;
-                        int node = current;
-                        while (node != -1) {
-                            path.push_back(node);
-                            node = parent_forward[node];
-                        }
-                        std::reverse(path.begin(), path.end());
-                        node = neighbor;
-                        while (node != -1) {
-                            path.push_back(node);
-                            node = parent_backward[node];
-                        }
-                        return path;
-                    }
-                    if (visited_forward.find(neighbor) == visited_forward.end()) {
-                        queue_forward.push(neighbor);
-                        visited_forward.insert(neighbor);
-                        parent_forward[neighbor] = current;
-                    }
-                }
-            }
-        }
+    if (compressed)
+        return context.bitmap_engine(*compressed).reachable(source, target);
+    return context.bitmap_engine(*csr).reachable(source, target);
+}
 
-        // 反向搜索
-        if (!queue_backward.empty()) {
-            int current = queue_backward.front();
-            queue_backward.pop();
+std::vector<int> BiBFSCSR::findPath(int source, int target, int partition_number)
+{
+    return findPath(source, target, partition_number, SearchContext::local());
+}
 
-            uint32_t degree;
-            uint32_t* neighbors = csr->getIncomingEdges(current, degree);
-            if (neighbors != nullptr) {
-                for (uint32_t i = 0; i < degree; ++i) {
-                    int neighbor = neighbors[i];
-                    if (visited_forward.find(neighbor) != visited_forward.end()) {
-                        // 找到路径
-                        std::vector<int> path;
-                        int node = neighbor;
-                        while (node != -1) {
-                            path.push_back(node);
-                            node = parent_forward[node];
-                        }
-                        std::reverse(path.begin(), path.end());
-                        node = current;
-                        while (node != -1) {
-                            path.push_back(node);
-                            node = parent_backward[node];
-                        }
-                        return path;
-                    }
-                    if (visited_backward.find(neighbor) == visited_backward.end()) {
-                        queue_backward.push(neighbor);
-                        visited_backward.insert(neighbor);
-                        parent_backward[neighbor] = current;
-                    }
-                }
-            }
-        }
-    }
+std::vector<int> BiBFSCSR::findPath(int source, int target, int partition_number, SearchContext &context) const
+{
+    if (compressed)
+        return context.bitmap_engine(*compressed).find_path(source, target);
+    return context.bitmap_engine(*csr).find_path(source, target);
+}
 
-    // 未找到路径
-    return {};
-}
\ No newline at end of file
+void BiBFSCSR::reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads)
+{
+    num_threads = BatchScheduler::resolve_threads(num_threads, count);
+    std::vector<SearchContext> contexts(num_threads);
+    auto worker = [&](int thread_id, size_t begin, size_t end) {
+        SearchContext &context = contexts[thread_id];
+        for (size_t i = begin; i < end; ++i)
+            out[i] = reachability_query(queries[i].first, queries[i].second, context) ? 1 : 0;
+    };
+    BatchScheduler::run(count, num_threads, worker);
+}
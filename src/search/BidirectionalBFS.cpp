@@ -1,7 +1,5 @@
 #include "BidirectionalBFS.h"
 #include <iostream>
-#include <queue>
-#include <unordered_set>
 #include <vector>
 #include <algorithm>
 #include <thread>
@@ -32,39 +30,70 @@ void BidirectionalBFS::buildAdjList() {
 void BidirectionalBFS::offline_industry()
 {
     this->buildAdjList();
+    compressed.reset();
     return;
 }
 
+void BidirectionalBFS::compress_adjacency()
+{
+    compressed = std::unique_ptr<CompressedCSR>(new CompressedCSR());
+    compressed->fromGraph(g);
+    // 两个邻接表不再使用
+    std::vector<std::vector<int>>().swap(adjList);
+    std::vector<std::vector<int>>().swap(reverseAdjList);
+}
+
 // 双向BFS查询
 bool BidirectionalBFS::reachability_query(int source, int target) {
+    return reachability_query(source, target, SearchContext::local());
+}
+
+bool BidirectionalBFS::reachability_query(int source, int target, SearchContext &context) const {
+    return reachability_query(source, target, -1, context);
+}
+
+bool BidirectionalBFS::reachability_query(int source, int target, int partition_number, SearchContext &context) const {
+    if (compressed) {
+        return reachable(source, target, partition_number, compressed->max_node_id + 1, context,
+                         [&](int u) { return compressed->outNeighbors(u); },
+                         [&](int u) { return compressed->inNeighbors(u); });
+    }
+    return reachable(source, target, partition_number, adjList.size(), context,
+                     [&](int u) -> const std::vector<int>& { return adjList[u]; },
+                     [&](int u) -> const std::vector<int>& { return reverseAdjList[u]; });
+}
+
+template <typename Out, typename In>
+bool BidirectionalBFS::reachable(int source, int target, int partition_number, size_t num_nodes, SearchContext &context,
+                                 Out &&out_neighbors, In &&in_neighbors) const {
     if (source == target) return true;
-    if (source >= adjList.size() || target >= adjList.size() || source < 0 || target < 0) {
+    if (source >= num_nodes || target >= num_nodes || source < 0 || target < 0) {
         return false; // 如果超出范围，直接返回不可达
     }
         // 检查是否为孤立节点（无出边且无入边）
-    if (adjList[source].empty() && reverseAdjList[source].empty()) return false;
-    if (adjList[target].empty() && reverseAdjList[target].empty()) return false;
-    
-    // BFS队列
-    std::queue<int> queueFromSource, queueFromTarget;
-    std::unordered_set<int> visitedFromSource, visitedFromTarget;
+    if (out_neighbors(source).empty() && in_neighbors(source).empty()) return false;
+    if (out_neighbors(target).empty() && in_neighbors(target).empty()) return false;
+
+    // 初始化，访问标记和队列都在 context 里，这里只是换一代
+    context.reset(num_nodes);
+    context.push(SearchContext::FORWARD, source);
+    context.visit(SearchContext::FORWARD, source);
 
-    // 初始化
-    queueFromSource.push(source);
-    visitedFromSource.insert(source);
+    context.push(SearchContext::BACKWARD, target);
+    context.visit(SearchContext::BACKWARD, target);
 
-    queueFromTarget.push(target);
-    visitedFromTarget.insert(target);
+    // 指定了分区时，不在分区内的邻居跳过
+    auto accept = [&](int v) { return partition_number == -1 || g.get_partition_id(v) == partition_number; };
 
     // 开始双向BFS
-    while (!queueFromSource.empty() && !queueFromTarget.empty()) {
+    while (!context.queue_empty(SearchContext::FORWARD) && !context.queue_empty(SearchContext::BACKWARD)) {
         // 从source侧扩展一步
-        if (bfsStep(queueFromSource, visitedFromSource, visitedFromTarget, adjList)) {
+        if (bfsStep(context, SearchContext::FORWARD, out_neighbors, accept)) {
             return true;
         }
 
         // 从target侧扩展一步，使用逆邻接表
-        if (bfsStep(queueFromTarget, visitedFromTarget, visitedFromSource, reverseAdjList)) {
+        if (bfsStep(context, SearchContext::BACKWARD, in_neighbors, accept)) {
             return true;
         }
     }
@@ -72,30 +101,27 @@ bool BidirectionalBFS::reachability_query(int source, int target) {
     return false;
 }
 
-// 单次BFS步进，扩展一层
-bool BidirectionalBFS::bfsStep(std::queue<int>& queue, std::unordered_set<int>& visited, 
-                               std::unordered_set<int>& opposite_visited, 
-                               const std::vector<std::vector<int>>& adjList) {
-    if (queue.empty()) return false;
-
-    int current = queue.front();
-    queue.pop();
+// 单次BFS步进，扩展一个点
+template <typename Neighbors, typename Accept>
+bool BidirectionalBFS::bfsStep(SearchContext &context, int side, Neighbors &&neighbors_of, Accept &&accept) {
+    if (context.queue_empty(side)) return false;
 
-    // 检查邻接表有效性
-    if (current >= adjList.size()) return false;
+    int current = context.pop(side);
+    int opposite = side == SearchContext::FORWARD ? SearchContext::BACKWARD : SearchContext::FORWARD;
 
-    // 获取邻居节点
-    const auto& neighbors = adjList[current];
-    for (int neighbor : neighbors) {
+    // 获取邻居节点，current 都是从合法的起点扩展出来的
+    for (int neighbor : neighbors_of(current)) {
+        if (!accept(neighbor)) {
+            continue;
+        }
         // 如果在对方的访问集合中，说明路径相遇
-        if (opposite_visited.find(neighbor) != opposite_visited.end()) {
+        if (context.visited(opposite, neighbor)) {
             return true;
         }
 
         // 如果未访问过该节点，则加入访问队列
-        if (visited.find(neighbor) == visited.end()) {
-            visited.insert(neighbor);
-            queue.push(neighbor);
+        if (context.try_visit(side, neighbor)) {
+            context.push(side, neighbor);
         }
     }
 
@@ -104,6 +130,23 @@ bool BidirectionalBFS::bfsStep(std::queue<int>& queue, std::unordered_set<int>&
 
 // 必须指定分区号，否则无法进行分区内搜索
 std::vector<int> BidirectionalBFS::findPath(int source, int target, int partition_number) {
+    return findPath(source, target, partition_number, SearchContext::local());
+}
+
+std::vector<int> BidirectionalBFS::findPath(int source, int target, int partition_number, SearchContext &context) const {
+    if (compressed) {
+        return find_path(source, target, partition_number, context,
+                         [&](int u) { return compressed->outNeighbors(u); },
+                         [&](int u) { return compressed->inNeighbors(u); });
+    }
+    return find_path(source, target, partition_number, context,
+                     [&](int u) -> const std::vector<int>& { return adjList[u]; },
+                     [&](int u) -> const std::vector<int>& { return reverseAdjList[u]; });
+}
+
+template <typename Out, typename In>
+std::vector<int> BidirectionalBFS::find_path(int source, int target, int partition_number, SearchContext &context,
+                                             Out &&out_neighbors, In &&in_neighbors) const {
     if (source == target) {
         return {source};
     }
@@ -122,39 +165,38 @@ std::vector<int> BidirectionalBFS::findPath(int source, int target, int partitio
     }
 
 
-    // 初始化队列和访问集合，以及父节点记录
-    std::queue<int> forward_queue, backward_queue;
-    std::unordered_set<int> forward_visited, backward_visited;
-    std::unordered_map<int, int> forward_parent, backward_parent;
+    // 初始化队列和访问标记，以及父节点记录，都在 context 里复用
+    const int FORWARD = SearchContext::FORWARD, BACKWARD = SearchContext::BACKWARD;
+    context.reset(g.vertices.size());
+    std::vector<int> &forward_parent = context.parents(FORWARD);
+    std::vector<int> &backward_parent = context.parents(BACKWARD);
 
-    forward_queue.push(source);
-    forward_visited.insert(source);
+    context.push(FORWARD, source);
+    context.visit(FORWARD, source);
     forward_parent[source] = -1;  // 起点的父节点设为 -1
 
-    backward_queue.push(target);
-    backward_visited.insert(target);
+    context.push(BACKWARD, target);
+    context.visit(BACKWARD, target);
     backward_parent[target] = -1; // 终点的父节点设为 -1
 
     int meeting_node = -1; // 记录正反搜索相遇的节点
 
-    while (!forward_queue.empty() && !backward_queue.empty()) {
+    while (!context.queue_empty(FORWARD) && !context.queue_empty(BACKWARD)) {
         // 正向搜索一步
-        int forward_current = forward_queue.front();
-        forward_queue.pop();
+        int forward_current = context.pop(FORWARD);
 
-        for (int neighbor : adjList[forward_current]) {
+        for (int neighbor : out_neighbors(forward_current)) {
             // 如果指定了分区，且邻居节点不在指定分区内，跳过
             if (partition_number != -1 && g.get_partition_id(neighbor) != partition_number) {
                 continue;
             }
 
-            if (forward_visited.find(neighbor) == forward_visited.end()) {
-                forward_visited.insert(neighbor);
+            if (context.try_visit(FORWARD, neighbor)) {
                 forward_parent[neighbor] = forward_current;
-                forward_queue.push(neighbor);
+                context.push(FORWARD, neighbor);
 
                 // 检查是否在反向已访问集合中
-                if (backward_visited.find(neighbor) != backward_visited.end()) {
+                if (context.visited(BACKWARD, neighbor)) {
                     meeting_node = neighbor; // 记录相遇节点
                     break; // 跳出循环
                 }
@@ -166,22 +208,20 @@ std::vector<int> BidirectionalBFS::findPath(int source, int target, int partitio
         }
 
         // 反向搜索一步
-        int backward_current = backward_queue.front();
-        backward_queue.pop();
+        int backward_current = context.pop(BACKWARD);
 
-        for (int neighbor : reverseAdjList[backward_current]) {
+        for (int neighbor : in_neighbors(backward_current)) {
             // 如果指定了分区，且邻居节点不在指定分区内，跳过
             if (partition_number != -1 && g.get_partition_id(neighbor) != partition_number) {
                 continue;
             }
 
-            if (backward_visited.find(neighbor) == backward_visited.end()) {
-                backward_visited.insert(neighbor);
+            if (context.try_visit(BACKWARD, neighbor)) {
                 backward_parent[neighbor] = backward_current;
-                backward_queue.push(neighbor);
+                context.push(BACKWARD, neighbor);
 
                 // 检查是否在正向已访问集合中
-                if (forward_visited.find(neighbor) != forward_visited.end()) {
+                if (context.visited(FORWARD, neighbor)) {
                     meeting_node = neighbor; // 记录相遇节点
                     break; // 跳出循环
                 }
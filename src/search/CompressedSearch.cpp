@@ -9,6 +9,10 @@
 #include "partitioner/TraversePartitioner.h"
 #include "BloomFilter.h"
 #include "AddEdge.h"
+#include "MultiSourceBFS.h"
+#include "SCCCondenser.h"
+#include "utils/BatchScheduler.h"
+#include <cassert>
 #include <memory>
 #include <stdexcept>
 #include <iostream>
@@ -17,6 +21,9 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <stack>
+#include <atomic>
+#include <mutex>
+#include <chrono>
 
 void CompressedSearch::set_partitioner(std::string partitioner_name)
 {
@@ -69,16 +76,26 @@ void CompressedSearch::offline_industry()
     // 构建 Node Embedding
     // node_embedding_.build(g);
     part_bfs_csr = std::unique_ptr<BiBFSCSR>(new BiBFSCSR(partition_manager_.part_g));
+    prepare_query_scratch(scratch_);
 }
 
 void CompressedSearch::offline_industry(size_t num_vertices, float ratio, string mapping_file)
 {
-
-    // TODO：执行压缩
-
+    // 压缩由 SCCCondenser 或者离线脚本完成，这里只读等价信息
     if (mapping_file != "")
         partition_manager_.read_equivalance_info(mapping_file); ///< 读取等价信息
 
+    build_offline_index(num_vertices, ratio);
+}
+
+void CompressedSearch::offline_industry(size_t num_vertices, float ratio, const std::vector<uint32_t> &equivalence)
+{
+    partition_manager_.set_equivalence_info(equivalence);
+    build_offline_index(num_vertices, ratio);
+}
+
+void CompressedSearch::build_offline_index(size_t num_vertices, float ratio)
+{
     construct_filter(ratio); ///< 构建过滤器
 
     // 加边
@@ -91,6 +108,8 @@ void CompressedSearch::offline_industry(size_t num_vertices, float ratio, string
     // 建立分区相互联系的图
     part_bfs = std::unique_ptr<BidirectionalBFS>(new BidirectionalBFS(partition_manager_.part_g));
     part_bfs_csr = std::unique_ptr<BiBFSCSR>(new BiBFSCSR(partition_manager_.part_g));
+
+    prepare_query_scratch(scratch_);
 }
 
 void CompressedSearch::construct_filter(float ratio)
@@ -103,12 +122,14 @@ void CompressedSearch::construct_filter(float ratio)
         // 稠密：不可达索引
         filter = std::unique_ptr<BloomFilter>(new BloomFilter(g));
         filter_name_ = "unreachable";
+        filter_kind_ = FilterKind::Unreachable;
     }
     else
     {
         // 稀疏：可达索引
         filter = std::unique_ptr<TreeCover>(new TreeCover(g));
         filter_name_ = "reachable";
+        filter_kind_ = FilterKind::Reachable;
     }
     filter->offline_industry();
 }
@@ -121,11 +142,21 @@ void CompressedSearch::construct_filter(float ratio)
  */
 bool CompressedSearch::reachability_query(int origin_source, int origin_target)
 {
-    cout << getCurrentTimestamp() << "开始查询" << origin_source << "to" << origin_target << endl;
+    return query(origin_source, origin_target, scratch_);
+}
+
+/**
+ * @brief 查询主体。查询路径上不做 IO，也不申请内存，临时空间都在 scratch 里复用。
+ * 各阶段的耗时通过 QUERY_TRACE 记录到 scratch.trace，编译时没有打开 REACH_QUERY_TRACE 时不产生任何代码。
+ */
+bool CompressedSearch::query(int origin_source, int origin_target, QueryScratch &scratch)
+{
     if (origin_source == origin_target)
         return true;
+    QUERY_TRACE_START(eq_start);
     uint32_t target = partition_manager_.get_equivalance_mapping(origin_target);
     uint32_t source = partition_manager_.get_equivalance_mapping(origin_source);
+    QUERY_TRACE(scratch.trace, QueryStage::EquivalenceMapping, eq_start, source, target, TRACE_UNDECIDED);
     // if (source >= g.vertices.size() || target >= g.vertices.size() || source < 0 || target < 0)
     // {
     //     return false;
@@ -137,46 +168,45 @@ bool CompressedSearch::reachability_query(int origin_source, int origin_target)
     // }
 
     // 使用filter快速判断
-    if (filter_name_ != "")
+    if (filter_kind_ != FilterKind::None)
     {
+        QUERY_TRACE_START(filter_start);
         bool filter_result = filter->reachability_query(source, target);
-        if (filter_name_ == "unreachable")
+        if (filter_kind_ == FilterKind::Unreachable && filter_result == false)
         {
-            if (filter_result == false)
-            {
-                cout << getCurrentTimestamp() << "过滤不可达" << endl;
-                return false;
-            }
+            // 过滤不可达
+            QUERY_TRACE(scratch.trace, QueryStage::Filter, filter_start, source, target, TRACE_UNREACHABLE);
+            return false;
         }
-        else if (filter_name_ == "reachable")
+        if (filter_kind_ == FilterKind::Reachable && filter_result == true)
         {
-            if (filter_result == true)
-            {
-                cout << getCurrentTimestamp() << "过滤可达" << endl;
-                return true;
-            }
+            // 过滤可达
+            QUERY_TRACE(scratch.trace, QueryStage::Filter, filter_start, source, target, TRACE_REACHABLE);
+            return true;
         }
+        QUERY_TRACE(scratch.trace, QueryStage::Filter, filter_start, source, target, TRACE_UNDECIDED);
     }
 
     bool result = false;
+    QUERY_TRACE_START(lookup_start);
     int source_partition = partition_manager_.get_partition_id(source);
     int target_partition = partition_manager_.get_partition_id(target);
+    QUERY_TRACE(scratch.trace, QueryStage::PartitionLookup, lookup_start, source, target, TRACE_UNDECIDED);
     // int source_partition = g.get_partition_id(source);
     // int target_partition = g.get_partition_id(target);
-    cout << getCurrentTimestamp() << "分区确定" << source_partition << "  " << target_partition << endl;
     if (source_partition == target_partition)
     {
-
-        if (this->is_index)
-        {
-            result = query_index_within_partition(source, target, source_partition); ///< 同分区带索引查询
-        }
-        else
-        {
-            result = query_within_partition(source, target); ///< 同分区查询
-        }
-        return result;
+        QUERY_TRACE_START(probe_start);
+        result = query_intra_probe(source, target, source_partition); ///< 同分区查询
+        QUERY_TRACE(scratch.trace, QueryStage::IntraIndexProbe, probe_start, source, target, result);
+        if (result || source_partition == -1)
+            return result;
         // return bfs.reachability_query(source, target); //全图找
+        // 分区内不可达，还要看能不能从出口出去再从入口绕回来
+        QUERY_TRACE_START(detour_start);
+        result = query_across_partitions(source, target, scratch);
+        QUERY_TRACE(scratch.trace, QueryStage::CrossPartitionSearch, detour_start, source, target, result);
+        return result;
     }
     else if (source_partition == -1 || target_partition == -1)
     {
@@ -184,12 +214,56 @@ bool CompressedSearch::reachability_query(int origin_source, int origin_target)
     }
     else
     {
-        // result =  query_across_partitions(source, target); ///< 跨分区查询
-        result = query_across_partitions_with_all_paths(source, target); ///< 跨分区查询
+        QUERY_TRACE_START(cross_start);
+        result = query_across_partitions(source, target, scratch); ///< 跨分区查询
+        QUERY_TRACE(scratch.trace, QueryStage::CrossPartitionSearch, cross_start, source, target, result);
         return result;
     }
 }
 
+/**
+ * @brief 批量查询。索引在离线阶段建好之后只读，每个线程一份 QueryScratch 即可并发查询。
+ */
+void CompressedSearch::reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads)
+{
+    num_threads = BatchScheduler::resolve_threads(num_threads, count);
+    if (num_threads <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = query(queries[i].first, queries[i].second, scratch_) ? 1 : 0;
+        return;
+    }
+    std::vector<QueryScratch> scratches(num_threads);
+    for (auto &scratch : scratches)
+        prepare_query_scratch(scratch);
+    auto worker = [&](int thread_id, size_t begin, size_t end)
+    {
+        QueryScratch &scratch = scratches[thread_id];
+        for (size_t i = begin; i < end; ++i)
+            out[i] = query(queries[i].first, queries[i].second, scratch) ? 1 : 0;
+    };
+    BatchScheduler::run(count, num_threads, worker);
+}
+
+/**
+ * @brief 按分区图的大小准备查询临时空间，离线建索引之后调用一次。
+ */
+void CompressedSearch::prepare_query_scratch(QueryScratch &scratch) const
+{
+    size_t max_exits = 0, max_entries = 0;
+    for (const auto &boundary : boundary_nodes_)
+    {
+        max_exits = std::max(max_exits, boundary.exits.size());
+        max_entries = std::max(max_entries, boundary.entries.size());
+    }
+    scratch.source_set.clear();
+    scratch.source_set.reserve(max_exits);
+    scratch.target_set.clear();
+    scratch.target_set.reserve(max_entries);
+    scratch.hub_mark.assign(pll_connect_g == nullptr ? 0 : pll_connect_g->num_label_vertices(), 0);
+    scratch.hub_round = 0;
+}
+
 /**
  * @brief 执行图分区算法。
  */
@@ -221,258 +295,147 @@ bool CompressedSearch::query_within_partition(int source, int target)
         return false;
     }
     int partition_id = g.get_partition_id(source);
-    auto result = bfs.findPath(source, target, partition_id);
-    if (result.size() > 0)
-    {
-        return true;
-    }
-    return false;
+    return bfs.reachability_query(source, target, partition_id, SearchContext::local());
 }
 
 bool CompressedSearch::query_index_within_partition(int source, int target, int partition_id)
 {
-
-    cout << getCurrentTimestamp() + "在" << partition_id << "分区内查询" << source << "到" << target << endl;
     // 先过滤是否可达
     if (source == target)
         return true;
     if (g.vertices[source].out_degree == 0 || g.vertices[target].in_degree == 0)
         return false;
-    auto &subgraph = partition_manager_.partition_subgraphs[partition_id];
-    // if(source >= subgraph.vertices.size() || target >= subgraph.vertices.size() || source < 0 || target < 0) {
-    //     return false;
-    // }
     if (g.get_partition_id(source) != g.get_partition_id(target))
     {
         return false;
     }
-    cout << getCurrentTimestamp() << "    start searching in index" << endl;
-    // 在三个索引中查询
-    if (subgraph.get_num_vertices() < this->num_vertices)
+    // 索引都按分区内的局部编号存
+    const auto &subgraphs = partition_manager_.partition_subgraphs;
+    uint32_t local_source = subgraphs.local_id(source);
+    uint32_t local_target = subgraphs.local_id(target);
+    if (local_source == PartitionSubgraphs::INVALID_ID || local_target == PartitionSubgraphs::INVALID_ID)
+        return false;
+    switch (get_index_kind(partition_id))
+    {
+    case PartitionIndexKind::Small:
     {
-        cout << getCurrentTimestamp() + "开始查询小索引" << endl;
         // 使用 small_index_ 进行查询
-        auto &node_to_index = small_mapping_[partition_id];
-        if (node_to_index.find(source) == node_to_index.end() || node_to_index.find(target) == node_to_index.end())
-        {
-            cout << getCurrentTimestamp() + "越界" << endl;
-            return false;
-        }
-        int mapped_source = node_to_index[source];
-        int mapped_target = node_to_index[target];
-        bool result = small_index_[partition_id][mapped_source][mapped_target].test(0);
-        cout << getCurrentTimestamp() + "汇报结果" << endl;
-        return result;
+        return small_index_[partition_id].test(local_source, local_target);
     }
-    else if (subgraph.get_ratio() < this->ratio)
-    {
+    case PartitionIndexKind::PLL:
         // 使用 PLL 进行查询
-        cout << getCurrentTimestamp() << "  开始查询pll索引" << endl;
-        bool result = pll_index_[partition_id]->reachability_query(source, target);
-        cout << getCurrentTimestamp() << "  pll索引查询完成" << endl;
-        return result;
-    }
-    else
+        return pll_index_[partition_id]->reachability_query(local_source, local_target);
+    case PartitionIndexKind::Unreachable:
     {
-        // 使用 unreachable_index_ 进行查询
-        cout << getCurrentTimestamp() + "开始查询不可达索引" << endl;
-        auto &node_to_index = unreachable_mapping_[partition_id];
-        if (node_to_index.find(source) == node_to_index.end())
-        {
-            return true;
-        }
-        int mapped_source = node_to_index[source];
-        int mapped_target = node_to_index[target];
-        for (auto &edge : unreachable_index_[partition_id][mapped_source])
-        {
-            if (mapped_target == edge)
-                return false;
-        }
-        return true;
+        // 使用 unreachable_index_ 进行查询，不在不可达表里就是可达
+        const auto &row = unreachable_index_[partition_id][local_source];
+        return !std::binary_search(row.begin(), row.end(), local_target);
     }
+    default:
+        // 没有建索引的分区（只有一个点或者没有分区内的边）
+        return false;
+    }
+}
 
-    return false;
+CompressedSearch::PartitionIndexKind CompressedSearch::get_index_kind(int partition_id) const
+{
+    if (partition_id < 0 || static_cast<size_t>(partition_id) >= index_kind_.size())
+        return PartitionIndexKind::None;
+    return index_kind_[partition_id];
+}
+
+/**
+ * @brief 分区内查询，有索引时查索引，否则在分区内做BFS。
+ */
+bool CompressedSearch::query_intra_probe(int source, int target, int partition_id)
+{
+    if (this->is_index)
+        return query_index_within_partition(source, target, partition_id); ///< 同分区带索引查询
+    return query_within_partition(source, target);                          ///< 同分区查询
 }
 
 /**
- * @brief 在不同分区间进行可达性查询。
+ * @brief 经过出入口点的可达性查询。
+ * 先在源分区内找源点能到的出口点，在目标分区内找能到目标点的入口点，
+ * 再在出入口图上判断这两个点集之间是否可达。出入口图里分区内的连边是按全图可达性加的，
+ * 所以这一步相当于全图上的可达性，源和目标在同一分区时也可以用来判断绕出分区再回来的路径。
  * @param source 源节点。
  * @param target 目标节点。
  * @return 如果可达返回 true，否则返回 false。
  */
-bool CompressedSearch::query_across_partitions(int source, int target)
+bool CompressedSearch::query_across_partitions(int source, int target, QueryScratch &scratch)
 {
-    auto source_partition = g.get_partition_id(source);
-    auto target_partition = g.get_partition_id(target);
-    // 找分区的路径
-    // TODO：这个路径不行就换一个路径，需要迭代一个个路径找下去，可能要把过程放到bfs里面，这个不行继续bfs遍历去找
-    // 版本1 直接输出所有路径然后去遍历，直到没有路径为止
-
-    std::vector<int> path = part_bfs->findPath(source_partition, target_partition);
-    if (path.empty())
+    int source_partition = partition_manager_.get_partition_id(source);
+    int target_partition = partition_manager_.get_partition_id(target);
+    if (source_partition < 0 || target_partition < 0 ||
+        static_cast<size_t>(source_partition) >= boundary_nodes_.size() ||
+        static_cast<size_t>(target_partition) >= boundary_nodes_.size())
+        return false;
+    const auto &exits = boundary_nodes_[source_partition].exits;
+    const auto &entries = boundary_nodes_[target_partition].entries;
+    if (exits.empty() || entries.empty())
         return false;
-    auto edges = partition_manager_.get_partition_adjacency(path[0], path[1]);
-    return dfs_partition_search(source, edges.original_edges, path, target);
-}
-
-bool CompressedSearch::query_across_partitions_with_all_paths(int source, int target)
-{
-    int source_partition = g.get_partition_id(source);
-    int target_partition = g.get_partition_id(target);
-    bool flag = false;
-    // 枚举所有路径
-    std::vector<std::vector<int>> all_paths;
-    std::vector<int> path;
-    std::unordered_set<int> visited;
-    bool result = dfs_paths_search(source_partition, target_partition, path, all_paths, visited, source, target);
-    return result;
-}
-
-bool CompressedSearch::dfs_paths_search(int current_partition, int target_partition,
-                                        std::vector<int> &path,
-                                        std::vector<std::vector<int>> &all_paths,
-                                        std::unordered_set<int> &visited,
-                                        int source,
-                                        int target)
-{
-    visited.insert(current_partition);
-    path.push_back(current_partition);
-    bool result = false;
 
-    // 跑到了目标分区，将途径的分区放到path里面，传给dfs函数，递归去找各个出口和入口点集合能不能依次有边相连
-    if (current_partition == target_partition)
+    vector<int> &source_set = scratch.source_set;
+    vector<int> &target_set = scratch.target_set;
+    source_set.clear();
+    target_set.clear();
+    for (auto node : exits)
     {
-        all_paths.push_back(path);
-#ifdef DEBUG
-        cout << getCurrentTimestamp() << " 分区可达，开始用新方法查询" << endl;
-        result = part_connection_graph_search(path, source, target);
-        if (result)
-            return true;
-        else
-            goto target;
-#endif
-        auto edges = partition_manager_.get_partition_adjacency(path[0], path[1]);
-        result = dfs_partition_search(source, edges.original_edges, path, target);
-        if (result)
-            return true;
-        cout << getCurrentTimestamp() << " 分区可达，但顶点之间没有可达路径" << endl;
+        if (query_intra_probe(source, node, source_partition))
+            source_set.push_back(node);
     }
-    // 如果当前分区不是目标分区，继续递归搜索
-    else
+    if (source_set.empty())
+        return false;
+    for (auto node : entries)
     {
-        // 获取当前分区的所有相邻分区
-        std::vector<int> neighbors = partition_manager_.part_g.vertices[current_partition].LOUT;
-        for (int neighbor : neighbors)
-        {
-            if (visited.find(neighbor) == visited.end())
-            {
-                result = dfs_paths_search(neighbor, target_partition, path, all_paths, visited, source, target);
-                if (result)
-                    return true;
-            }
-        }
+        if (query_intra_probe(node, target, target_partition))
+            target_set.push_back(node);
     }
-#ifdef DEBUG
-target:
-#endif
-    path.pop_back();
-    // 当前的分区改成未访问，在以此为根的生成树中已经遍历完成，不需要防止重复遍历
-    // 从别的分区还可以有边过来，也就是说从别的点为根的子树中可以被访问，等下次访问到再说防止重复遍历的事情
-    visited.erase(current_partition);
-    return result;
+
+    return set_reachability(source_set, target_set, scratch);
 }
 
 /**
- * @brief 已有分区级别的可达路径，按照这个路径执行分区间的迭代式DFS搜索。看是否确实有边相连
- * @param current_partition 当前分区ID。
- * @param target_partition 目标分区ID。
- * @param visited 已访问的分区集合。
- * @param path 从当前节点出发的可达路径集合
- * @return 如果可达返回 true，否则返回 false。
+ * @brief 计算分区子图的传递闭包，结果按局部编号写进位矩阵。
+ * 用 SCCCondenser::tarjan_components 求强连通分量，分量按逆拓扑序（汇点在前）完成，
+ * 所以每个分量完成时它的后继分量都已经算好，把后继行按字或进来即可，复杂度 O(|P|*|E|/64)。
+ * 同一分量的点可达集合相同，只算一行再复制。环上的点对自己也置位，查询时 source == target 已提前返回。
  */
-bool CompressedSearch::dfs_partition_search(int u, std::vector<std::pair<int, int>> edges, std::vector<int> path, int target)
+static void build_transitive_closure(const PartitionSubgraphs::View &view, BitMatrix &matrix)
 {
-    auto current_partition = path[0];
-    if (current_partition != g.get_partition_id(u))
-    {
-        throw std::logic_error("Current partition from path[] does not match the partition of node u");
-    }
-    bool result = false;
-    for (auto &edge : edges)
-    {
-        cout << getCurrentTimestamp() << "当前边: " << edge.first << " -> " << edge.second << endl;
-        // 上一个前序点无法到达这条边就下一轮循环
-        if (is_index)
-        {
-            if (!query_index_within_partition(u, edge.first, current_partition))
-                continue;
-        }
-        else
+    const uint32_t n = view.num_vertices;
+    matrix.assign(n, n);
+    if (n == 0)
+        return;
+
+    const uint32_t UNVISITED = PartitionSubgraphs::INVALID_ID;
+    std::vector<uint32_t> component(n, UNVISITED);
+    std::vector<uint32_t> representative; // 分量号 -> 存放这个分量结果的行
+    SubgraphAdjacency adjacency(view);
+    SCCCondenser::tarjan_components(adjacency, [&](const uint32_t *members, size_t count)
+    {
+        uint32_t id = static_cast<uint32_t>(representative.size());
+        uint32_t row = members[0];
+        for (size_t i = 0; i < count; ++i)
+            component[members[i]] = id;
+        representative.push_back(row);
+
+        for (size_t i = 0; i < count; ++i)
         {
-            if (!query_within_partition(u, edge.first))
-                continue;
-        }
-        // 如果下一个分区是终点分区就使用BFS查找，如果不是指向终点分区就继续递归找
-        auto next_partition = path[1];
-        if (g.get_partition_id(target) == next_partition)
-        {
-            if (is_index)
+            uint32_t degree;
+            const uint32_t *out = view.out_neighbors(members[i], degree);
+            for (uint32_t k = 0; k < degree; ++k)
             {
-                result = query_index_within_partition(edge.second, target, next_partition);
+                uint32_t w = out[k];
+                matrix.set(row, w);
+                if (component[w] != id)
+                    matrix.or_row(row, representative[component[w]]);
             }
-            else
-                result = query_within_partition(edge.second, target);
-            if (result)
-                return true;
         }
-        else
-        {
-            std::vector<int> remain_path(path.begin() + 1, path.end());
-            auto next_edges = partition_manager_.get_partition_adjacency(remain_path[0], remain_path[1]);
-            result = dfs_partition_search(edge.second, next_edges.original_edges, remain_path, target);
-            if (result)
-                return true;
-        }
-    }
-
-    return result;
-}
-
-/**
- * @brief 判断可达的分区是否存在可达路径。
- *
- * @param path
- * @return true
- * @return false
- */
-bool CompressedSearch::part_connection_graph_search(std::vector<int> path, int source, int target)
-{
-    auto current_partition = path[0];
-    auto second_partition = path[1];
-    auto tail_partition = path[path.size() - 1];
-    auto tail_second_partition = path[path.size() - 2];
-
-    vector<int> outgoing_nodes = partition_manager_.connect_nodes[current_partition][second_partition].outgoing_nodes;
-    vector<int> incoming_nodes = partition_manager_.connect_nodes[tail_partition][tail_second_partition].incoming_nodes;
-
-    // TODO：从出口集合和入口集合中找source和target能相连的点
-    vector<int> source_set;
-    vector<int> target_set;
-    for (auto &node : outgoing_nodes)
-    {
-        if (query_within_partition(source, node))
-            source_set.push_back(node);
-    }
-
-    for (auto &node : incoming_nodes)
-    {
-        if (query_within_partition(node, target))
-            target_set.push_back(node);
-    }
-
-    bool result = set_reachability(source_set, target_set);
-
-    return result;
+        for (size_t i = 0; i < count; ++i)
+            matrix.copy_row(members[i], row);
+    });
 }
 
 // TODO:构建索引的时候用全局搜索，避免两个点绕过一个分区来相连
@@ -496,167 +459,193 @@ void CompressedSearch::build_partition_index(float ratio, size_t num_vertices)
     }
 #endif
 
-    // TODO： 计算分区链接图上的索引，在后面能 一次性获取所有出口点到入口点的可达点对
-    // 这个索引能接收两个点集，返回两个点集的笛卡尔积中的可达的部分
-    // 先做个pll去循环吧
-    this->pll_connect_g = make_shared<PLL>(*(this->partition_manager_.part_connect_g));
-    this->pll_connect_g->offline_industry();
+    build_boundary_index();
 
     this->ratio = ratio;
     this->num_vertices = num_vertices;
-    for (auto &subgraph : this->partition_manager_.partition_subgraphs)
-    {
-        if (subgraph.first == -1 || subgraph.second.get_num_vertices() <= 1)
-            continue;
-        // 计算分区的比例信息
-        float total_ratio = compute_reach_ratio(subgraph.second);
-        auto partition_id = subgraph.first;
-
-        // 根据情况构建索引,如果点数小于100那么就要建立一个子图的邻接矩阵
-        // 如果g.get_num_vertices点数大于传进来的num_vertices,看分区图的ratio
-        // ratio < 传进来的ratio,那么就建立PLL索引
-        // ratio >= 传进来的ratio,那么就建立不可达的邻接表,对子图做V*V的循环,每个里面调用一次双边BFS,如果不可达就记录下来
-        // 建立索引的方案是,在CompressSearch中建立三个数据结构
-        if (subgraph.second.get_num_vertices() < num_vertices)
+    const auto &subgraphs = this->partition_manager_.partition_subgraphs;
+    int max_partition = -1;
+    for (int partition_id : subgraphs.partition_ids())
+        max_partition = std::max(max_partition, partition_id);
+    for (auto *pll : pll_index_)
+        delete pll;
+    // 所有分区的位置先分配好，建索引时各线程只写自己的分区
+    index_kind_.assign(max_partition + 1, PartitionIndexKind::None);
+    small_index_.assign(max_partition + 1, BitMatrix());
+    unreachable_index_.assign(max_partition + 1, std::vector<std::vector<uint32_t>>());
+    pll_index_.assign(max_partition + 1, nullptr);
+    pll_graphs_.clear();
+    pll_graphs_.resize(max_partition + 1);
+
+    // 只有一个点或者没有分区内边的分区不建索引
+    // 剩下的按估计耗时从大到小排，大分区先建，避免最后只剩一个大分区在跑
+    std::vector<int> order;
+    for (int partition_id : subgraphs.partition_ids())
+    {
+        if (partition_id != -1 && subgraphs.get(partition_id).num_connected > 1)
+            order.push_back(partition_id);
+    }
+    auto estimated_cost = [&](int partition_id)
+    {
+        auto view = subgraphs.get(partition_id);
+        return static_cast<uint64_t>(view.num_vertices) * (view.num_vertices + view.num_edges);
+    };
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                     { return estimated_cost(a) > estimated_cost(b); });
+
+    int num_threads = BatchScheduler::resolve_threads(build_threads_, order.size(), 1);
+    std::vector<BuildScratch> scratches(num_threads);
+    build_stats_.assign(order.size(), PartitionBuildStat());
+#ifdef DEBUG
+    std::cout << Algorithm::getCurrentTimestamp() << "开始构建 " << order.size() << " 个分区的索引，线程数 " << num_threads << std::endl;
+    std::atomic<size_t> finished{0};
+    std::mutex print_mutex;
+    auto build_start = std::chrono::high_resolution_clock::now();
+#endif
+    BatchScheduler::run_dynamic(order.size(), num_threads, [&](int thread_id, size_t i)
+                                {
+        int partition_id = order[i];
+        auto view = subgraphs.get(partition_id);
+        auto start = std::chrono::high_resolution_clock::now();
+        PartitionIndexKind kind = build_single_partition_index(partition_id, scratches[thread_id]);
+        auto end = std::chrono::high_resolution_clock::now();
+        index_kind_[partition_id] = kind;
+        PartitionBuildStat &stat = build_stats_[i];
+        stat.partition_id = partition_id;
+        stat.kind = kind;
+        stat.num_vertices = view.num_vertices;
+        stat.num_edges = view.num_edges;
+        stat.thread_id = thread_id;
+        stat.seconds = std::chrono::duration<double>(end - start).count();
+#ifdef DEBUG
+        // 每完成 10% 打印一次进度
+        size_t done = finished.fetch_add(1) + 1;
+        if (done * 10 / order.size() != (done - 1) * 10 / order.size())
         {
-            // 构建可达索引:可达矩阵
-            // 映射后的号
-            size_t index = 0;
-            // 第一位是源节点，第二位是索引中的序号
-            std::unordered_map<size_t, size_t> node_to_index;
-            for (size_t i = 0; i < subgraph.second.vertices.size(); i++)
-            {
-                if (subgraph.second.vertices[i].in_degree > 0 || subgraph.second.vertices[i].out_degree > 0)
-                {
-                    node_to_index[i] = index++;
-                }
-            }
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::cout << Algorithm::getCurrentTimestamp() << "已完成 " << done << "/" << order.size() << " 个分区的索引" << std::endl;
+        }
+#endif
+    });
 
-            small_mapping_[subgraph.first] = node_to_index;
-            small_index_[subgraph.first] = std::vector<std::vector<std::bitset<1>>>(index, std::vector<std::bitset<1>>(index));
+    std::sort(build_stats_.begin(), build_stats_.end(), [](const PartitionBuildStat &a, const PartitionBuildStat &b)
+              { return a.seconds > b.seconds; });
+#ifdef DEBUG
+    auto build_end = std::chrono::high_resolution_clock::now();
+    std::cout << "分区索引构建耗时 " << std::chrono::duration<double>(build_end - build_start).count() << " s" << std::endl;
+    auto report = get_build_report();
+    // 只打印汇总和最慢的 10 个分区
+    for (size_t i = 0; i < report.size() && i < 14; i++)
+        std::cout << report[i] << std::endl;
+#endif
+}
 
-            // 初始化为全 0（实际上已经是全 0，不需要额外操作）
-            for (size_t u = 0; u < subgraph.second.vertices.size(); u++)
-            {
-                if (subgraph.second.vertices[u].in_degree == 0 && subgraph.second.vertices[u].out_degree == 0)
-                    continue;
-                for (size_t v = 0; v < subgraph.second.vertices.size(); v++)
-                {
-                    if (subgraph.second.vertices[v].in_degree == 0 && subgraph.second.vertices[v].out_degree == 0)
-                        continue;
-                    if (u == v)
-                        continue;
-                    if (this->query_within_partition(u, v))
-                    {
-                        int mapped_u = node_to_index[u];
-                        int mapped_v = node_to_index[v];
-
-                        small_index_[subgraph.first][mapped_u][mapped_v].set(0); // 设置为 1 表示可达
-                    }
-                }
-            }
-            // 打印二维数组
-            // std::cout<<"small_index_:"<<std::endl;
-            // for (size_t i = 0; i < small_index_[subgraph.first].size(); i++) {
-            //     for (size_t j = 0; j < small_index_[subgraph.first][i].size(); j++) {
-            //         std::cout << small_index_[subgraph.first][i][j] << " ";
-            //     }
-            //     std::cout << std::endl;
-            // }
-        }
-        else if (total_ratio < ratio)
+/**
+ * @brief 构建一个分区的索引，只写这个分区自己在各个索引数组里的位置，可以在多个线程里同时调用。
+ * @return 建的索引类型
+ */
+CompressedSearch::PartitionIndexKind CompressedSearch::build_single_partition_index(int partition_id, BuildScratch &scratch)
+{
+    auto view = partition_manager_.partition_subgraphs.get(partition_id);
+    uint32_t n = view.num_vertices;
+    auto &visited = scratch.visited;
+    auto &queue = scratch.queue;
+    visited.assign(n, PartitionSubgraphs::INVALID_ID);
+    queue.reserve(n);
+    // 从局部编号 start 出发BFS，visited[v] == start 表示可达
+    auto bfs_from = [&](uint32_t start)
+    {
+        queue.clear();
+        queue.push_back(start);
+        visited[start] = start;
+        for (size_t head = 0; head < queue.size(); ++head)
         {
-            // 构建pll
-            pll_index_[subgraph.first] = new PLL(subgraph.second);
-            pll_index_[subgraph.first]->offline_industry();
-            // 打印 PLL 的 IN 和 OUT 集合
-#ifdef DEBUG
-            std::cout << "PLL IN and OUT sets for partition " << subgraph.first << ":" << std::endl;
-            for (size_t i = 0; i < pll_index_[subgraph.first]->IN.size(); ++i)
+            uint32_t degree;
+            const uint32_t *neighbors = view.out_neighbors(queue[head], degree);
+            for (uint32_t i = 0; i < degree; ++i)
             {
-                if (pll_index_[subgraph.first]->IN[i].size() > 0)
+                if (visited[neighbors[i]] != start)
                 {
-                    std::cout << "Node " << i << " IN: ";
-                    for (int in_node : pll_index_[subgraph.first]->IN[i])
-                    {
-                        std::cout << in_node << " ";
-                    }
-                    std::cout << std::endl;
+                    visited[neighbors[i]] = start;
+                    queue.push_back(neighbors[i]);
                 }
             }
+        }
+    };
 
-            for (size_t i = 0; i < pll_index_[subgraph.first]->OUT.size(); ++i)
-            {
-                if (pll_index_[subgraph.first]->OUT[i].empty())
-                    continue;
-                std::cout << "Node " << i << " OUT: ";
-                for (int out_node : pll_index_[subgraph.first]->OUT[i])
-                {
-                    std::cout << out_node << " ";
-                }
-                std::cout << std::endl;
-            }
-#endif
+    // 根据情况构建索引,如果点数小于100那么就要建立一个子图的邻接矩阵
+    // 如果g.get_num_vertices点数大于传进来的num_vertices,看分区图的ratio
+    // ratio < 传进来的ratio,那么就建立PLL索引
+    // ratio >= 传进来的ratio,那么就建立不可达的邻接表,对子图做V*V的循环,如果不可达就记录下来
+    // 所有索引都直接用子图的局部编号
+    if (view.num_connected < num_vertices)
+    {
+        // 构建可达索引:传递闭包位矩阵
+        build_transitive_closure(view, small_index_[partition_id]);
+        return PartitionIndexKind::Small;
+    }
+    if (compute_reach_ratio(view) < ratio)
+    {
+        // 构建pll，PLL 需要 Graph，按局部编号建一个只含分区内边的小图
+        auto local_graph = std::unique_ptr<Graph>(new Graph(false));
+        local_graph->vertices.resize(n);
+        for (uint32_t u = 0; u < n; u++)
+        {
+            uint32_t degree;
+            const uint32_t *neighbors = view.out_neighbors(u, degree);
+            for (uint32_t i = 0; i < degree; i++)
+                local_graph->addEdge(u, neighbors[i]);
         }
-        else
+        PLL *pll = new PLL(*local_graph);
+        pll->set_landmark_strategy(landmark_strategy_);
+        pll->offline_industry();
+        if (compress_labels_)
+            pll->compress_labels();
+        pll_index_[partition_id] = pll;
+        pll_graphs_[partition_id] = std::move(local_graph);
+        return PartitionIndexKind::PLL;
+    }
+    // 构建不可达的邻接表，每行按局部编号升序
+    auto &unreachable_adj = unreachable_index_[partition_id];
+    unreachable_adj.assign(n, std::vector<uint32_t>());
+    for (uint32_t u = 0; u < n; u++)
+    {
+        bfs_from(u);
+        for (uint32_t v = 0; v < n; v++)
         {
-            // 构建不可达的邻接表
-            // 初始化映射和不可达邻接表
-            std::unordered_map<size_t, size_t> &node_to_index = unreachable_mapping_[partition_id];
-            std::vector<std::vector<size_t>> &unreachable_adj = unreachable_index_[partition_id];
-            size_t current_index = 0;
-
-            // 遍历子图中的所有节点对，记录不可达的点对
-            for (size_t u = 0; u < subgraph.second.vertices.size(); u++)
-            {
-                if (subgraph.second.vertices[u].in_degree == 0 && subgraph.second.vertices[u].out_degree == 0)
-                    continue;
-                for (size_t v = 0; v < subgraph.second.vertices.size(); v++)
-                {
-                    if (subgraph.second.vertices[v].in_degree == 0 && subgraph.second.vertices[v].out_degree == 0)
-                        continue;
-                    if (u == v)
-                        continue;
-                    bool result = this->query_within_partition(u, v);
-                    if (!result)
-                    {
-
-                        // 只在遇到不可达点对时进行映射
-                        // 如果source未映射，则映射并扩展不可达邻接表
-                        if (node_to_index.find(u) == node_to_index.end())
-                        {
-                            node_to_index[u] = current_index++;
-                            unreachable_adj.emplace_back(); // 添加一个新的邻接列表
-                        }
-
-                        // 如果target未映射，则映射
-                        if (node_to_index.find(v) == node_to_index.end())
-                        {
-                            node_to_index[v] = current_index++;
-                            unreachable_adj.emplace_back(); // 添加一个新的邻接列表
-                        }
-
-                        size_t mapped_u = node_to_index[u];
-                        size_t mapped_v = node_to_index[v];
-                        unreachable_adj[mapped_u].push_back(mapped_v);
-                    }
-                }
-            }
-#ifdef DEBUG
-            // 打印不可达邻接表
-            std::cout << "Unreachable Adjacency List " << std::endl;
-            for (size_t i = 0; i < unreachable_adj.size(); i++)
-            {
-                std::cout << "Node " << i << ": ";
-                for (size_t j = 0; j < unreachable_adj[i].size(); j++)
-                {
-                    std::cout << unreachable_adj[i][j] << " ";
-                }
-                std::cout << std::endl;
-            }
-#endif
+            if (v != u && visited[v] != u)
+                unreachable_adj[u].push_back(v);
         }
     }
+    return PartitionIndexKind::Unreachable;
+}
+
+std::vector<std::string> CompressedSearch::get_build_report() const
+{
+    static const char *kind_names[] = {"None", "Small", "PLL", "Unreachable"};
+    std::vector<std::string> lines;
+    double total[4] = {0, 0, 0, 0};
+    size_t count[4] = {0, 0, 0, 0};
+    for (const auto &stat : build_stats_)
+    {
+        total[static_cast<int>(stat.kind)] += stat.seconds;
+        count[static_cast<int>(stat.kind)]++;
+    }
+    for (int kind = 1; kind < 4; kind++)
+    {
+        std::stringstream ss;
+        ss << kind_names[kind] << ": " << count[kind] << " partitions, " << total[kind] << " s";
+        lines.push_back(ss.str());
+    }
+    lines.push_back("partition  kind  vertices  edges  thread  seconds");
+    for (const auto &stat : build_stats_)
+    {
+        std::stringstream ss;
+        ss << stat.partition_id << "  " << kind_names[static_cast<int>(stat.kind)] << "  " << stat.num_vertices
+           << "  " << stat.num_edges << "  " << stat.thread_id << "  " << stat.seconds;
+        lines.push_back(ss.str());
+    }
+    return lines;
 }
 /**
  * @brief 遍历所有分区并打印其索引以及ratio
@@ -691,61 +680,63 @@ std::vector<std::string> CompressedSearch::get_index_info()
         lines.push_back(ss.str());
     }
 
-    for (const auto &subgraph : partition_manager_.partition_subgraphs)
+    for (int partition_id : partition_manager_.partition_subgraphs.partition_ids())
     {
-        if (subgraph.first == -1)
-            continue;
-        auto partition_id = subgraph.first;
+        auto view = partition_manager_.partition_subgraphs.get(partition_id);
 
         // 打印子图的 ratio 值
-        lines.push_back("Ratio for partition " + std::to_string(partition_id) + ": " + std::to_string(subgraph.second.get_ratio()));
+        lines.push_back("Ratio for partition " + std::to_string(partition_id) + ": " + std::to_string(compute_reach_ratio(view)));
 
-        if (subgraph.second.get_num_vertices() < num_vertices)
+        // 索引里都是局部编号，打印时换回全局点号
+        auto kind = get_index_kind(partition_id);
+        if (kind == PartitionIndexKind::Small)
         {
             // 打印 small_index_
             lines.push_back("Small Index for partition " + std::to_string(partition_id) + ":");
-            for (size_t i = 0; i < small_index_[partition_id].size(); i++)
+            const auto &matrix = small_index_[partition_id];
+            for (uint32_t i = 0; i < matrix.rows(); i++)
             {
                 std::stringstream ss;
-                for (size_t j = 0; j < small_index_[partition_id][i].size(); j++)
+                for (uint32_t j = 0; j < matrix.cols(); j++)
                 {
-                    ss << small_index_[partition_id][i][j] << " ";
+                    ss << matrix.test(i, j) << " ";
                 }
                 lines.push_back(ss.str());
             }
         }
-        else if (subgraph.second.get_ratio() < ratio)
+        else if (kind == PartitionIndexKind::PLL)
         {
             // 打印 PLL 的 IN 和 OUT 集合
             lines.push_back("PLL IN and OUT sets for partition " + std::to_string(partition_id) + ":");
-            for (size_t i = 0; i < pll_index_[partition_id]->IN.size(); ++i)
+            const PLL *pll = pll_index_[partition_id];
+            // 标签可能已经压缩，统一用 for_each 遍历
+            for (size_t i = 0; i < pll->num_label_vertices(); ++i)
             {
-                if (pll_index_[partition_id]->IN[i].size() > 0)
-                {
-                    std::stringstream ss;
-                    ss << "Node " << i << " IN: ";
-                    for (int in_node : pll_index_[partition_id]->IN[i])
-                    {
-                        ss << in_node << " ";
-                    }
+                std::stringstream ss;
+                bool any = false;
+                ss << "Node " << view.global_id(i) << " IN: ";
+                pll->for_each_in_label(i, [&](int in_node) {
+                    ss << view.global_id(pll->landmark(in_node)) << " ";
+                    any = true;
+                });
+                if (any)
                     lines.push_back(ss.str());
-                }
             }
 
-            for (size_t i = 0; i < pll_index_[partition_id]->OUT.size(); ++i)
+            for (size_t i = 0; i < pll->num_label_vertices(); ++i)
             {
-                if (pll_index_[partition_id]->OUT[i].empty())
-                    continue;
                 std::stringstream ss;
-                ss << "Node " << i << " OUT: ";
-                for (int out_node : pll_index_[partition_id]->OUT[i])
-                {
-                    ss << out_node << " ";
-                }
-                lines.push_back(ss.str());
+                bool any = false;
+                ss << "Node " << view.global_id(i) << " OUT: ";
+                pll->for_each_out_label(i, [&](int out_node) {
+                    ss << view.global_id(pll->landmark(out_node)) << " ";
+                    any = true;
+                });
+                if (any)
+                    lines.push_back(ss.str());
             }
         }
-        else
+        else if (kind == PartitionIndexKind::Unreachable)
         {
             // 打印不可达邻接表
             lines.push_back("Unreachable Adjacency List for partition " + std::to_string(partition_id) + ":");
@@ -753,10 +744,10 @@ std::vector<std::string> CompressedSearch::get_index_info()
             for (size_t i = 0; i < unreachable_adj.size(); i++)
             {
                 std::stringstream ss;
-                ss << "Node " << i << ": ";
+                ss << "Node " << view.global_id(i) << ": ";
                 for (size_t j = 0; j < unreachable_adj[i].size(); j++)
                 {
-                    ss << unreachable_adj[i][j] << " ";
+                    ss << view.global_id(unreachable_adj[i][j]) << " ";
                 }
                 lines.push_back(ss.str());
             }
@@ -767,21 +758,81 @@ std::vector<std::string> CompressedSearch::get_index_info()
 }
 
 /**
- * @brief 集合之间的可达性，有一个可达就整体返回true, 若遍历全图仍没有就返回false
- *
+ * @brief 集合之间的可达性，有一个可达就整体返回true, 否则返回false
+ * 先把源点集所有 OUT 标签里的中转点打上本轮的标记，再扫一遍目标点集的 IN 标签，
+ * 代价是两边标签长度之和，不用对笛卡尔积里的每一对都查一次PLL。
+ * 只看普通标签，所以 pll_connect_g 不开位并行路标（build_boundary_index 里检查）。
  */
-
-bool CompressedSearch::set_reachability(vector<int> source_set, vector<int> target_set)
+bool CompressedSearch::set_reachability(const vector<int> &source_set, const vector<int> &target_set, QueryScratch &scratch) const
 {
-    bool result = false;
+    if (pll_connect_g == nullptr || source_set.empty() || target_set.empty())
+        return false;
+    const size_t num_vertices = pll_connect_g->num_label_vertices();
+    auto &mark = scratch.hub_mark;
+    if (mark.size() < num_vertices)
+        return false;
+    // 轮次回绕时才真正清空一次标记
+    if (++scratch.hub_round == 0)
+    {
+        std::fill(mark.begin(), mark.end(), 0);
+        scratch.hub_round = 1;
+    }
+    const uint32_t round = scratch.hub_round;
     for (auto u : source_set)
     {
-        for (auto v : target_set)
+        if (static_cast<size_t>(u) >= num_vertices)
+            continue;
+        pll_connect_g->for_each_out_label(u, [&](int hub) { mark[hub] = round; });
+    }
+    // 标签可能是压缩的，遍历不能中途退出，每个目标点扫完再看有没有命中
+    bool found = false;
+    for (auto v : target_set)
+    {
+        if (static_cast<size_t>(v) >= num_vertices)
+            continue;
+        pll_connect_g->for_each_in_label(v, [&](int hub) { found |= mark[hub] == round; });
+        if (found)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 汇总每个分区的出口点和入口点，并在出入口图上建 PLL。
+ * 跨分区查询只需要分区内探测出入口点加一次点集到点集的判断，不再枚举分区路径。
+ */
+void CompressedSearch::build_boundary_index()
+{
+    if (this->partition_manager_.part_connect_g == nullptr)
+        this->partition_manager_.build_connections_graph();
+
+    this->pll_connect_g = make_shared<PLL>(*(this->partition_manager_.part_connect_g));
+    // 分区连接图可能很大，显式设置了线程数时标签分批并行构建
+    this->pll_connect_g->set_build_threads(boundary_build_threads_);
+    this->pll_connect_g->set_landmark_strategy(landmark_strategy_);
+    this->pll_connect_g->offline_industry();
+    // set_reachability 只对普通标签求交，不看位并行的字，分区连接图不能开位并行路标
+    assert(this->pll_connect_g->num_bit_parallel_roots() == 0);
+    if (compress_labels_)
+        this->pll_connect_g->compress_labels();
+
+    int max_partition = -1;
+    for (const auto &[partition, all_nodes] : partition_manager_.connect_nodes)
+        max_partition = std::max(max_partition, partition);
+    boundary_nodes_.assign(max_partition + 1, BoundaryNodes());
+    for (const auto &[partition, all_nodes] : partition_manager_.connect_nodes)
+    {
+        if (partition < 0)
+            continue;
+        auto &boundary = boundary_nodes_[partition];
+        for (const auto &[other, nodes] : all_nodes)
         {
-            result = pll_connect_g->reachability_query(u, v);
-            if (result)
-                return true;
+            boundary.exits.insert(boundary.exits.end(), nodes.outgoing_nodes.begin(), nodes.outgoing_nodes.end());
+            boundary.entries.insert(boundary.entries.end(), nodes.incoming_nodes.begin(), nodes.incoming_nodes.end());
         }
+        std::sort(boundary.exits.begin(), boundary.exits.end());
+        boundary.exits.erase(std::unique(boundary.exits.begin(), boundary.exits.end()), boundary.exits.end());
+        std::sort(boundary.entries.begin(), boundary.entries.end());
+        boundary.entries.erase(std::unique(boundary.entries.begin(), boundary.entries.end()), boundary.entries.end());
     }
-    return false;
-}
\ No newline at end of file
+}
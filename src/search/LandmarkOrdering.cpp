@@ -0,0 +1,287 @@
+#include "LandmarkOrdering.h"
+#include "CSR.h"
+#include "MultiSourceBFS.h"
+#include "SCCCondenser.h"
+#include "pll.h"
+#include "utils/BatchScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+namespace
+{
+    uint64_t degree_product(const Graph &g, int v)
+    {
+        return (uint64_t(g.vertices.in_degrees[v]) + 1) * (uint64_t(g.vertices.out_degrees[v]) + 1);
+    }
+
+    bool has_edges(const Graph &g, int v)
+    {
+        return g.vertices.in_degrees[v] != 0 || g.vertices.out_degrees[v] != 0;
+    }
+
+    // 有边的点按 score 降序，分数相同时按度数积降序，再按点号升序
+    std::vector<int> sort_by_score(const Graph &g, const std::vector<uint64_t> &score)
+    {
+        std::vector<int> order;
+        for (int v = 0; v < static_cast<int>(g.vertices.size()); ++v)
+        {
+            if (has_edges(g, v))
+                order.push_back(v);
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            if (score[a] != score[b])
+                return score[a] > score[b];
+            uint64_t da = degree_product(g, a), db = degree_product(g, b);
+            if (da != db)
+                return da > db;
+            return a < b;
+        });
+        return order;
+    }
+
+    // 每个点被多少个采样点正向（forward）或反向到达，各线程先记自己的计数再相加
+    std::vector<uint64_t> sampled_counts(const Graph &g, const std::vector<uint32_t> &sources, bool forward, int num_threads)
+    {
+        GraphAdjacency adjacency(g);
+        size_t n = g.vertices.size();
+        int threads = BatchScheduler::resolve_threads(num_threads, (sources.size() + 63) / 64, 1);
+        std::vector<std::vector<uint32_t>> per_thread(threads, std::vector<uint32_t>(n, 0));
+        MultiSourceBFS<GraphAdjacency>::for_each_group(adjacency, forward, sources, threads,
+                                                        [&](int thread_id, const uint32_t *, uint32_t v, uint64_t mask) {
+                                                            per_thread[thread_id][v] += __builtin_popcountll(mask);
+                                                        });
+        std::vector<uint64_t> counts(n, 0);
+        for (const auto &part : per_thread)
+        {
+            for (size_t v = 0; v < n; ++v)
+                counts[v] += part[v];
+        }
+        return counts;
+    }
+
+    std::vector<uint64_t> sampled_reach_scores(const Graph &g, size_t samples, unsigned seed, int num_threads)
+    {
+        std::vector<uint32_t> candidates;
+        for (int v = 0; v < static_cast<int>(g.vertices.size()); ++v)
+        {
+            if (has_edges(g, v))
+                candidates.push_back(v);
+        }
+        std::mt19937 rng(seed);
+        std::shuffle(candidates.begin(), candidates.end(), rng);
+        if (candidates.size() > samples)
+            candidates.resize(samples);
+        // 正向 BFS 得到能到达 v 的采样点数，反向得到 v 能到达的采样点数
+        std::vector<uint64_t> from = sampled_counts(g, candidates, true, num_threads);
+        std::vector<uint64_t> to = sampled_counts(g, candidates, false, num_threads);
+        std::vector<uint64_t> score(g.vertices.size());
+        for (size_t v = 0; v < score.size(); ++v)
+            score[v] = from[v] * to[v];
+        return score;
+    }
+
+    std::vector<uint64_t> topological_scores(const Graph &g, int num_threads)
+    {
+        size_t n = g.vertices.size();
+        std::vector<uint64_t> score(n, 0);
+        CSRGraph csr;
+        if (n == 0 || !csr.fromGraph(g, num_threads))
+            return score;
+        std::vector<uint32_t> component;
+        SCCCondenser::tarjan(csr, component);
+
+        // 在分量代表点上做 Kahn 拓扑排序，重复的边不影响最长路
+        std::vector<uint32_t> indegree(n, 0);
+        for (uint32_t u = 0; u < n; ++u)
+        {
+            for (uint32_t v : csr.outNeighbors(u))
+            {
+                if (component[u] != component[v])
+                    ++indegree[component[v]];
+            }
+        }
+        std::vector<std::vector<uint32_t>> members(n);
+        for (uint32_t u = 0; u < n; ++u)
+            members[component[u]].push_back(u);
+        std::vector<uint32_t> topo;
+        for (uint32_t c = 0; c < n; ++c)
+        {
+            if (component[c] == c && indegree[c] == 0)
+                topo.push_back(c);
+        }
+        for (size_t head = 0; head < topo.size(); ++head)
+        {
+            for (uint32_t u : members[topo[head]])
+            {
+                for (uint32_t v : csr.outNeighbors(u))
+                {
+                    uint32_t c = component[v];
+                    if (c != topo[head] && --indegree[c] == 0)
+                        topo.push_back(c);
+                }
+            }
+        }
+
+        // up 是从没有入边的分量到这里的最长路，down 是从这里到没有出边的分量的最长路
+        std::vector<uint32_t> up(n, 0), down(n, 0);
+        for (uint32_t c : topo)
+        {
+            for (uint32_t u : members[c])
+            {
+                for (uint32_t v : csr.outNeighbors(u))
+                {
+                    if (component[v] != c)
+                        up[component[v]] = std::max(up[component[v]], up[c] + 1);
+                }
+            }
+        }
+        for (auto it = topo.rbegin(); it != topo.rend(); ++it)
+        {
+            for (uint32_t u : members[*it])
+            {
+                for (uint32_t v : csr.outNeighbors(u))
+                {
+                    if (component[v] != *it)
+                        down[*it] = std::max(down[*it], down[component[v]] + 1);
+                }
+            }
+        }
+        for (uint32_t u = 0; u < n; ++u)
+            score[u] = (uint64_t(up[component[u]]) + 1) * (uint64_t(down[component[u]]) + 1);
+        return score;
+    }
+}
+
+const char *LandmarkOrdering::name(Strategy strategy)
+{
+    switch (strategy)
+    {
+    case Strategy::DEGREE_PRODUCT:
+        return "degree-product";
+    case Strategy::DEGREE_SUM:
+        return "degree-sum";
+    case Strategy::SAMPLED_REACH:
+        return "sampled-reach";
+    case Strategy::TOPOLOGICAL:
+        return "topological";
+    }
+    return "unknown";
+}
+
+bool LandmarkOrdering::parse(const std::string &name, Strategy &strategy)
+{
+    for (Strategy candidate : all())
+    {
+        if (name == LandmarkOrdering::name(candidate))
+        {
+            strategy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<LandmarkOrdering::Strategy> LandmarkOrdering::all()
+{
+    return {Strategy::DEGREE_PRODUCT, Strategy::DEGREE_SUM, Strategy::SAMPLED_REACH, Strategy::TOPOLOGICAL};
+}
+
+std::vector<int> LandmarkOrdering::compute(const Graph &g, Strategy strategy, size_t samples, unsigned seed, int num_threads)
+{
+    std::vector<uint64_t> score(g.vertices.size(), 0);
+    switch (strategy)
+    {
+    case Strategy::DEGREE_PRODUCT:
+        for (size_t v = 0; v < score.size(); ++v)
+            score[v] = degree_product(g, static_cast<int>(v));
+        break;
+    case Strategy::DEGREE_SUM:
+        for (size_t v = 0; v < score.size(); ++v)
+            score[v] = uint64_t(g.vertices.in_degrees[v]) + g.vertices.out_degrees[v];
+        break;
+    case Strategy::SAMPLED_REACH:
+        score = sampled_reach_scores(g, samples, seed, num_threads);
+        break;
+    case Strategy::TOPOLOGICAL:
+        score = topological_scores(g, num_threads);
+        break;
+    }
+    return sort_by_score(g, score);
+}
+
+std::vector<int> LandmarkOrdering::complete(const Graph &g, const std::vector<int> &order)
+{
+    std::vector<uint8_t> listed(g.vertices.size(), 0);
+    std::vector<int> result;
+    for (int v : order)
+    {
+        if (v < 0 || static_cast<size_t>(v) >= g.vertices.size() || listed[v] || !has_edges(g, v))
+            continue;
+        listed[v] = 1;
+        result.push_back(v);
+    }
+    for (int v : compute(g, Strategy::DEGREE_PRODUCT))
+    {
+        if (!listed[v])
+            result.push_back(v);
+    }
+    return result;
+}
+
+std::vector<LandmarkOrdering::Evaluation> LandmarkOrdering::evaluate(Graph &g, const std::vector<Strategy> &strategies,
+                                                                     const std::vector<std::pair<int, int>> &queries,
+                                                                     int build_threads, int bit_parallel_roots)
+{
+    using clock = std::chrono::high_resolution_clock;
+    std::vector<Evaluation> evaluations;
+    for (Strategy strategy : strategies)
+    {
+        Evaluation evaluation{strategy, 0, 0, 0, 0, 0, 0};
+        auto start = clock::now();
+        std::vector<int> order = compute(g, strategy, 256, 0, build_threads);
+        auto end = clock::now();
+        evaluation.order_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+        PLL pll(g);
+        pll.set_build_threads(build_threads);
+        pll.set_bit_parallel_roots(bit_parallel_roots);
+        pll.set_landmark_order(std::move(order));
+        start = clock::now();
+        pll.offline_industry();
+        end = clock::now();
+        evaluation.build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+        for (size_t v = 0; v < pll.IN.size(); ++v)
+            evaluation.labels += pll.IN[v].size() + pll.OUT[v].size();
+        evaluation.bytes = evaluation.labels * sizeof(int) +
+                           size_t(pll.num_bit_parallel_roots()) * g.vertices.size() * 2 * sizeof(uint64_t);
+
+        start = clock::now();
+        for (const auto &query : queries)
+            evaluation.reachable += pll.reachability_query(query.first, query.second);
+        end = clock::now();
+        if (!queries.empty())
+            evaluation.query_ns = std::chrono::duration<double, std::nano>(end - start).count() / queries.size();
+        evaluations.push_back(evaluation);
+    }
+    return evaluations;
+}
+
+std::vector<std::string> LandmarkOrdering::format_report(const std::vector<Evaluation> &evaluations)
+{
+    std::vector<std::string> lines;
+    lines.push_back("strategy  labels  bytes  order_ms  build_ms  query_ns  reachable");
+    for (const auto &evaluation : evaluations)
+    {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << name(evaluation.strategy) << "  " << evaluation.labels << "  "
+           << evaluation.bytes << "  " << evaluation.order_ms << "  " << evaluation.build_ms << "  " << evaluation.query_ns
+           << "  " << evaluation.reachable;
+        lines.push_back(ss.str());
+    }
+    return lines;
+}
@@ -0,0 +1,275 @@
+#include "PLLLabelStore.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    struct LabelFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_bytes;
+        uint32_t num_vertices;
+        uint32_t bp_groups;
+        uint64_t in_size;
+        uint64_t out_size;
+        uint64_t in_offsets_offset;
+        uint64_t out_offsets_offset;
+        uint64_t in_bytes_offset;
+        uint64_t out_bytes_offset;
+        uint64_t order_offset;
+        uint64_t bp_in_offset;
+        uint64_t bp_out_offset;
+    };
+    static_assert(sizeof(LabelFileHeader) == 96, "PLL 标签文件头应为 96 字节");
+
+    const char LABEL_MAGIC[8] = {'R', 'C', 'P', 'L', 'L', 0, 0, 0};
+    const uint32_t LABEL_VERSION = 1;
+
+    uint64_t align_up(uint64_t offset)
+    {
+        return (offset + 63) & ~uint64_t(63);
+    }
+
+    // 按点数、组数和两段字节流的长度计算各段的偏移，返回文件总长度
+    uint64_t layout_sections(LabelFileHeader &header)
+    {
+        uint64_t n = header.num_vertices;
+        uint64_t offsets = n == 0 ? 0 : (n + 1) * sizeof(uint64_t);
+        uint64_t words = n * header.bp_groups * sizeof(uint64_t);
+        header.in_offsets_offset = align_up(sizeof(LabelFileHeader));
+        header.out_offsets_offset = align_up(header.in_offsets_offset + offsets);
+        header.in_bytes_offset = align_up(header.out_offsets_offset + offsets);
+        header.out_bytes_offset = align_up(header.in_bytes_offset + header.in_size);
+        header.order_offset = align_up(header.out_bytes_offset + header.out_size);
+        header.bp_in_offset = align_up(header.order_offset + n * sizeof(int32_t));
+        header.bp_out_offset = align_up(header.bp_in_offset + words);
+        return header.bp_out_offset + words;
+    }
+
+    // 一个方向的标签按差值变长编码，offsets[v] 是点 v 的字节流起点
+    void encode(const std::vector<std::vector<int>> &labels, size_t n, std::vector<uint64_t> &offsets,
+                std::vector<uint8_t> &bytes)
+    {
+        offsets.assign(n + 1, 0);
+        bytes.clear();
+        for (size_t v = 0; v < n; ++v)
+        {
+            uint32_t previous = 0;
+            if (v < labels.size())
+            {
+                for (int rank : labels[v])
+                {
+                    uint32_t delta = static_cast<uint32_t>(rank) - previous;
+                    previous = static_cast<uint32_t>(rank);
+                    while (delta >= 0x80)
+                    {
+                        bytes.push_back(static_cast<uint8_t>(delta | 0x80));
+                        delta >>= 7;
+                    }
+                    bytes.push_back(static_cast<uint8_t>(delta));
+                }
+            }
+            offsets[v + 1] = bytes.size();
+        }
+        bytes.shrink_to_fit();
+    }
+
+    // 偏移从 0 开始、不减、不超过字节流长度且最后一个正好等于它，每个非空行的最后一个字节没有续位，解码时才不会越界
+    bool valid_offsets(const uint64_t *offsets, const uint8_t *bytes, uint32_t n, uint64_t size)
+    {
+        if (offsets[0] != 0 || offsets[n] != size)
+            return false;
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            if (offsets[v + 1] < offsets[v] || offsets[v + 1] > size)
+                return false;
+            if (offsets[v + 1] > offsets[v] && (bytes[offsets[v + 1] - 1] & 0x80))
+                return false;
+        }
+        return true;
+    }
+}
+
+void PLLLabelStore::build(const std::vector<std::vector<int>> &in, const std::vector<std::vector<int>> &out,
+                          const std::vector<int> &order, int bp_groups, const std::vector<uint64_t> &bp_in,
+                          const std::vector<uint64_t> &bp_out)
+{
+    clear();
+    size_t n = std::max(in.size(), out.size());
+    if (n == 0)
+        return;
+    encode(in, n, owned_.in_offsets, owned_.in_bytes);
+    encode(out, n, owned_.out_offsets, owned_.out_bytes);
+    owned_.order.assign(order.begin(), order.end());
+    owned_.order.resize(n, -1);
+    if (bp_groups > 0)
+    {
+        owned_.bp_in = bp_in;
+        owned_.bp_out = bp_out;
+    }
+    num_vertices_ = static_cast<uint32_t>(n);
+    bp_groups_ = bp_groups > 0 ? bp_groups : 0;
+    in_size_ = owned_.in_bytes.size();
+    out_size_ = owned_.out_bytes.size();
+    in_offsets_ = owned_.in_offsets.data();
+    out_offsets_ = owned_.out_offsets.data();
+    in_bytes_ = owned_.in_bytes.data();
+    out_bytes_ = owned_.out_bytes.data();
+    order_ = owned_.order.data();
+    bp_in_ = owned_.bp_in.data();
+    bp_out_ = owned_.bp_out.data();
+}
+
+void PLLLabelStore::clear()
+{
+    if (mapped_addr_)
+        munmap(mapped_addr_, mapped_bytes_);
+    mapped_addr_ = nullptr;
+    mapped_bytes_ = 0;
+    owned_ = Owned();
+    num_vertices_ = 0;
+    bp_groups_ = 0;
+    in_size_ = out_size_ = 0;
+    in_offsets_ = out_offsets_ = nullptr;
+    in_bytes_ = out_bytes_ = nullptr;
+    order_ = nullptr;
+    bp_in_ = bp_out_ = nullptr;
+}
+
+void PLLLabelStore::swap(PLLLabelStore &other)
+{
+    std::swap(num_vertices_, other.num_vertices_);
+    std::swap(bp_groups_, other.bp_groups_);
+    std::swap(in_size_, other.in_size_);
+    std::swap(out_size_, other.out_size_);
+    std::swap(in_offsets_, other.in_offsets_);
+    std::swap(out_offsets_, other.out_offsets_);
+    std::swap(in_bytes_, other.in_bytes_);
+    std::swap(out_bytes_, other.out_bytes_);
+    std::swap(order_, other.order_);
+    std::swap(bp_in_, other.bp_in_);
+    std::swap(bp_out_, other.bp_out_);
+    std::swap(owned_, other.owned_);
+    std::swap(mapped_addr_, other.mapped_addr_);
+    std::swap(mapped_bytes_, other.mapped_bytes_);
+}
+
+bool PLLLabelStore::save(const std::string &filename) const
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open())
+    {
+        std::cerr << "无法写入文件: " << filename << std::endl;
+        return false;
+    }
+    LabelFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, LABEL_MAGIC, sizeof(LABEL_MAGIC));
+    header.version = LABEL_VERSION;
+    header.header_bytes = sizeof(LabelFileHeader);
+    header.num_vertices = num_vertices_;
+    header.bp_groups = static_cast<uint32_t>(bp_groups_);
+    header.in_size = in_size_;
+    header.out_size = out_size_;
+    layout_sections(header);
+
+    uint64_t n = num_vertices_;
+    uint64_t offsets = n == 0 ? 0 : (n + 1) * sizeof(uint64_t);
+    uint64_t words = n * bp_groups_ * sizeof(uint64_t);
+    uint64_t written = 0;
+    auto write_at = [&](uint64_t offset, const void *data, uint64_t bytes) {
+        // 段之间补 0 对齐
+        static const char zeros[64] = {0};
+        while (written < offset)
+        {
+            uint64_t pad = std::min<uint64_t>(offset - written, sizeof(zeros));
+            out.write(zeros, pad);
+            written += pad;
+        }
+        if (bytes > 0)
+            out.write(static_cast<const char *>(data), bytes);
+        written += bytes;
+    };
+    write_at(0, &header, sizeof(header));
+    write_at(header.in_offsets_offset, in_offsets_, offsets);
+    write_at(header.out_offsets_offset, out_offsets_, offsets);
+    write_at(header.in_bytes_offset, in_bytes_, in_size_);
+    write_at(header.out_bytes_offset, out_bytes_, out_size_);
+    write_at(header.order_offset, order_, n * sizeof(int32_t));
+    write_at(header.bp_in_offset, bp_in_, words);
+    write_at(header.bp_out_offset, bp_out_, words);
+    return static_cast<bool>(out);
+}
+
+bool PLLLabelStore::load(const std::string &filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "无法打开文件: " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(LabelFileHeader))
+    {
+        close(fd);
+        std::cerr << "不是 PLL 标签文件: " << filename << std::endl;
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    void *addr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        std::cerr << "mmap 失败: " << filename << std::endl;
+        return false;
+    }
+
+    // 校验文件头和各段的位置
+    LabelFileHeader header;
+    std::memcpy(&header, addr, sizeof(header));
+    LabelFileHeader expected = header;
+    uint64_t expected_bytes = layout_sections(expected);
+    const char *base = static_cast<const char *>(addr);
+    const uint64_t *in_offsets = reinterpret_cast<const uint64_t *>(base + header.in_offsets_offset);
+    const uint64_t *out_offsets = reinterpret_cast<const uint64_t *>(base + header.out_offsets_offset);
+    bool valid = std::memcmp(header.magic, LABEL_MAGIC, sizeof(LABEL_MAGIC)) == 0 && header.version == LABEL_VERSION &&
+                 header.header_bytes == sizeof(LabelFileHeader) && bytes >= expected_bytes &&
+                 std::memcmp(&header, &expected, sizeof(header)) == 0;
+    // 逐行检查偏移和每行的结尾，否则解码会越界
+    if (valid && header.num_vertices > 0)
+        valid = valid_offsets(in_offsets, reinterpret_cast<const uint8_t *>(base + header.in_bytes_offset),
+                              header.num_vertices, header.in_size) &&
+                valid_offsets(out_offsets, reinterpret_cast<const uint8_t *>(base + header.out_bytes_offset),
+                              header.num_vertices, header.out_size);
+    if (!valid)
+    {
+        munmap(addr, bytes);
+        std::cerr << "不是 PLL 标签文件或版本不匹配: " << filename << std::endl;
+        return false;
+    }
+
+    clear();
+    mapped_addr_ = addr;
+    mapped_bytes_ = bytes;
+    num_vertices_ = header.num_vertices;
+    bp_groups_ = static_cast<int>(header.bp_groups);
+    in_size_ = header.in_size;
+    out_size_ = header.out_size;
+    in_offsets_ = in_offsets;
+    out_offsets_ = out_offsets;
+    in_bytes_ = reinterpret_cast<const uint8_t *>(base + header.in_bytes_offset);
+    out_bytes_ = reinterpret_cast<const uint8_t *>(base + header.out_bytes_offset);
+    order_ = reinterpret_cast<const int32_t *>(base + header.order_offset);
+    bp_in_ = reinterpret_cast<const uint64_t *>(base + header.bp_in_offset);
+    bp_out_ = reinterpret_cast<const uint64_t *>(base + header.bp_out_offset);
+    return true;
+}
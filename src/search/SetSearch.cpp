@@ -1,6 +1,7 @@
 #include "SetSearch.h"
 #include "pll.h"
 #include "TreeCover.h"
+#include "MultiSourceBFS.h"
 #define DEBUG
 struct ReachRecord
 {
@@ -100,47 +101,25 @@ void SetSearch::build_key_points(int num)
     // 确保pop出来的是按照度数从大到小的顺序
     reverse(key_points.begin(), key_points.end());
     this->key_points = key_points;
-    // 从每个关键点出发做正向和反向bfs
+    // 从所有关键点出发做正向和反向的多源bfs，关键点按 64 个（支持 AVX2 时 256 个）一组一起走
     // 如果正向bfs遍历到一个节点i，就把关键点加入到节点的in集合中，也就是in_key_points[i]中
     // 对于反向bfs也是一样， 遍历到一个节点i，就把关键点加入到节点的out集合中，也就是out_key_points[i]中
-    while (!key_points.empty())
+    // 关键点自己不加入自己的集合。各组写的是同一批集合，这里只用一个线程
+    std::vector<uint32_t> sources(key_points.begin(), key_points.end());
+    GraphAdjacency adjacency(*this->g);
+    for (bool forward : {true, false})
     {
-        int key_point = key_points.back();
-        key_points.pop_back();
-
-        // 正向bfs
-        queue<int> q;
-        q.push(key_point);
-        vector<int> visited(this->g->vertices.size(), 0);
-        while (!q.empty())
-        {
-            int cur = q.front();
-            q.pop();
-            visited[cur] = 1;
-            for (auto i : this->g->vertices[cur].LOUT)
-            {
-                if (visited[i])
-                    continue;
-                in_key_points[i].insert(key_point);
-                q.push(i);
-            }
-        }
-        // 反向bfs
-        q.push(key_point);
-        visited = vector<int>(this->g->vertices.size(), 0);
-        while (!q.empty())
-        {
-            int cur = q.front();
-            q.pop();
-            visited[cur] = 1;
-            for (auto i : this->g->vertices[cur].LIN)
+        vector<set<int>> &key_point_sets = forward ? in_key_points : out_key_points;
+        MultiSourceBFS<GraphAdjacency>::for_each_group(adjacency, forward, sources, 1,
+            [&](int, const uint32_t *group, uint32_t v, uint64_t mask)
             {
-                if (visited[i])
-                    continue;
-                out_key_points[i].insert(key_point);
-                q.push(i);
-            }
-        }
+                for (; mask; mask &= mask - 1)
+                {
+                    int key_point = group[__builtin_ctzll(mask)];
+                    if (key_point != static_cast<int>(v))
+                        key_point_sets[v].insert(key_point);
+                }
+            });
     }
 }
 
@@ -562,6 +541,11 @@ bool SetSearch::reachability_query(int source, int target)
     return this->pll->query(source, target);
 }
 
+void SetSearch::reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads)
+{
+    this->pll->reachability_query_batch(queries, count, out, num_threads);
+}
+
 std::vector<std::pair<std::string, std::string>> SetSearch::getIndexSizes() const
 {
     return std::vector<std::pair<std::string, std::string>>();
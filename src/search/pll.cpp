@@ -5,6 +5,9 @@
 #include <vector>
 #include <iostream>
 #include "Algorithm.h"
+#include "utils/BatchScheduler.h"
+#include "utils/SetIntersection.h"
+#include "MultiSourceBFS.h"
 
 // 构造函数，接收图结构
 PLL::PLL(Graph &graph) : g(graph)
@@ -31,34 +34,32 @@ bool PLL::reachability_query(int source, int target)
     // return queryinArray(source, target);
 }
 
+// 批量查询，query 只读标签，多线程直接并发调用
+void PLL::reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads)
+{
+    auto worker = [&](int, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            out[i] = query(queries[i].first, queries[i].second) ? 1 : 0;
+    };
+    BatchScheduler::run(count, BatchScheduler::resolve_threads(num_threads, count), worker);
+}
+
 bool PLL::queryinArray(int u, int v)
 {
     uint32_t num_node = g.vertices.size();
-    if (u > num_node || v > num_node)
+    if (u < 0 || v < 0 || u >= num_node || v >= num_node)
         return false;
     if (u == v)
         return true;
-    // 检查 IN 和 OUT 集合
-    for (int i = in_pointers[v]; i < in_pointers[v + 1]; ++i)
-    {
-        if (in_sets[i] == u)
-            return true;
-    }
-    for (int i = out_pointers[u]; i < out_pointers[u + 1]; ++i)
-    {
-        if (out_sets[i] == v)
-            return true;
-    }
-    for (int i = out_pointers[u]; i < out_pointers[u + 1]; ++i)
-    {
-        for (int j = in_pointers[v]; j < in_pointers[v + 1]; ++j)
-        {
-            if (out_sets[i] == in_sets[j])
-                return true;
-        }
-    }
-
-    return false; // 无交集，不可达
+    // 没调用过 convertToArray，或者标签已经压缩、秩不再保存时，数组不可用
+    if (in_pointers == nullptr || rank_.empty())
+        return false;
+    if (bp_groups_ > 0 && bitParallelQuery(u, v))
+        return true;
+    // convertToArray 拷过来的标签是有序的秩，add_self 已经把每个点自己的秩放进了两边，直接求交
+    return SetIntersection::intersect(out_sets + out_pointers[u], out_pointers[u + 1] - out_pointers[u],
+                                      in_sets + in_pointers[v], in_pointers[v + 1] - in_pointers[v]);
 }
 
 // 构建邻接表和逆邻接表，遍历的时候用
@@ -84,34 +85,31 @@ void PLL::buildInOut()
     OUT.resize(g.vertices.size());
 }
 
-// 计算节点度，并按度降序排序节点
-std::vector<int> PLL::orderByDegree()
+std::vector<int> PLL::orderLandmarks()
 {
-    // 初始化节点顺序数组
-    std::vector<int> nodes;
-    for (int i = 0; i < g.vertices.size(); ++i)
+    if (!landmark_order_.empty())
+        return LandmarkOrdering::complete(g, landmark_order_);
+    return LandmarkOrdering::compute(g, landmark_strategy_, 256, 0, build_threads_);
+}
+
+void PLL::assignRanks(const std::vector<int> &nodes)
+{
+    rank_.assign(g.vertices.size(), -1);
+    order_.clear();
+    order_.reserve(g.vertices.size());
+    for (int node : nodes)
+    {
+        rank_[node] = static_cast<int>(order_.size());
+        order_.push_back(node);
+    }
+    for (int v = 0; v < static_cast<int>(rank_.size()); ++v)
     {
-        if (g.vertices[i].in_degree == 0 && g.vertices[i].out_degree == 0)
+        if (rank_[v] < 0)
         {
-            continue; // 跳过没有出度和入度的节点
+            rank_[v] = static_cast<int>(order_.size());
+            order_.push_back(v);
         }
-        nodes.push_back(i);
     }
-
-    // 按照度的降序排序节点，度计算为 (in + 1) * (out + 1)
-    std::sort(nodes.begin(), nodes.end(), [&](int a, int b)
-              {
-        int inDegreeA = g.vertices[a].LIN.empty() ? 0 : g.vertices[a].LIN.size();
-        int outDegreeA = g.vertices[a].LOUT.empty() ? 0 : g.vertices[a].LOUT.size();
-        int degreeA = (inDegreeA + 1) * (outDegreeA + 1);
-
-        int inDegreeB = g.vertices[b].LIN.empty() ? 0 : g.vertices[b].LIN.size();
-        int outDegreeB = g.vertices[b].LOUT.empty() ? 0 : g.vertices[b].LOUT.size();
-        int degreeB = (inDegreeB + 1) * (outDegreeB + 1);
-
-        return degreeA > degreeB; });
-
-    return nodes;
 }
 
 bool PLL::convertToArray()
@@ -174,6 +172,8 @@ void PLL::bfsPruned(int start)
     std::queue<int> q_forward;
     q_forward.push(start);
     visited_forward[start] = true;  // 标记起点已访问
+    // start 的秩比已有的标签都大，追加到末尾仍然有序；起点自己也加上，后面的剪枝能用到
+    const int start_rank = rank_[start];
     // 第一轮 BFS：从 start 出发，构建 IN 集合
     while (!q_forward.empty())
     {
@@ -181,12 +181,9 @@ void PLL::bfsPruned(int start)
         q_forward.pop();
 
         // 如果已有标签证明 start 到 current 可达，则剪枝
-        if (HopQuery(start, current))
+        if (current != start && HopQuery(start, current))
             continue;
-        // 除了起点外，将 start 加入 current 的 IN 标签集合中
-        if (current != start)
-            insertSorted(IN[current], start);
-            // IN[current].insert(start);
+        IN[current].push_back(start_rank);
 
         // 遍历 current 的后继节点
         for (auto neighbor : adjList[current])
@@ -212,12 +209,9 @@ void PLL::bfsPruned(int start)
         q_backward.pop();
 
         // 如果已有标签证明 current 到 start 可达，则剪枝
-        if (HopQuery(current, start))
+        if (current != start && HopQuery(current, start))
             continue;
-        // 除了起点外，将 start 加入 current 的 OUT 标签集合中
-        if (current != start)
-            insertSorted(OUT[current], start);
-            // OUT[current].insert(start);
+        OUT[current].push_back(start_rank);
 
         // 遍历 current 的前驱节点（反向邻接表）
         for (auto neighbor : reverseAdjList[current])
@@ -295,27 +289,9 @@ bool PLL::HopQuery(int u, int v)
 {
     if (u >= g.vertices.size() || v >= g.vertices.size())
         return false;
-    const auto &LOUT_u = OUT[u]; // vector<int>
-    const auto &LIN_v = IN[v];   // vector<int>
-
-    auto it1 = LOUT_u.begin();
-    auto it2 = LIN_v.begin();
-    while (it1 != LOUT_u.end() && it2 != LIN_v.end())
-    {
-        if (*it1 == *it2)
-        {
-            return true;
-        }
-        else if (*it1 < *it2)
-        {
-            ++it1;
-        }
-        else
-        {
-            ++it2;
-        }
-    }
-    return false;
+    if (bp_groups_ > 0 && bitParallelQuery(u, v))
+        return true;
+    return SetIntersection::intersect(OUT[u], IN[v]);
 }
 
 
@@ -333,19 +309,28 @@ bool PLL::HopQuery(int u, int v)
 
 void PLL::add_self()
 {
-    for(int i = 0; i < g.vertices.size(); i++){
-        // IN[i].insert(i);
-        // OUT[i].insert(i);
-        insertSorted(IN[i], i);
-        insertSorted(OUT[i], i);
-
+    if (rank_.size() != g.vertices.size())
+        assignRanks(std::vector<int>());
+    for (int i = 0; i < g.vertices.size(); i++)
+    {
+        // 路标点的标签里已经有自己；其余点的秩比所有路标点都大，直接追加
+        if (IN[i].empty() || IN[i].back() < rank_[i])
+            IN[i].push_back(rank_[i]);
+        if (OUT[i].empty() || OUT[i].back() < rank_[i])
+            OUT[i].push_back(rank_[i]);
     }
 }
 
 void PLL::buildPLLLabels()
 {
-    std::vector<int> nodes = orderByDegree();
-    int i = 0;
+    if (build_threads_ != 1)
+    {
+        buildPLLLabelsParallel(build_threads_);
+        return;
+    }
+    resetBuildLabels();
+    std::vector<int> nodes = buildBitParallelLabels();
+    assignRanks(nodes);
     int count = 0;
     for (int node : nodes)
     {
@@ -363,6 +348,175 @@ void PLL::buildPLLLabels()
 }
 
 
+std::vector<int> PLL::buildBitParallelLabels()
+{
+    std::vector<int> nodes = orderLandmarks();
+    bp_groups_ = 0;
+    bp_in_.clear();
+    bp_out_.clear();
+    if (bit_parallel_roots_ == 0 || nodes.empty())
+        return nodes;
+
+    // 按度数顺序挑根，根占第 0 位，再补上最多 63 个没用过的出邻居和入邻居
+    std::vector<uint8_t> used(g.vertices.size(), 0);
+    std::vector<std::vector<uint32_t>> groups;
+    for (int root : nodes)
+    {
+        if (groups.size() >= static_cast<size_t>(bit_parallel_roots_))
+            break;
+        if (used[root])
+            continue;
+        std::vector<uint32_t> members{static_cast<uint32_t>(root)};
+        used[root] = 1;
+        for (const auto *neighbors : {&adjList[root], &reverseAdjList[root]})
+        {
+            for (int v : *neighbors)
+            {
+                if (members.size() == MultiSourceBFS<GraphAdjacency>::WIDTH)
+                    break;
+                if (used[v])
+                    continue;
+                used[v] = 1;
+                members.push_back(v);
+            }
+        }
+        groups.push_back(std::move(members));
+    }
+
+    // 每组正反各一次多源 BFS，第 k 组只写每个点的第 k 个字
+    bp_groups_ = static_cast<int>(groups.size());
+    bp_in_.assign(g.vertices.size() * bp_groups_, 0);
+    bp_out_.assign(g.vertices.size() * bp_groups_, 0);
+    GraphAdjacency adjacency(g);
+    int num_threads = BatchScheduler::resolve_threads(build_threads_, groups.size() * 2, 1);
+    // 每个线程正反各一个 BFS 对象，按需建立，组之间复用
+    std::vector<std::unique_ptr<MultiSourceBFS<GraphAdjacency>>> engines(num_threads * 2);
+    BatchScheduler::run_dynamic(groups.size() * 2, num_threads, [&](int thread_id, size_t task)
+    {
+        size_t k = task / 2;
+        bool forward = task % 2 == 0;
+        std::vector<uint64_t> &words = forward ? bp_in_ : bp_out_;
+        auto &engine = engines[thread_id * 2 + (forward ? 0 : 1)];
+        if (!engine)
+            engine.reset(new MultiSourceBFS<GraphAdjacency>(adjacency, forward));
+        engine->run(groups[k].data(), groups[k].size(), [&](uint32_t v, uint64_t mask)
+        {
+            words[static_cast<size_t>(v) * bp_groups_ + k] |= mask;
+        });
+    });
+
+    // 组里的点已经被位并行覆盖，不再做普通的剪枝 BFS
+    nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](int u) { return used[u] != 0; }), nodes.end());
+    return nodes;
+}
+
+namespace
+{
+    // 把一批新标签 (点, 路标点的秩) 追加进 labels。这一批的秩都比之前各批大，
+    // 按 (点, 秩) 排好序后逐个点追加，每个点的标签仍然升序
+    void append_labels(std::vector<std::vector<int>> &labels, std::vector<std::pair<uint32_t, int>> &additions, int num_threads)
+    {
+        std::sort(additions.begin(), additions.end());
+        std::vector<size_t> runs; // 每个点的新标签在 additions 里的起始位置
+        for (size_t i = 0; i < additions.size(); ++i)
+        {
+            if (i == 0 || additions[i].first != additions[i - 1].first)
+                runs.push_back(i);
+        }
+        runs.push_back(additions.size());
+        size_t num_runs = runs.size() - 1;
+        // 不同的点互不相干，按点并行
+        BatchScheduler::run(num_runs, BatchScheduler::resolve_threads(num_threads, num_runs), [&](int, size_t begin, size_t end)
+        {
+            for (size_t r = begin; r < end; ++r)
+            {
+                std::vector<int> &label = labels[additions[runs[r]].first];
+                for (size_t i = runs[r]; i < runs[r + 1]; ++i)
+                    label.push_back(additions[i].second);
+            }
+        });
+    }
+}
+
+void PLL::buildPLLLabelsParallel(int num_threads)
+{
+    resetBuildLabels();
+    std::vector<int> nodes = buildBitParallelLabels();
+    assignRanks(nodes);
+    num_threads = BatchScheduler::resolve_threads(num_threads, nodes.size(), 1);
+    std::vector<SearchContext> contexts(num_threads);
+    // 一批里每个路标点的新标签
+    std::vector<std::vector<uint32_t>> in_vertices, out_vertices;
+    std::vector<std::pair<uint32_t, int>> in_additions, out_additions;
+
+    size_t batch = 1;
+    for (size_t first = 0; first < nodes.size(); first += batch, batch = std::min(batch * 2, MAX_BATCH))
+    {
+        size_t count = std::min(batch, nodes.size() - first);
+        in_vertices.assign(count, std::vector<uint32_t>());
+        out_vertices.assign(count, std::vector<uint32_t>());
+        // 这一批只读 IN/OUT，每个路标点的结果写到自己的位置
+        BatchScheduler::run_dynamic(count, num_threads, [&](int thread_id, size_t i)
+        {
+            bfsPrunedCollect(nodes[first + i], contexts[thread_id], in_vertices[i], out_vertices[i]);
+        });
+
+        in_additions.clear();
+        out_additions.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            int landmark_rank = static_cast<int>(first + i);
+            for (uint32_t v : in_vertices[i])
+                in_additions.emplace_back(v, landmark_rank);
+            for (uint32_t v : out_vertices[i])
+                out_additions.emplace_back(v, landmark_rank);
+        }
+        append_labels(IN, in_additions, num_threads);
+        append_labels(OUT, out_additions, num_threads);
+    }
+
+    simplifyInOutSets();
+}
+
+void PLL::bfsPrunedCollect(int start, SearchContext &context, std::vector<uint32_t> &in_vertices,
+                           std::vector<uint32_t> &out_vertices)
+{
+    const int FORWARD = SearchContext::FORWARD, BACKWARD = SearchContext::BACKWARD;
+    context.reset(g.vertices.size());
+    // 第一轮 BFS：从 start 出发，收集要加 IN 标签的点
+    context.visit(FORWARD, start);
+    context.push(FORWARD, start);
+    while (!context.queue_empty(FORWARD))
+    {
+        int current = context.pop(FORWARD);
+        if (current != start && HopQuery(start, current))
+            continue;
+        in_vertices.push_back(current);
+        for (auto neighbor : adjList[current])
+        {
+            if (context.try_visit(FORWARD, neighbor))
+                context.push(FORWARD, neighbor);
+        }
+    }
+
+    // 第二轮 BFS：沿逆邻接表，收集要加 OUT 标签的点
+    context.visit(BACKWARD, start);
+    context.push(BACKWARD, start);
+    while (!context.queue_empty(BACKWARD))
+    {
+        int current = context.pop(BACKWARD);
+        if (current != start && HopQuery(current, start))
+            continue;
+        out_vertices.push_back(current);
+        for (auto neighbor : reverseAdjList[current])
+        {
+            if (context.try_visit(BACKWARD, neighbor))
+                context.push(BACKWARD, neighbor);
+        }
+    }
+}
+
+
 // 可达性查询，外部查询
 bool PLL::query(int u, int v)
 {
@@ -373,19 +527,74 @@ bool PLL::query(int u, int v)
         return false;
     if (u == v)
         return true;
+    // 压缩过的标签边解码边求交，位并行的字也在里面
+    if (labels_compressed())
+        return labels_.query(u, v);
+    // 先看位并行的几个字
+    if (bp_groups_ > 0 && bitParallelQuery(u, v))
+        return true;
+
 
+    // OUT 和 IN 都按秩升序，直接做有序集合求交
+    return SetIntersection::intersect(OUT[u], IN[v]); // 无交集则不可达
+}
+
+void PLL::compress_labels()
+{
+    labels_.build(IN, OUT, order_, bp_groups_, bp_in_, bp_out_);
+    releaseBuildLabels();
+}
 
-    for (auto out_u : OUT[u])
+void PLL::releaseBuildLabels()
+{
+    // swap 掉才会真正释放
+    std::vector<std::vector<int>>().swap(IN);
+    std::vector<std::vector<int>>().swap(OUT);
+    std::vector<std::vector<int>>().swap(adjList);
+    std::vector<std::vector<int>>().swap(reverseAdjList);
+    std::vector<uint64_t>().swap(bp_in_);
+    std::vector<uint64_t>().swap(bp_out_);
+    std::vector<int>().swap(rank_);
+    std::vector<int>().swap(order_);
+}
+
+void PLL::resetBuildLabels()
+{
+    labels_.clear();
+    // offline_industry 建完会清掉邻接表，compress_labels 和 load_labels 也会释放
+    if (adjList.size() != g.vertices.size())
     {
-        for (auto in_v : IN[v])
-        {
-            if (out_u == in_v)
-                return true;
-        }
+        adjList.clear();
+        reverseAdjList.clear();
+        buildAdjList();
     }
+    IN.assign(g.vertices.size(), std::vector<int>());
+    OUT.assign(g.vertices.size(), std::vector<int>());
+}
 
+bool PLL::save_labels(const std::string &filename) const
+{
+    if (labels_compressed())
+        return labels_.save(filename);
+    PLLLabelStore store;
+    store.build(IN, OUT, order_, bp_groups_, bp_in_, bp_out_);
+    return store.save(filename);
+}
 
-    return false; // 无交集，不可达
+bool PLL::load_labels(const std::string &filename)
+{
+    PLLLabelStore store;
+    if (!store.load(filename))
+        return false;
+    if (store.num_vertices() != g.vertices.size())
+    {
+        std::cerr << "标签文件的点数 " << store.num_vertices() << " 和图的点数 " << g.vertices.size() << " 不一致" << std::endl;
+        return false;
+    }
+    releaseBuildLabels();
+    labels_.swap(store);
+    bp_groups_ = labels_.bp_groups();
+    return true;
 }
 
 // 不剪枝的 BFS
@@ -520,15 +729,3 @@ PLL::~PLL()
     // std::cout << "PLL destructor completed." << std::endl;
 }
 
-
-
-// 有序插入：
-void PLL::insertSorted(std::vector<int>& labelVec, int val)
-{
-    // 利用二分查找找到应插入的位置
-    auto it = std::lower_bound(labelVec.begin(), labelVec.end(), val);
-    // 如果不存在该元素，则插入
-    if (it == labelVec.end() || *it != val) {
-        labelVec.insert(it, val);
-    }
-}
@@ -1,225 +1,695 @@
 //CSR.cpp
 
 #include "CSR.h"
+#include "utils/BatchScheduler.h"
+#include "utils/TextParser.h"
+#include <atomic>
+#include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // 二进制 CSR 文件头，格式说明见 CSR.h
+    struct CSRFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_bytes;
+        uint32_t max_node_id;
+        uint32_t num_nodes;
+        uint32_t num_edges;
+        uint32_t reserved;
+        uint64_t out_row_offset;
+        uint64_t in_row_offset;
+        uint64_t out_col_offset;
+        uint64_t in_col_offset;
+        uint64_t partitions_offset;
+    };
+    const char CSR_MAGIC[8] = {'R', 'C', 'C', 'S', 'R', 0, 0, 0};
+    const uint32_t CSR_VERSION = 1;
+
+    uint64_t align_up(uint64_t offset)
+    {
+        return (offset + 63) & ~uint64_t(63);
+    }
 
-// 创建一个空的 CSRGraph，指定顶点数量
-bool CSRGraph::createEmptyCSR(uint32_t num_vertices) {
-    // 设置最大节点 ID
-    max_node_id = num_vertices > 0 ? num_vertices - 1 : 0;
-    num_nodes = num_vertices;
-    num_edges = 0;
+    // 按 max_node_id 和 num_edges 计算各段的偏移，返回文件总长度
+    uint64_t layout_sections(CSRFileHeader &header)
+    {
+        uint64_t rows = uint64_t(header.max_node_id) + 2;
+        header.out_row_offset = align_up(sizeof(CSRFileHeader));
+        header.in_row_offset = align_up(header.out_row_offset + rows * sizeof(uint32_t));
+        header.out_col_offset = align_up(header.in_row_offset + rows * sizeof(uint32_t));
+        header.in_col_offset = align_up(header.out_col_offset + uint64_t(header.num_edges) * sizeof(uint32_t));
+        header.partitions_offset = align_up(header.in_col_offset + uint64_t(header.num_edges) * sizeof(uint32_t));
+        return header.partitions_offset + (rows - 1) * sizeof(int16_t);
+    }
 
-    // 分配行指针数组，初始化为0
-    out_row_pointers = new uint32_t[max_node_id + 2];
-    in_row_pointers = new uint32_t[max_node_id + 2];
-    std::memset(out_row_pointers, 0, (max_node_id + 2) * sizeof(uint32_t));
-    std::memset(in_row_pointers, 0, (max_node_id + 2) * sizeof(uint32_t));
+    // 行指针从 0 开始、不减、最后一个等于边数，列号不超过 max_node_id，按行访问和搜索才不会越界
+    bool valid_rows(const uint32_t* row, const uint32_t* column, uint32_t max_node_id, uint32_t num_edges)
+    {
+        uint64_t rows = uint64_t(max_node_id) + 1;
+        if (row[0] != 0 || row[rows] != num_edges)
+            return false;
+        for (uint64_t u = 0; u < rows; ++u) {
+            if (row[u + 1] < row[u] || row[u + 1] > num_edges)
+                return false;
+        }
+        for (uint32_t i = 0; i < num_edges; ++i) {
+            if (column[i] > max_node_id)
+                return false;
+        }
+        return true;
+    }
 
-    // 分配分区数组，初始化为-1
-    partitions = new int16_t[max_node_id + 1];
-    for (uint32_t i = 0; i <= max_node_id; ++i) {
-        partitions[i] = -1;
+    // 动态模式下一个方向（出边或入边）的数组，row 有 rows + 1 项，row[rows] 是 column 的长度
+    struct GappedRows
+    {
+        uint32_t*& column;
+        uint32_t* row;
+        uint32_t* degree;
+        uint32_t rows;
+    };
+
+    // PMA 窗口密度上限，单行为 1，整个数组为 0.75，中间按窗口层数线性变化
+    const double LEAF_DENSITY = 1.0;
+    const double ROOT_DENSITY = 0.75;
+
+    /**
+     * @brief 把 [first, last) 这些行重新排进 target 的 [begin, end)，空隙按度数的比例分配，
+     * extra_node 这一行额外多留一个位置（不在范围内时不留）。会改写 row[first..last)，row[last] 由调用方保证等于 end。
+     */
+    void spread_rows(GappedRows& side, uint32_t first, uint32_t last, uint32_t extra_node,
+                     uint32_t* target, uint64_t begin, uint64_t end)
+    {
+        std::vector<uint32_t> packed;
+        for (uint32_t i = first; i < last; ++i)
+            packed.insert(packed.end(), side.column + side.row[i], side.column + side.row[i] + side.degree[i]);
+        bool has_extra = extra_node >= first && extra_node < last;
+        uint64_t used = packed.size() + has_extra;
+        uint64_t free = end - begin - used;
+        // 没有边的行不分空隙，插入时再从相邻的行借；整段都没有边时平均分
+        bool by_degree = used > 0;
+        uint64_t total_weight = by_degree ? used : last - first;
+        uint64_t used_prefix = 0, weight_prefix = 0;
+        const uint32_t* source = packed.data();
+        for (uint32_t i = first; i < last; ++i) {
+            uint64_t start = begin + used_prefix + free * weight_prefix / total_weight;
+            side.row[i] = static_cast<uint32_t>(start);
+            std::memcpy(target + start, source, side.degree[i] * sizeof(uint32_t));
+            source += side.degree[i];
+            used_prefix += side.degree[i] + (i == extra_node);
+            weight_prefix += by_degree ? side.degree[i] + (i == extra_node) : 1;
+        }
     }
 
-    // 初始化列索引数组为空
-    out_column_indices = nullptr;
-    in_column_indices = nullptr;
-}
+    // node 这一行已满，腾出至少一个位置
+    void make_room(GappedRows& side, uint32_t node)
+    {
+        uint32_t levels = 1;
+        while ((uint64_t(1) << levels) < side.rows) ++levels;
+        uint64_t used = 0;
+        for (uint32_t height = 1; height <= levels; ++height) {
+            uint64_t size = uint64_t(1) << height;
+            uint32_t first = static_cast<uint32_t>(node / size * size);
+            uint32_t last = static_cast<uint32_t>(std::min<uint64_t>(side.rows, first + size));
+            used = 1;
+            for (uint32_t i = first; i < last; ++i) used += side.degree[i];
+            uint64_t capacity = side.row[last] - side.row[first];
+            double density = LEAF_DENSITY - (LEAF_DENSITY - ROOT_DENSITY) * height / levels;
+            if (used <= capacity * density) {
+                spread_rows(side, first, last, node, side.column, side.row[first], side.row[last]);
+                return;
+            }
+        }
+        // 整个数组都太满，扩容一倍
+        uint64_t capacity = std::max<uint64_t>(2 * used, 16);
+        uint32_t* column = new uint32_t[capacity];
+        spread_rows(side, 0, side.rows, node, column, 0, capacity);
+        delete[] side.column;
+        side.column = column;
+        side.row[side.rows] = static_cast<uint32_t>(capacity);
+    }
 
-// 从边集文件中读取图数据并构建 CSR 结构
-bool CSRGraph::fromFile(const std::string& filename) {
-    std::ifstream infile(filename);
-    if (!infile.is_open()) {
-        std::cerr << "无法打开文件: " << filename << std::endl;
-        return false;
+    // 行内有序插入，已存在时返回 false
+    bool insert_sorted(GappedRows& side, uint32_t node, uint32_t value)
+    {
+        uint32_t* begin = side.column + side.row[node];
+        uint32_t* end = begin + side.degree[node];
+        uint32_t* pos = std::lower_bound(begin, end, value);
+        if (pos != end && *pos == value) return false;
+        if (side.row[node] + side.degree[node] == side.row[node + 1]) {
+            uint32_t index = pos - begin;
+            make_room(side, node);
+            begin = side.column + side.row[node];
+            end = begin + side.degree[node];
+            pos = begin + index;
+        }
+        std::memmove(pos + 1, pos, (end - pos) * sizeof(uint32_t));
+        *pos = value;
+        side.degree[node]++;
+        return true;
     }
 
-    uint32_t u, v;
-    uint32_t max_node = 0;
-    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    // 行内删除，不存在时返回 false
+    bool erase_sorted(GappedRows& side, uint32_t node, uint32_t value)
+    {
+        uint32_t* begin = side.column + side.row[node];
+        uint32_t* end = begin + side.degree[node];
+        uint32_t* pos = std::lower_bound(begin, end, value);
+        if (pos == end || *pos != value) return false;
+        std::memmove(pos, pos + 1, (end - pos - 1) * sizeof(uint32_t));
+        side.degree[node]--;
+        return true;
+    }
 
-    // 第一遍遍历：收集所有边并找到最大节点 ID
-    while (infile >> u >> v) {
-        edges.emplace_back(u, v);
-        if (u > max_node) max_node = u;
-        if (v > max_node) max_node = v;
+    // 按行长拼成紧凑的行指针和列数组
+    void pack_rows(const uint32_t* row, const uint32_t* degree, const uint32_t* column, uint32_t rows,
+                   std::vector<uint32_t>& packed_row, std::vector<uint32_t>& packed_column)
+    {
+        packed_row.assign(uint64_t(rows) + 1, 0);
+        packed_column.clear();
+        for (uint32_t i = 0; i < rows; ++i) {
+            packed_column.insert(packed_column.end(), column + row[i], column + row[i] + degree[i]);
+            packed_row[i + 1] = static_cast<uint32_t>(packed_column.size());
+        }
     }
 
-    infile.close();
+    // 每个线程至少分到的边数，边太少时开线程不划算
+    const size_t MIN_EDGES_PER_THREAD = size_t(1) << 16;
 
-    
-    max_node_id = max_node;
-    num_edges = edges.size();
+    // 并行建好的四个数组，交给 CSRGraph 之后由它负责释放
+    struct CSRArrays
+    {
+        uint32_t* out_row_pointers = nullptr;
+        uint32_t* in_row_pointers = nullptr;
+        uint32_t* out_column_indices = nullptr;
+        uint32_t* in_column_indices = nullptr;
+        uint32_t num_edges = 0;
 
-    // 分配内存
-    out_row_pointers = new uint32_t[max_node_id + 2];
-    in_row_pointers = new uint32_t[max_node_id + 2];
-    partitions = new int16_t[max_node_id];
-    std::memset(out_row_pointers, 0, (max_node_id + 2) * sizeof(uint32_t));
-    std::memset(in_row_pointers, 0, (max_node_id + 2) * sizeof(uint32_t));
-    for (uint32_t i = 0; i < max_node_id; ++i) {
-        partitions[i] = -1;
+        void moveTo(CSRGraph& csr) const
+        {
+            csr.out_row_pointers = out_row_pointers;
+            csr.in_row_pointers = in_row_pointers;
+            csr.out_column_indices = out_column_indices;
+            csr.in_column_indices = in_column_indices;
+            csr.num_edges = num_edges;
+        }
+    };
+
+    // 把 [0, rows) 平均切成 num_threads 段，第 block 段
+    inline void block_range(uint32_t rows, int num_threads, size_t block, uint32_t& begin, uint32_t& end)
+    {
+        uint64_t per_block = (uint64_t(rows) + num_threads - 1) / num_threads;
+        begin = static_cast<uint32_t>(std::min<uint64_t>(rows, per_block * block));
+        end = static_cast<uint32_t>(std::min<uint64_t>(rows, uint64_t(begin) + per_block));
     }
-    out_column_indices = new uint32_t[num_edges];
-    in_column_indices = new uint32_t[num_edges];
 
-    // 统计出边和入边的数量
-    std::vector<uint32_t> out_counts(max_node_id, 0);
-    std::vector<uint32_t> in_counts(max_node_id, 0);
-    for (const auto& edge : edges) {
-        out_counts[edge.first]++;
-        in_counts[edge.second]++;
+    // row[0] = 0，row[v + 1] = row[v] + degree[v]。先每段求和，再串行扫段和，最后每段写回
+    uint32_t parallel_prefix_sum(const uint32_t* degree, uint32_t* row, uint32_t rows, int num_threads)
+    {
+        std::vector<uint64_t> block_sum(num_threads + 1, 0);
+        BatchScheduler::run_dynamic(num_threads, num_threads, [&](int, size_t block) {
+            uint32_t begin, end;
+            block_range(rows, num_threads, block, begin, end);
+            uint64_t sum = 0;
+            for (uint32_t v = begin; v < end; ++v) sum += degree[v];
+            block_sum[block + 1] = sum;
+        });
+        for (int b = 0; b < num_threads; ++b) block_sum[b + 1] += block_sum[b];
+        BatchScheduler::run_dynamic(num_threads, num_threads, [&](int, size_t block) {
+            uint32_t begin, end;
+            block_range(rows, num_threads, block, begin, end);
+            uint32_t offset = static_cast<uint32_t>(block_sum[block]);
+            for (uint32_t v = begin; v < end; ++v) {
+                row[v] = offset;
+                offset += degree[v];
+            }
+        });
+        row[rows] = static_cast<uint32_t>(block_sum[num_threads]);
+        return row[rows];
     }
 
-    // 构建 row_pointers
-    out_row_pointers[0] = 0;
-    in_row_pointers[0] = 0;
-    for (uint32_t i = 0; i < max_node_id; ++i) {
-        out_row_pointers[i + 1] = out_row_pointers[i] + out_counts[i];
-        in_row_pointers[i + 1] = in_row_pointers[i] + in_counts[i];
+    /**
+     * @brief 并行从边集建出边和入边的 CSR，去掉自环、越界的边和重复边，每行升序。
+     * for_each_edge(chunk, emit) 对第 chunk 块的每条边调用 emit(u, v)，块号在 [0, num_chunks) 内，raw_edges 是各块边数之和，
+     * 同一块前后两遍给出的边必须相同。出边和入边在同一遍里一起计数、一起写入：
+     *   1. 每块统计自己的出度和入度直方图
+     *   2. 按点分段求前缀和得到行指针，同时把直方图换成每块在每行里的写入位置
+     *   3. 每块把边写到自己的位置上，不需要原子操作
+     *   4. 每行排序去重，有重复边时再做一次前缀和并压紧
+     * 直方图占 块数 * 点数 的空间，点多边少时改用原子计数器，写入顺序不确定，但排序后结果相同。
+     */
+    template <typename ForEachEdge>
+    CSRArrays build_csr_arrays(uint32_t rows, size_t num_chunks, int num_threads, uint64_t raw_edges,
+                               ForEachEdge&& for_each_edge)
+    {
+        // 第一遍：计数
+        bool use_histograms = num_chunks == 1 ||
+                              uint64_t(num_chunks) * rows <= std::max<uint64_t>(2 * raw_edges, uint64_t(1) << 24);
+
+        std::vector<uint32_t> out_degree(rows), in_degree(rows);
+        std::vector<std::vector<uint32_t>> out_hist, in_hist;
+        std::unique_ptr<std::atomic<uint32_t>[]> out_cursor, in_cursor;
+        if (use_histograms) {
+            out_hist.resize(num_chunks);
+            in_hist.resize(num_chunks);
+            BatchScheduler::run_dynamic(num_chunks, num_threads, [&](int, size_t chunk) {
+                std::vector<uint32_t>& out = out_hist[chunk];
+                std::vector<uint32_t>& in = in_hist[chunk];
+                out.assign(rows, 0);
+                in.assign(rows, 0);
+                for_each_edge(chunk, [&](uint32_t u, uint32_t v) {
+                    if (u == v || u >= rows || v >= rows) return;
+                    out[u]++;
+                    in[v]++;
+                });
+            });
+            // 每行的总度数，直方图换成块在行内的相对位置
+            BatchScheduler::run_dynamic(num_threads, num_threads, [&](int, size_t block) {
+                uint32_t begin, end;
+                block_range(rows, num_threads, block, begin, end);
+                for (uint32_t v = begin; v < end; ++v) {
+                    uint32_t out_sum = 0, in_sum = 0;
+                    for (size_t c = 0; c < num_chunks; ++c) {
+                        uint32_t out_count = out_hist[c][v], in_count = in_hist[c][v];
+                        out_hist[c][v] = out_sum;
+                        in_hist[c][v] = in_sum;
+                        out_sum += out_count;
+                        in_sum += in_count;
+                    }
+                    out_degree[v] = out_sum;
+                    in_degree[v] = in_sum;
+                }
+            });
+        } else {
+            out_cursor.reset(new std::atomic<uint32_t>[rows]());
+            in_cursor.reset(new std::atomic<uint32_t>[rows]());
+            BatchScheduler::run_dynamic(num_chunks, num_threads, [&](int, size_t chunk) {
+                for_each_edge(chunk, [&](uint32_t u, uint32_t v) {
+                    if (u == v || u >= rows || v >= rows) return;
+                    out_cursor[u].fetch_add(1, std::memory_order_relaxed);
+                    in_cursor[v].fetch_add(1, std::memory_order_relaxed);
+                });
+            });
+            BatchScheduler::run_dynamic(num_threads, num_threads, [&](int, size_t block) {
+                uint32_t begin, end;
+                block_range(rows, num_threads, block, begin, end);
+                for (uint32_t v = begin; v < end; ++v) {
+                    out_degree[v] = out_cursor[v].exchange(0, std::memory_order_relaxed);
+                    in_degree[v] = in_cursor[v].exchange(0, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        // 带重复边的行指针
+        CSRArrays raw;
+        raw.out_row_pointers = new uint32_t[uint64_t(rows) + 1];
+        raw.in_row_pointers = new uint32_t[uint64_t(rows) + 1];
+        raw.num_edges = parallel_prefix_sum(out_degree.data(), raw.out_row_pointers, rows, num_threads);
+        parallel_prefix_sum(in_degree.data(), raw.in_row_pointers, rows, num_threads);
+        raw.out_column_indices = new uint32_t[raw.num_edges];
+        raw.in_column_indices = new uint32_t[raw.num_edges];
+
+        // 第二遍：写入
+        BatchScheduler::run_dynamic(num_chunks, num_threads, [&](int, size_t chunk) {
+            if (!out_hist.empty()) {
+                std::vector<uint32_t>& out = out_hist[chunk];
+                std::vector<uint32_t>& in = in_hist[chunk];
+                for_each_edge(chunk, [&](uint32_t u, uint32_t v) {
+                    if (u == v || u >= rows || v >= rows) return;
+                    raw.out_column_indices[raw.out_row_pointers[u] + out[u]++] = v;
+                    raw.in_column_indices[raw.in_row_pointers[v] + in[v]++] = u;
+                });
+            } else {
+                for_each_edge(chunk, [&](uint32_t u, uint32_t v) {
+                    if (u == v || u >= rows || v >= rows) return;
+                    raw.out_column_indices[raw.out_row_pointers[u] + out_cursor[u].fetch_add(1, std::memory_order_relaxed)] = v;
+                    raw.in_column_indices[raw.in_row_pointers[v] + in_cursor[v].fetch_add(1, std::memory_order_relaxed)] = u;
+                });
+            }
+        });
+        std::vector<std::vector<uint32_t>>().swap(out_hist);
+        std::vector<std::vector<uint32_t>>().swap(in_hist);
+        out_cursor.reset();
+        in_cursor.reset();
+
+        // 每行排序去重，度数记成去重后的长度；高度数的行耗时长，用可以偷任务的调度
+        std::atomic<uint64_t> duplicates{0};
+        BatchScheduler::run(rows, num_threads, [&](int, size_t begin, size_t end) {
+            uint64_t removed = 0;
+            for (size_t v = begin; v < end; ++v) {
+                uint32_t* out_begin = raw.out_column_indices + raw.out_row_pointers[v];
+                uint32_t* out_end = raw.out_column_indices + raw.out_row_pointers[v + 1];
+                std::sort(out_begin, out_end);
+                out_degree[v] = std::unique(out_begin, out_end) - out_begin;
+                uint32_t* in_begin = raw.in_column_indices + raw.in_row_pointers[v];
+                uint32_t* in_end = raw.in_column_indices + raw.in_row_pointers[v + 1];
+                std::sort(in_begin, in_end);
+                in_degree[v] = std::unique(in_begin, in_end) - in_begin;
+                removed += (out_end - out_begin) - out_degree[v];
+            }
+            duplicates.fetch_add(removed, std::memory_order_relaxed);
+        });
+        if (duplicates.load() == 0) return raw;
+
+        // 有重复边，压紧到新数组
+        CSRArrays result;
+        result.out_row_pointers = new uint32_t[uint64_t(rows) + 1];
+        result.in_row_pointers = new uint32_t[uint64_t(rows) + 1];
+        result.num_edges = parallel_prefix_sum(out_degree.data(), result.out_row_pointers, rows, num_threads);
+        parallel_prefix_sum(in_degree.data(), result.in_row_pointers, rows, num_threads);
+        result.out_column_indices = new uint32_t[result.num_edges];
+        result.in_column_indices = new uint32_t[result.num_edges];
+        BatchScheduler::run(rows, num_threads, [&](int, size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                std::memcpy(result.out_column_indices + result.out_row_pointers[v],
+                            raw.out_column_indices + raw.out_row_pointers[v], out_degree[v] * sizeof(uint32_t));
+                std::memcpy(result.in_column_indices + result.in_row_pointers[v],
+                            raw.in_column_indices + raw.in_row_pointers[v], in_degree[v] * sizeof(uint32_t));
+            }
+        });
+        delete[] raw.out_row_pointers;
+        delete[] raw.in_row_pointers;
+        delete[] raw.out_column_indices;
+        delete[] raw.in_column_indices;
+        return result;
     }
+}
 
-    // 填充 column_indices
-    std::vector<uint32_t> out_offsets(max_node_id, 0);
-    std::vector<uint32_t> in_offsets(max_node_id, 0);
-    for (const auto& edge : edges) {
-        uint32_t src = edge.first;
-        uint32_t dst = edge.second;
-        out_column_indices[out_row_pointers[src] + out_offsets[src]] = dst;
-        in_column_indices[in_row_pointers[dst] + in_offsets[dst]] = src;
-        out_offsets[src]++;
-        in_offsets[dst]++;
+void CSRGraph::release() {
+    if (mapped_addr != nullptr) {
+        munmap(mapped_addr, mapped_bytes);
+        mapped_addr = nullptr;
+        mapped_bytes = 0;
+    } else {
+        delete[] out_column_indices;
+        delete[] out_row_pointers;
+        delete[] in_column_indices;
+        delete[] in_row_pointers;
+        delete[] partitions;
     }
+    delete[] out_degrees;
+    delete[] in_degrees;
+    out_column_indices = nullptr;
+    out_row_pointers = nullptr;
+    in_column_indices = nullptr;
+    in_row_pointers = nullptr;
+    out_degrees = nullptr;
+    in_degrees = nullptr;
+    partitions = nullptr;
+}
 
-    // 对每个节点的出边和入边进行排序
-    for (uint32_t i = 0; i < max_node_id; ++i) {
-        uint32_t out_start = out_row_pointers[i];
-        uint32_t out_end = out_row_pointers[i + 1];
-        std::sort(out_column_indices + out_start, out_column_indices + out_end);
+void CSRGraph::enableDynamic() {
+    if (isDynamic() || out_row_pointers == nullptr) return;
+    detachMapping();
+    uint32_t rows = max_node_id + 1;
+    out_degrees = new uint32_t[rows];
+    in_degrees = new uint32_t[rows];
+    for (uint32_t i = 0; i < rows; ++i) {
+        out_degrees[i] = out_row_pointers[i + 1] - out_row_pointers[i];
+        in_degrees[i] = in_row_pointers[i + 1] - in_row_pointers[i];
+    }
+    // 初始留一倍的空隙
+    uint64_t capacity = std::max<uint64_t>(2 * uint64_t(num_edges), 16);
+    GappedRows out{out_column_indices, out_row_pointers, out_degrees, rows};
+    GappedRows in{in_column_indices, in_row_pointers, in_degrees, rows};
+    for (GappedRows* side : {&out, &in}) {
+        uint32_t* column = new uint32_t[capacity];
+        spread_rows(*side, 0, rows, rows, column, 0, capacity);
+        delete[] side->column;
+        side->column = column;
+        side->row[rows] = static_cast<uint32_t>(capacity);
+    }
+}
+
+void CSRGraph::compact() {
+    if (!isDynamic()) return;
+    uint32_t rows = max_node_id + 1;
+    std::vector<uint32_t> packed_row, packed_column;
+    pack_rows(out_row_pointers, out_degrees, out_column_indices, rows, packed_row, packed_column);
+    delete[] out_column_indices;
+    out_column_indices = new uint32_t[packed_column.size()];
+    std::copy(packed_column.begin(), packed_column.end(), out_column_indices);
+    std::copy(packed_row.begin(), packed_row.end(), out_row_pointers);
+    pack_rows(in_row_pointers, in_degrees, in_column_indices, rows, packed_row, packed_column);
+    delete[] in_column_indices;
+    in_column_indices = new uint32_t[packed_column.size()];
+    std::copy(packed_column.begin(), packed_column.end(), in_column_indices);
+    std::copy(packed_row.begin(), packed_row.end(), in_row_pointers);
+    delete[] out_degrees;
+    delete[] in_degrees;
+    out_degrees = nullptr;
+    in_degrees = nullptr;
+}
+
+void CSRGraph::detachMapping() {
+    if (mapped_addr == nullptr) return;
+    uint32_t rows = max_node_id + 2;
+    uint32_t* new_out_row_pointers = new uint32_t[rows];
+    uint32_t* new_in_row_pointers = new uint32_t[rows];
+    uint32_t* new_out_column_indices = new uint32_t[num_edges];
+    uint32_t* new_in_column_indices = new uint32_t[num_edges];
+    int16_t* new_partitions = new int16_t[max_node_id + 1];
+    std::memcpy(new_out_row_pointers, out_row_pointers, rows * sizeof(uint32_t));
+    std::memcpy(new_in_row_pointers, in_row_pointers, rows * sizeof(uint32_t));
+    std::memcpy(new_out_column_indices, out_column_indices, num_edges * sizeof(uint32_t));
+    std::memcpy(new_in_column_indices, in_column_indices, num_edges * sizeof(uint32_t));
+    std::memcpy(new_partitions, partitions, (max_node_id + 1) * sizeof(int16_t));
+    munmap(mapped_addr, mapped_bytes);
+    mapped_addr = nullptr;
+    mapped_bytes = 0;
+    out_row_pointers = new_out_row_pointers;
+    in_row_pointers = new_in_row_pointers;
+    out_column_indices = new_out_column_indices;
+    in_column_indices = new_in_column_indices;
+    partitions = new_partitions;
+}
 
-        uint32_t in_start = in_row_pointers[i];
-        uint32_t in_end = in_row_pointers[i + 1];
-        std::sort(in_column_indices + in_start, in_column_indices + in_end);
+bool CSRGraph::saveBinary(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "无法写入文件: " << filename << std::endl;
+        return false;
+    }
+    CSRFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CSR_MAGIC, sizeof(CSR_MAGIC));
+    header.version = CSR_VERSION;
+    header.header_bytes = sizeof(CSRFileHeader);
+    header.max_node_id = max_node_id;
+    header.num_nodes = num_nodes;
+    header.num_edges = num_edges;
+    layout_sections(header);
+
+    // 动态模式下先按行拼成紧凑的数组再写
+    const uint32_t* out_row = out_row_pointers;
+    const uint32_t* in_row = in_row_pointers;
+    const uint32_t* out_col = out_column_indices;
+    const uint32_t* in_col = in_column_indices;
+    std::vector<uint32_t> packed_out_row, packed_in_row, packed_out_col, packed_in_col;
+    if (isDynamic()) {
+        pack_rows(out_row_pointers, out_degrees, out_column_indices, max_node_id + 1, packed_out_row, packed_out_col);
+        pack_rows(in_row_pointers, in_degrees, in_column_indices, max_node_id + 1, packed_in_row, packed_in_col);
+        out_row = packed_out_row.data();
+        in_row = packed_in_row.data();
+        out_col = packed_out_col.data();
+        in_col = packed_in_col.data();
     }
 
-    //计算节点数量
-    for (uint32_t i = 0; i < max_node_id; i++)
-    {
-        if(out_row_pointers[i]==out_row_pointers[i+1]&&in_row_pointers[i]==in_row_pointers[i+1])
-            continue;
-        num_nodes++;
+    uint64_t rows = uint64_t(max_node_id) + 2;
+    uint64_t written = 0;
+    auto write_at = [&](uint64_t offset, const void* data, uint64_t bytes) {
+        // 段之间补 0 对齐
+        static const char zeros[64] = {0};
+        while (written < offset) {
+            uint64_t pad = std::min<uint64_t>(offset - written, sizeof(zeros));
+            out.write(zeros, pad);
+            written += pad;
+        }
+        out.write(static_cast<const char*>(data), bytes);
+        written += bytes;
+    };
+    write_at(0, &header, sizeof(header));
+    write_at(header.out_row_offset, out_row, rows * sizeof(uint32_t));
+    write_at(header.in_row_offset, in_row, rows * sizeof(uint32_t));
+    write_at(header.out_col_offset, out_col, uint64_t(num_edges) * sizeof(uint32_t));
+    write_at(header.in_col_offset, in_col, uint64_t(num_edges) * sizeof(uint32_t));
+    write_at(header.partitions_offset, partitions, (rows - 1) * sizeof(int16_t));
+    return static_cast<bool>(out);
+}
+
+bool CSRGraph::fromBinary(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "无法打开文件: " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(CSRFileHeader)) {
+        close(fd);
+        std::cerr << "不是二进制 CSR 文件: " << filename << std::endl;
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "mmap 失败: " << filename << std::endl;
+        return false;
     }
-    
 
+    // 校验文件头和各段的位置
+    CSRFileHeader header;
+    std::memcpy(&header, addr, sizeof(header));
+    CSRFileHeader expected = header;
+    uint64_t expected_bytes = layout_sections(expected);
+    if (std::memcmp(header.magic, CSR_MAGIC, sizeof(CSR_MAGIC)) != 0 || header.version != CSR_VERSION ||
+        header.header_bytes != sizeof(CSRFileHeader) || bytes < expected_bytes ||
+        header.out_row_offset != expected.out_row_offset || header.in_row_offset != expected.in_row_offset ||
+        header.out_col_offset != expected.out_col_offset || header.in_col_offset != expected.in_col_offset ||
+        header.partitions_offset != expected.partitions_offset) {
+        munmap(addr, bytes);
+        std::cerr << "不是二进制 CSR 文件或版本不匹配: " << filename << std::endl;
+        return false;
+    }
+    // 逐项检查行指针和列号，一遍 O(n + m)
+    char* base = static_cast<char*>(addr);
+    const uint32_t* out_row = reinterpret_cast<const uint32_t*>(base + header.out_row_offset);
+    const uint32_t* in_row = reinterpret_cast<const uint32_t*>(base + header.in_row_offset);
+    const uint32_t* out_col = reinterpret_cast<const uint32_t*>(base + header.out_col_offset);
+    const uint32_t* in_col = reinterpret_cast<const uint32_t*>(base + header.in_col_offset);
+    if (!valid_rows(out_row, out_col, header.max_node_id, header.num_edges) ||
+        !valid_rows(in_row, in_col, header.max_node_id, header.num_edges)) {
+        munmap(addr, bytes);
+        std::cerr << "CSR 文件的行指针或列号越界: " << filename << std::endl;
+        return false;
+    }
 
+    release();
+    mapped_addr = addr;
+    mapped_bytes = bytes;
+    max_node_id = header.max_node_id;
+    num_nodes = header.num_nodes;
+    num_edges = header.num_edges;
+    out_row_pointers = reinterpret_cast<uint32_t*>(base + header.out_row_offset);
+    in_row_pointers = reinterpret_cast<uint32_t*>(base + header.in_row_offset);
+    out_column_indices = reinterpret_cast<uint32_t*>(base + header.out_col_offset);
+    in_column_indices = reinterpret_cast<uint32_t*>(base + header.in_col_offset);
+    partitions = reinterpret_cast<int16_t*>(base + header.partitions_offset);
     return true;
 }
 
-// 从现有Graph类创建CSR
-bool CSRGraph::fromGraph(const Graph& graph) {
+// 创建一个空的 CSRGraph，指定顶点数量
+bool CSRGraph::createEmptyCSR(uint32_t num_vertices) {
+    release();
     // 设置最大节点 ID
-    max_node_id = graph.vertices.size() - 1;
-
-    // 填充 column_indices的vector
-    std::vector<uint32_t> out_offsets(max_node_id+1, 0);
-    std::vector<uint32_t> in_offsets(max_node_id+1, 0);
-    
-    // 统计出边和入边的数量
-    std::vector<uint32_t> out_counts(max_node_id+1, 0);
-    std::vector<uint32_t> in_counts(max_node_id+1, 0);
+    max_node_id = num_vertices > 0 ? num_vertices - 1 : 0;
+    num_nodes = num_vertices;
+    num_edges = 0;
 
-    // CSR的顶点行
+    // 分配行指针数组，初始化为0
     out_row_pointers = new uint32_t[max_node_id + 2];
     in_row_pointers = new uint32_t[max_node_id + 2];
-    partitions = new int16_t[max_node_id+1];
-
-    // 统计总边数
-    num_edges = graph.get_num_edges();
-
-    out_column_indices = new uint32_t[num_edges];
-    in_column_indices = new uint32_t[num_edges];
-
-
     std::memset(out_row_pointers, 0, (max_node_id + 2) * sizeof(uint32_t));
     std::memset(in_row_pointers, 0, (max_node_id + 2) * sizeof(uint32_t));
-    for (uint32_t i = 0; i < max_node_id + 1; ++i) {
-        partitions[i] = graph.vertices[i].partition_id;
-    }
 
+    // 分配分区数组，初始化为-1
+    partitions = new int16_t[max_node_id + 1];
+    for (uint32_t i = 0; i <= max_node_id; ++i) {
+        partitions[i] = -1;
+    }
 
+    // 初始化列索引数组为空
+    out_column_indices = nullptr;
+    in_column_indices = nullptr;
+    return true;
+}
 
-    for (size_t u = 0; u < graph.vertices.size(); u++) {
-        if(graph.vertices[u].LOUT.size()==0)continue;
-        for (size_t v_idx = 0; v_idx < graph.vertices[u].LOUT.size(); v_idx++) {
-            uint32_t v = graph.vertices[u].LOUT[v_idx];
-            out_counts[u]++;
-            if (v < max_node_id+1) { // 确保 v 不越界
-                in_counts[v]++;
-            }
-        }
+// 从边集文件中读取图数据并构建 CSR 结构
+// 和 Graph::addEdge 一致，去掉自环和重复边，每行升序
+bool CSRGraph::fromFile(const std::string& filename, int num_threads) {
+    // 文件 mmap 后多线程解析，不足两个数的行跳过
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    if (!TextParser::parse_edges(filename, edges, num_threads)) {
+        return false;
     }
 
-    // 构建 row_pointers
-    out_row_pointers[0] = 0;
-    in_row_pointers[0] = 0;
-    for (uint32_t i = 0; i < max_node_id+1; ++i) {
-        out_row_pointers[i + 1] = out_row_pointers[i] + out_counts[i];
-        in_row_pointers[i + 1] = in_row_pointers[i] + in_counts[i];
+    // 找到最大节点 ID，自环在建 CSR 时去掉
+    uint32_t max_node = 0;
+    for (const auto& edge : edges) {
+        max_node = std::max(max_node, std::max(edge.first, edge.second));
     }
 
+    uint32_t rows = max_node + 1;
+    int threads = BatchScheduler::resolve_threads(num_threads, edges.size(), MIN_EDGES_PER_THREAD);
+    size_t per_chunk = (edges.size() + threads - 1) / threads;
+    CSRArrays arrays = build_csr_arrays(rows, threads, threads, edges.size(), [&](size_t chunk, auto&& emit) {
+        size_t begin = std::min(edges.size(), chunk * per_chunk);
+        size_t end = std::min(edges.size(), begin + per_chunk);
+        for (size_t i = begin; i < end; ++i)
+            emit(edges[i].first, edges[i].second);
+    });
+    std::vector<std::pair<uint32_t, uint32_t>>().swap(edges);
+
+    release();
+    max_node_id = max_node;
+    arrays.moveTo(*this);
+    partitions = new int16_t[rows];
+    std::fill(partitions, partitions + rows, int16_t(-1));
 
-    for (size_t u = 0; u < graph.vertices.size(); u++) {
-        if(graph.vertices[u].LOUT.size()==0)continue;
-        // 对出边进行排序
-        std::vector<uint32_t> sorted_LOUT(graph.vertices[u].LOUT.begin(), graph.vertices[u].LOUT.end());
-        std::sort(sorted_LOUT.begin(), sorted_LOUT.end());
+    //计算节点数量
+    num_nodes = getNodesNum();
 
-        for (const auto& v : sorted_LOUT) {
-            if (v >= max_node_id+1) continue; // 确保 v 不越界
+    return true;
+}
 
-            // 添加出边
-            out_column_indices[out_row_pointers[u] + out_offsets[u]] = v;
-            out_offsets[u]++;
+// 从现有Graph类创建CSR
+bool CSRGraph::fromGraph(const Graph& graph, int num_threads) {
+    uint32_t rows = graph.vertices.empty() ? 1 : graph.vertices.size();
+
+    // 按出边数切块，每块是一段连续的源点，块内出边总数大致相同
+    uint64_t total = 0;
+    for (const auto& vertex : graph.vertices) total += vertex.LOUT.size();
+    int threads = BatchScheduler::resolve_threads(num_threads, total, MIN_EDGES_PER_THREAD);
+    std::vector<size_t> bounds(1, 0);
+    uint64_t seen = 0;
+    for (size_t u = 0; u < graph.vertices.size() && bounds.size() < static_cast<size_t>(threads); ++u) {
+        seen += graph.vertices[u].LOUT.size();
+        if (seen * threads >= total * bounds.size()) bounds.push_back(u + 1);
+    }
+    while (bounds.size() <= static_cast<size_t>(threads)) bounds.push_back(graph.vertices.size());
+    bounds.back() = graph.vertices.size();
 
-            // 添加入边
-            in_column_indices[in_row_pointers[v] + in_offsets[v]] = u;
-            in_offsets[v]++;
+    CSRArrays arrays = build_csr_arrays(rows, threads, threads, total, [&](size_t chunk, auto&& emit) {
+        for (size_t u = bounds[chunk]; u < bounds[chunk + 1]; ++u) {
+            for (int v : graph.vertices[u].LOUT) emit(static_cast<uint32_t>(u), static_cast<uint32_t>(v));
         }
-    }
+    });
 
-    // 对每个节点的入边进行排序
-    for (uint32_t i = 0; i < max_node_id+1; ++i) {
-        uint32_t in_start = in_row_pointers[i];
-        uint32_t in_end = in_row_pointers[i + 1];
-        std::sort(in_column_indices + in_start, in_column_indices + in_end);
+    release();
+    max_node_id = rows - 1;
+    arrays.moveTo(*this);
+    partitions = new int16_t[rows];
+    for (uint32_t i = 0; i < graph.vertices.size(); ++i) {
+        partitions[i] = graph.vertices[i].partition_id;
     }
+    if (graph.vertices.empty()) partitions[0] = -1;
 
-    // 获取总节点数
-    // for(auto i:graph.vertices){
-    //     if(i.in_degree==0&&i.out_degree==0)continue;
-    //     num_nodes++;
-    // }
     num_nodes = graph.get_num_vertices();
-    //获取每个节点的分区号
-    // this->partitions = new int16_t[max_node_id+1];
-    // for(auto node:graph.vertices){
-    //     this->partitions[node.partition_id] = node.partition_id;
-    // }
-    // if(graph.vertices[0].LOUT.size()==0 && graph.vertices[0].LIN.size()==0){
-    //     removeNode(0);
-    // }
     return true;
 }
 
-
-
 // 获取某个节点的所有出边
 uint32_t* CSRGraph::getOutgoingEdges(uint32_t node, uint32_t& degree) const {
     if (node > max_node_id) {
         degree = 0;
         return nullptr;
     }
-    degree = out_row_pointers[node + 1] - out_row_pointers[node];
+    degree = out_degrees ? out_degrees[node] : out_row_pointers[node + 1] - out_row_pointers[node];
     return out_column_indices + out_row_pointers[node];
 }
 
@@ -229,41 +699,56 @@ uint32_t* CSRGraph::getIncomingEdges(uint32_t node, uint32_t& degree) const {
         degree = 0;
         return nullptr;
     }
-    degree = in_row_pointers[node + 1] - in_row_pointers[node];
+    degree = in_degrees ? in_degrees[node] : in_row_pointers[node + 1] - in_row_pointers[node];
     return in_column_indices + in_row_pointers[node];
 }
 
 // 获取某个节点的出度
 uint32_t CSRGraph::getOutDegree(uint32_t node) const {
     if (node > max_node_id) return 0;
-    return out_row_pointers[node + 1] - out_row_pointers[node];
+    return out_degrees ? out_degrees[node] : out_row_pointers[node + 1] - out_row_pointers[node];
 }
 
 // 获取某个节点的入度
 uint32_t CSRGraph::getInDegree(uint32_t node) const {
     if (node > max_node_id) return 0;
-    return in_row_pointers[node + 1] - in_row_pointers[node];
+    return in_degrees ? in_degrees[node] : in_row_pointers[node + 1] - in_row_pointers[node];
 }
 
 // 增加节点
 bool CSRGraph::addNode() {
+    detachMapping();
     uint32_t new_max_node_id = max_node_id + 1;
     num_nodes++;
 
     // 重新分配 row_pointers 和 partitions
     uint32_t* new_out_row_pointers = new uint32_t[new_max_node_id + 2];
     uint32_t* new_in_row_pointers = new uint32_t[new_max_node_id + 2];
-    int16_t* new_partitions = new int16_t[new_max_node_id];
+    int16_t* new_partitions = new int16_t[new_max_node_id + 1];
 
     // 复制旧数据
     std::memcpy(new_out_row_pointers, out_row_pointers, (max_node_id + 2) * sizeof(uint32_t));
     std::memcpy(new_in_row_pointers, in_row_pointers, (max_node_id + 2) * sizeof(uint32_t));
-    std::memcpy(new_partitions, partitions, max_node_id * sizeof(int16_t));
-
-    // 初始化新节点的 row_pointers 和 partition
-    new_out_row_pointers[new_max_node_id] = new_out_row_pointers[max_node_id];
-    new_in_row_pointers[new_max_node_id] = new_in_row_pointers[max_node_id];
-    new_partitions[max_node_id] = -1;
+    std::memcpy(new_partitions, partitions, (max_node_id + 1) * sizeof(int16_t));
+
+    // 新节点是空行，partition 为 -1
+    new_out_row_pointers[new_max_node_id + 1] = new_out_row_pointers[new_max_node_id];
+    new_in_row_pointers[new_max_node_id + 1] = new_in_row_pointers[new_max_node_id];
+    new_partitions[new_max_node_id] = -1;
+
+    // 动态模式下度数数组也要加一项
+    if (isDynamic()) {
+        uint32_t* new_out_degrees = new uint32_t[new_max_node_id + 1];
+        uint32_t* new_in_degrees = new uint32_t[new_max_node_id + 1];
+        std::memcpy(new_out_degrees, out_degrees, (max_node_id + 1) * sizeof(uint32_t));
+        std::memcpy(new_in_degrees, in_degrees, (max_node_id + 1) * sizeof(uint32_t));
+        new_out_degrees[new_max_node_id] = 0;
+        new_in_degrees[new_max_node_id] = 0;
+        delete[] out_degrees;
+        delete[] in_degrees;
+        out_degrees = new_out_degrees;
+        in_degrees = new_in_degrees;
+    }
 
     // 释放旧内存
     delete[] out_row_pointers;
@@ -282,6 +767,9 @@ bool CSRGraph::addNode() {
 // 删除节点
 
 bool CSRGraph::removeNode(uint32_t node) {
+    detachMapping();
+    // 下面按紧凑布局整体移动数组
+    compact();
     if (node > max_node_id) {
         std::cerr << "错误: 节点 " << node << " 超出范围." << std::endl;
         return false;
@@ -391,146 +879,45 @@ bool CSRGraph::removeNode(uint32_t node) {
 
 }
 // 增加边（假定新点的id不会大于当前最大节点的id）
-// 并且已经有边的数组了
+// 第一次调用时转成动态模式，之后只在行内移动，行满时局部重新分配空隙
 bool CSRGraph::addEdge(uint32_t u, uint32_t v) {
-    
     if (u > max_node_id || v > max_node_id) return false;
     if(u==v)return false;
+    enableDynamic();
 
-    // 更新顶点数目
-    if(out_row_pointers[u]==out_row_pointers[u+1]){
-        num_nodes++;
-    }
-    if(in_row_pointers[v]==in_row_pointers[v+1]){
-        num_nodes++;
-    }
-
-    // 增加出边
-    uint32_t out_start = out_row_pointers[u];
-    uint32_t out_end = out_row_pointers[u + 1];
-    uint32_t out_degree = out_end - out_start;
-
-    // 找到插入位置以保持排序
-    uint32_t* out_ptr = out_column_indices + out_start;
-    uint32_t insert_pos = std::lower_bound(out_ptr, out_ptr + out_degree, v) - out_ptr;
-
-    // 检查是否已经存在
-    if (insert_pos < out_degree && out_ptr[insert_pos] == v) {
-        // 边已存在
-        return false;
-    }
-
-    // 重新分配 out_column_indices
-    uint32_t* new_out_column_indices = new uint32_t[num_edges];
-    std::memcpy(new_out_column_indices, out_column_indices, (out_start + insert_pos) * sizeof(uint32_t));
-    new_out_column_indices[out_start + insert_pos] = v;
-    std::memcpy(new_out_column_indices + out_start + insert_pos + 1, out_column_indices + out_start + insert_pos, (num_edges - (out_start + insert_pos)) * sizeof(uint32_t));
-    delete[] out_column_indices;
-    out_column_indices = new_out_column_indices;
-
-    // 增加入边
-    uint32_t in_start = in_row_pointers[v];
-    uint32_t in_end = in_row_pointers[v + 1];
-    uint32_t in_degree = in_end - in_start;
-
-    // 找到插入位置以保持排序
-    uint32_t* in_ptr = in_column_indices + in_start;
-    uint32_t in_insert_pos = std::lower_bound(in_ptr, in_ptr + in_degree, u) - in_ptr;
-
-    // 检查是否已经存在
-    if (in_insert_pos < in_degree && in_ptr[in_insert_pos] == u) {
+    bool u_exists = nodeExist(u);
+    bool v_exists = nodeExist(v);
+    GappedRows out{out_column_indices, out_row_pointers, out_degrees, max_node_id + 1};
+    if (!insert_sorted(out, u, v)) {
         // 边已存在
         return false;
     }
+    GappedRows in{in_column_indices, in_row_pointers, in_degrees, max_node_id + 1};
+    insert_sorted(in, v, u);
 
-    // 重新分配 in_column_indices
-    uint32_t* new_in_column_indices = new uint32_t[num_edges + 1];
-    std::memcpy(new_in_column_indices, in_column_indices, (in_start + in_insert_pos) * sizeof(uint32_t));
-    new_in_column_indices[in_start + in_insert_pos] = u;
-    std::memcpy(new_in_column_indices + in_start + in_insert_pos + 1, in_column_indices + in_start + in_insert_pos, (num_edges - (in_start + in_insert_pos)) * sizeof(uint32_t));
-    delete[] in_column_indices;
-    in_column_indices = new_in_column_indices;
-
-    // 更新 row_pointers
-    for (uint32_t i = u + 1; i <= max_node_id; ++i) {
-        out_row_pointers[i]++;
-    }
-    for (uint32_t i = v + 1; i <= max_node_id; ++i) {
-        in_row_pointers[i]++;
-    }
-
-
-
+    // 更新顶点数目
+    num_nodes += !u_exists + !v_exists;
     num_edges++;
-
     return true;
 }
 
-// 删除边
+// 删除边，和 addEdge 一样在动态模式下进行
 bool CSRGraph::removeEdge(uint32_t u, uint32_t v) {
     if (u > max_node_id || v > max_node_id) return false;
+    enableDynamic();
 
-    // 删除出边
-    uint32_t out_start = out_row_pointers[u];
-    uint32_t out_end = out_row_pointers[u + 1];
-    uint32_t* out_ptr = out_column_indices + out_start;
-    uint32_t* out_found = std::find(out_ptr, out_ptr + (out_end - out_start), v);
-    if (out_found == out_ptr + (out_end - out_start)) {
+    GappedRows out{out_column_indices, out_row_pointers, out_degrees, max_node_id + 1};
+    if (!erase_sorted(out, u, v)) {
         // 边不存在
         return false;
     }
-    uint32_t out_index = out_found - out_column_indices;
-
-    // 重新分配 out_column_indices
-    uint32_t* new_out_column_indices = new uint32_t[num_edges - 1];
-    std::memcpy(new_out_column_indices, out_column_indices, out_index * sizeof(uint32_t));
-    std::memcpy(new_out_column_indices + out_index, out_column_indices + out_index + 1, (num_edges - out_index - 1) * sizeof(uint32_t));
-    delete[] out_column_indices;
-    out_column_indices = new_out_column_indices;
-
-    // 删除入边
-    uint32_t in_start = in_row_pointers[v];
-    uint32_t in_end = in_row_pointers[v + 1];
-    uint32_t* in_ptr = in_column_indices + in_start;
-    uint32_t* in_found = std::find(in_ptr, in_ptr + (in_end - in_start), u);
-    if (in_found == in_ptr + (in_end - in_start)) {
-        // 入边不存在，逻辑错误
-        return false;
-    }
-    uint32_t in_index = in_found - in_column_indices;
-
-    // 重新分配 in_column_indices
-    uint32_t* new_in_column_indices = new uint32_t[num_edges - 1];
-    std::memcpy(new_in_column_indices, in_column_indices, in_index * sizeof(uint32_t));
-    std::memcpy(new_in_column_indices + in_index, in_column_indices + in_index + 1, (num_edges - in_index - 1) * sizeof(uint32_t));
-    delete[] in_column_indices;
-    in_column_indices = new_in_column_indices;
-
-    // 更新 row_pointers
-    for (uint32_t i = u + 1; i <= max_node_id; ++i) {
-        out_row_pointers[i]--;
-    }
-    for (uint32_t i = v + 1; i <= max_node_id; ++i) {
-        in_row_pointers[i]--;
-    }
-
+    GappedRows in{in_column_indices, in_row_pointers, in_degrees, max_node_id + 1};
+    erase_sorted(in, v, u);
     num_edges--;
 
     // 检查并更新节点的有效性
-    if (out_row_pointers[u] == out_row_pointers[u + 1] && in_row_pointers[u] == in_row_pointers[u + 1]) {
-        num_nodes--;
-    }
-    if (out_row_pointers[v] == out_row_pointers[v + 1] && in_row_pointers[v] == in_row_pointers[v + 1]) {
-        num_nodes--;
-    }
-
-    // 更新 max_node_id
-    while (max_node_id > 0 && out_row_pointers[max_node_id - 1] == out_row_pointers[max_node_id] &&
-           in_row_pointers[max_node_id - 1] == in_row_pointers[max_node_id]) {
-        max_node_id--;
-    }
-
-
+    if (!nodeExist(u)) num_nodes--;
+    if (!nodeExist(v)) num_nodes--;
     return true;
 }
 
@@ -563,7 +950,7 @@ void CSRGraph::printAllInfo() const {
     std::cout << "Edges:" << std::endl;
     for (uint32_t u = 0; u < max_node_id+1; ++u) {
         uint32_t out_start = out_row_pointers[u];
-        uint32_t out_end = out_row_pointers[u + 1];
+        uint32_t out_end = out_start + getOutDegree(u);
         for (uint32_t i = out_start; i < out_end; ++i) {
             uint32_t v = out_column_indices[i];
             std::cout << "  " << u << " -> " << v << std::endl;
@@ -578,7 +965,7 @@ void CSRGraph::printAllInfo() const {
     std::cout << "Outgoing edges:" << std::endl;
     for (uint32_t u = 0; u < max_node_id+1; ++u) {
         uint32_t out_start = out_row_pointers[u];
-        uint32_t out_end = out_row_pointers[u + 1];
+        uint32_t out_end = out_start + getOutDegree(u);
         if(out_end - out_start == 0)continue;
         std::cout << "  Node " << u << " has " << (out_end - out_start) << " outgoing edges: ";
         for (uint32_t i = out_start; i < out_end; ++i) {
@@ -589,7 +976,7 @@ void CSRGraph::printAllInfo() const {
     std::cout << "Incoming edges:" << std::endl;
     for (uint32_t u = 0; u < max_node_id+1; ++u) {
         uint32_t in_start = in_row_pointers[u];
-        uint32_t in_end = in_row_pointers[u + 1];
+        uint32_t in_end = in_start + getInDegree(u);
         if(in_end - in_start == 0)continue;
         std::cout << "  Node " << u << " has " << (in_end - in_start) << " incoming edges: ";
         for (uint32_t i = in_start; i < in_end; ++i) {
@@ -616,13 +1003,13 @@ void CSRGraph::printCSRs() const{
     std::cout << std::endl;
 
     std::cout << "out_column_indices: ";
-    for (uint32_t i = 0; i < num_edges; ++i) {
+    for (uint32_t i = 0; i < out_row_pointers[max_node_id + 1]; ++i) {
         std::cout << out_column_indices[i] << " ";
     }
     std::cout << std::endl;
 
     std::cout << "in_column_indices: ";
-    for (uint32_t i = 0; i < num_edges; ++i) {
+    for (uint32_t i = 0; i < in_row_pointers[max_node_id + 1]; ++i) {
         std::cout << in_column_indices[i] << " ";
     }
     std::cout<<std::endl;
@@ -636,6 +1023,12 @@ uint64_t CSRGraph::getMemoryUsage() const
     // 计算出边和入边的列索引数组所占内存
     memoryUsage += num_edges * sizeof(uint32_t) * 2; // out_column_indices 和 in_column_indices
 
+    // 动态模式下还有空隙和度数数组
+    if (isDynamic()) {
+        memoryUsage += (uint64_t(out_row_pointers[max_node_id + 1]) + in_row_pointers[max_node_id + 1] - 2 * num_edges) * sizeof(uint32_t);
+        memoryUsage += (max_node_id + 1) * sizeof(uint32_t) * 2;
+    }
+
     // 计算出边和入边的行指针数组所占内存
     memoryUsage += (max_node_id + 2) * sizeof(uint32_t) * 2; // out_row_pointers 和 in_row_pointers
 
@@ -648,7 +1041,7 @@ uint64_t CSRGraph::getMemoryUsage() const
 bool CSRGraph::nodeExist(uint32_t node) const
 {
     if(node > max_node_id)return false;
-    if(out_row_pointers[node] == out_row_pointers[node + 1] && in_row_pointers[node] == in_row_pointers[node + 1])return false;
+    if(getOutDegree(node) == 0 && getInDegree(node) == 0)return false;
     return true;
 }
 
@@ -657,7 +1050,7 @@ uint32_t CSRGraph::getNodesNum() const
     uint32_t num=0;
     for (uint32_t i = 0; i < max_node_id + 1; i++)
     {
-        if(out_row_pointers[i]==out_row_pointers[i+1]&&in_row_pointers[i]==in_row_pointers[i+1])
+        if(getOutDegree(i)==0&&getInDegree(i)==0)
             continue;
         else num++;
     }
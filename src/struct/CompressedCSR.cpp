@@ -0,0 +1,107 @@
+#include "CompressedCSR.h"
+#include <iostream>
+
+namespace
+{
+    void append_varint(std::vector<uint8_t> &bytes, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+}
+
+bool CompressedCSR::encode(const uint32_t *row_pointers, const uint32_t *degrees, const uint32_t *columns,
+                           uint32_t rows, Direction &direction)
+{
+    direction.offsets.resize(rows);
+    direction.bytes.clear();
+    for (uint32_t u = 0; u < rows; ++u)
+    {
+        if (direction.bytes.size() > UINT32_MAX)
+            return false;
+        direction.offsets[u] = static_cast<uint32_t>(direction.bytes.size());
+        uint32_t degree = degrees ? degrees[u] : row_pointers[u + 1] - row_pointers[u];
+        const uint32_t *neighbors = columns + row_pointers[u];
+        append_varint(direction.bytes, degree);
+        if (degree == 0)
+            continue;
+        // 第一个邻居相对行号可正可负，zigzag 之后小的差值都是小数
+        int64_t diff = int64_t(neighbors[0]) - int64_t(u);
+        append_varint(direction.bytes, static_cast<uint32_t>((diff << 1) ^ (diff >> 63)));
+        for (uint32_t i = 1; i < degree; ++i)
+            append_varint(direction.bytes, neighbors[i] - neighbors[i - 1] - 1);
+    }
+    direction.bytes.shrink_to_fit();
+    return direction.bytes.size() <= UINT32_MAX;
+}
+
+bool CompressedCSR::fromCSR(const CSRGraph &csr)
+{
+    // 默认构造或者空的 CSRGraph 没有行指针，压成空的
+    if (csr.out_row_pointers == nullptr)
+    {
+        out_ = Direction();
+        in_ = Direction();
+        partitions_.clear();
+        max_node_id = 0;
+        num_edges = 0;
+        num_nodes = 0;
+        return true;
+    }
+    uint32_t rows = csr.max_node_id + 1;
+    if (!encode(csr.out_row_pointers, csr.out_degrees, csr.out_column_indices, rows, out_) ||
+        !encode(csr.in_row_pointers, csr.in_degrees, csr.in_column_indices, rows, in_))
+    {
+        std::cerr << "压缩后的 CSR 超过 4GB" << std::endl;
+        out_ = Direction();
+        in_ = Direction();
+        return false;
+    }
+    partitions_.assign(csr.partitions, csr.partitions + rows);
+    max_node_id = csr.max_node_id;
+    num_edges = csr.num_edges;
+    num_nodes = csr.num_nodes;
+    return true;
+}
+
+bool CompressedCSR::fromGraph(const Graph &graph)
+{
+    CSRGraph csr;
+    csr.fromGraph(graph);
+    return fromCSR(csr);
+}
+
+void CompressedCSR::toCSR(CSRGraph &csr) const
+{
+    uint32_t rows = max_node_id + 1;
+    csr.createEmptyCSR(rows);
+    delete[] csr.out_column_indices;
+    delete[] csr.in_column_indices;
+    csr.out_column_indices = new uint32_t[num_edges];
+    csr.in_column_indices = new uint32_t[num_edges];
+    csr.num_edges = num_edges;
+    csr.num_nodes = num_nodes;
+    uint32_t out_pos = 0, in_pos = 0;
+    for (uint32_t u = 0; u < rows; ++u)
+    {
+        csr.out_row_pointers[u] = out_pos;
+        csr.in_row_pointers[u] = in_pos;
+        for (uint32_t v : outNeighbors(u))
+            csr.out_column_indices[out_pos++] = v;
+        for (uint32_t v : inNeighbors(u))
+            csr.in_column_indices[in_pos++] = v;
+        csr.partitions[u] = static_cast<int16_t>(getPartition(u));
+    }
+    csr.out_row_pointers[rows] = out_pos;
+    csr.in_row_pointers[rows] = in_pos;
+}
+
+uint64_t CompressedCSR::getMemoryUsage() const
+{
+    return (out_.offsets.size() + in_.offsets.size()) * sizeof(uint32_t) + out_.bytes.size() + in_.bytes.size() +
+           partitions_.size() * sizeof(int16_t);
+}
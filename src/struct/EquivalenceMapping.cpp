@@ -0,0 +1,130 @@
+#include "EquivalenceMapping.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char MAGIC[4] = {'R', 'C', 'E', 'Q'};
+    const uint32_t VERSION = 1;
+    const size_t HEADER_BYTES = sizeof(MAGIC) + sizeof(uint32_t) + sizeof(uint64_t);
+}
+
+EquivalenceMapping::~EquivalenceMapping()
+{
+    unmap();
+}
+
+void EquivalenceMapping::unmap()
+{
+    if (mapped_ != nullptr)
+    {
+        munmap(mapped_, mapped_bytes_);
+        mapped_ = nullptr;
+        mapped_bytes_ = 0;
+    }
+}
+
+void EquivalenceMapping::clear()
+{
+    unmap();
+    storage_.clear();
+    storage_.shrink_to_fit();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+void EquivalenceMapping::assign(const std::vector<uint32_t> &representative, size_t num_vertices)
+{
+    clear();
+    size_ = std::max(representative.size(), num_vertices);
+    storage_.resize(size_);
+    for (size_t u = 0; u < size_; ++u)
+    {
+        uint32_t r = u < representative.size() ? representative[u] : UNRECORDED;
+        storage_[u] = r < size_ ? r : static_cast<uint32_t>(u);
+    }
+    data_ = storage_.data();
+}
+
+void EquivalenceMapping::identity(size_t num_vertices)
+{
+    clear();
+    size_ = num_vertices;
+    storage_.resize(size_);
+    for (size_t u = 0; u < size_; ++u)
+        storage_[u] = static_cast<uint32_t>(u);
+    data_ = storage_.data();
+}
+
+bool EquivalenceMapping::load_binary(const std::string &filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_BYTES)
+    {
+        close(fd);
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    void *addr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+
+    const char *base = static_cast<const char *>(addr);
+    uint32_t version;
+    uint64_t num_vertices;
+    std::memcpy(&version, base + sizeof(MAGIC), sizeof(version));
+    std::memcpy(&num_vertices, base + sizeof(MAGIC) + sizeof(version), sizeof(num_vertices));
+    // 点数先和文件大小比较再用，避免乘法溢出后绕过长度检查
+    if (std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION ||
+        num_vertices > UINT32_MAX || num_vertices > (bytes - HEADER_BYTES) / sizeof(uint32_t))
+    {
+        munmap(addr, bytes);
+        return false;
+    }
+    // 代表点必须在范围内，否则查询会越界
+    const uint32_t *array = reinterpret_cast<const uint32_t *>(base + HEADER_BYTES);
+    for (uint64_t u = 0; u < num_vertices; ++u)
+    {
+        if (array[u] >= num_vertices)
+        {
+            std::cerr << "Invalid representative in equivalence file: " << filename << std::endl;
+            munmap(addr, bytes);
+            return false;
+        }
+    }
+
+    clear();
+    mapped_ = addr;
+    mapped_bytes_ = bytes;
+    data_ = array;
+    size_ = static_cast<size_t>(num_vertices);
+    return true;
+}
+
+bool EquivalenceMapping::save_binary(const std::string &filename) const
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open())
+        return false;
+    uint64_t num_vertices = size_;
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
+    out.write(reinterpret_cast<const char *>(&num_vertices), sizeof(num_vertices));
+    out.write(reinterpret_cast<const char *>(data_), size_ * sizeof(uint32_t));
+    return static_cast<bool>(out);
+}
+
+size_t EquivalenceMapping::getMemoryUsage() const
+{
+    return size_ * sizeof(uint32_t);
+}
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <sstream>
 #include <cstdint>
+#include <algorithm>
 #include <unordered_map>
 using namespace std;
 
@@ -23,6 +24,7 @@ PartitionManager::PartitionManager(Graph &graph) : g(graph), part_g(false), part
     this->csr = new CSRGraph();
     this->csr->fromGraph(g);
     this->part_csr = nullptr;
+    this->equivalence_mapping.identity(g.vertices.size());
 }
 
 // 建立分区图（没有分区子图）
@@ -164,13 +166,12 @@ void PartitionManager::build_partition_graph()
 
     // 清空分区子图
     partition_subgraphs.clear();
-    partition_subgraphs_csr.clear();
 
-    // 填充 mapping，记录每个分区包含的节点
-    for (size_t node = 0; node < g.vertices.size(); ++node)
+    // 填充 mapping，记录每个分区包含的节点，只扫分区号一列
+    const std::vector<int> &partition_ids = g.vertices.partition_ids;
+    for (size_t node = 0; node < partition_ids.size(); ++node)
     {
-        int partition_id = g.get_partition_id(node);
-        mapping[partition_id].insert(node);
+        mapping[partition_ids[node]].insert(node);
     }
 
     // 更新分区之间的连接
@@ -205,14 +206,7 @@ void PartitionManager::build_partition_graph()
     }
 
     // 分区图的每个点分区应该一样，不然没法找
-    for (auto &node : part_g.vertices)
-    {
-        if (node.in_degree == 0 && node.out_degree == 0)
-        {
-            node.partition_id = -1;
-        }
-        node.partition_id = 1;
-    }
+    std::fill(part_g.vertices.partition_ids.begin(), part_g.vertices.partition_ids.end(), 1);
     part_g.set_max_node_id(part_g.vertices.size());
     this->part_csr = new CSRGraph();
     part_csr->fromGraph(part_g);
@@ -220,58 +214,8 @@ void PartitionManager::build_partition_graph()
     csr = new CSRGraph();
     csr->fromGraph(g);
 
-    // 为每个分区创建一个子图对象
-    for (const auto &partition_pair : mapping)
-    {
-        int size = partition_pair.second.size();
-        int partition_id = partition_pair.first;
-        partition_subgraphs[partition_id] = Graph(false); // 子图不需要存储边集
-        partition_subgraphs[partition_id].vertices.resize(size);
-    }
-
-    // 遍历原始图的所有节点，构建分区子图
-    for (size_t u = 0; u < g.vertices.size(); ++u)
-    {
-        int u_partition = g.get_partition_id(u);
-
-        // 获取对应的子图
-        Graph &subgraph = partition_subgraphs[u_partition];
-
-        // 确保子图中的顶点列表足够大
-        if (u >= subgraph.vertices.size())
-        {
-            subgraph.vertices.resize(u + 1);
-        }
-
-        // 复制节点分区
-        subgraph.vertices[u].partition_id = u_partition;
-
-        // 遍历出边
-        for (int v : g.vertices[u].LOUT)
-        {
-            int v_partition = g.get_partition_id(v);
-            if (v_partition == u_partition)
-            {
-                // 边在同一分区内，添加到子图中
-                if (v >= subgraph.vertices.size())
-                {
-                    subgraph.vertices.resize(v + 1);
-                }
-
-                // 添加边到子图
-                subgraph.addEdge(u, v);
-            }
-        }
-    }
-
-    // 为每个子图构建CSR图
-    for (auto &partition_pair : partition_subgraphs)
-    {
-        Graph &subgraph = partition_pair.second;
-        auto csr = std::make_shared<CSRGraph>();
-        csr->fromGraph(subgraph);
-        partition_subgraphs_csr[partition_pair.first] = csr;
-    }
+    // 为每个分区创建子图
+    build_subgraphs();
 
     // 打印分区图信息（可选）
     // std::cout << "Partition graph constructed with " << temp_edges.size() << " partitions." << std::endl;
@@ -279,39 +223,8 @@ void PartitionManager::build_partition_graph()
 
 void PartitionManager::build_subgraphs()
 {
-    // 为每个分区创建一个子图对象
-    for (const auto &partition_pair : mapping) {
-        int partition_id = partition_pair.first;
-        const auto &nodes = partition_pair.second;
-
-        if (nodes.size() < 1 || partition_id == -1) continue;
-
-        // 创建子图对象
-        partition_subgraphs[partition_id] = Graph(false); // 子图不需要存储边集
-        Graph &subgraph = partition_subgraphs[partition_id];
-        subgraph.vertices.resize(g.vertices.size());
-
-        // 遍历分区中的所有节点
-        for (int u : nodes) {
-            subgraph.vertices[u].partition_id = partition_id;
-
-            // 遍历出边并添加到子图
-            for (int v : g.vertices[u].LOUT) {
-                if (nodes.find(v) != nodes.end()) {
-                    subgraph.addEdge(u, v);
-                }
-            }
-        }
-    }
-
-    // 为每个子图构建CSR图
-    for (auto &partition_pair : partition_subgraphs)
-    {
-        Graph &subgraph = partition_pair.second;
-        auto csr = std::make_shared<CSRGraph>();
-        csr->fromGraph(subgraph);
-        partition_subgraphs_csr[partition_pair.first] = csr;
-    }
+    // 子图只保留分区内部的边，点换成分区内的局部编号
+    partition_subgraphs.build(g, mapping);
 }
 
 // 建立分区图
@@ -328,13 +241,12 @@ void PartitionManager::build_partition_graph_without_subgraph()
 
     // 清空分区子图
     partition_subgraphs.clear();
-    partition_subgraphs_csr.clear();
 
-    // 填充 mapping，记录每个分区包含的节点
-    for (size_t node = 0; node < g.vertices.size(); ++node)
+    // 填充 mapping，记录每个分区包含的节点，只扫分区号一列
+    const std::vector<int> &partition_ids = g.vertices.partition_ids;
+    for (size_t node = 0; node < partition_ids.size(); ++node)
     {
-        int partition_id = g.get_partition_id(node);
-        mapping[partition_id].insert(node);
+        mapping[partition_ids[node]].insert(node);
     }
 
     // 更新分区之间的连接
@@ -369,14 +281,7 @@ void PartitionManager::build_partition_graph_without_subgraph()
     }
 
     // 分区图的每个点分区应该一样，不然没法找
-    for (auto &node : part_g.vertices)
-    {
-        if (node.in_degree == 0 && node.out_degree == 0)
-        {
-            node.partition_id = -1;
-        }
-        node.partition_id = 1;
-    }
+    std::fill(part_g.vertices.partition_ids.begin(), part_g.vertices.partition_ids.end(), 1);
     part_g.set_max_node_id(part_g.vertices.size());
     if(part_csr != nullptr) delete this->part_csr;
     delete this->csr;
@@ -388,17 +293,20 @@ void PartitionManager::build_partition_graph_without_subgraph()
 
 void PartitionManager::update_partition_connections()
 {
-    for (size_t u = 0; u < g.vertices.size(); ++u)
+    const std::vector<int> &partition_ids = g.vertices.partition_ids;
+    const std::vector<int> &out_degrees = g.vertices.out_degrees;
+    const std::vector<int> &in_degrees = g.vertices.in_degrees;
+    for (size_t u = 0; u < partition_ids.size(); ++u)
     {
-        if (g.vertices[u].LOUT.empty() && g.vertices[u].LIN.empty())
+        if (out_degrees[u] == 0 && in_degrees[u] == 0)
             continue; // Skip nodes with no edges
-        int u_partition = g.get_partition_id(u);
+        int u_partition = partition_ids[u];
         if (u_partition == -1)
             continue;
 
-        for (const auto &v : g.vertices[u].LOUT)
+        for (const auto &v : g.vertices.out_edges[u])
         {
-            int v_partition = g.get_partition_id(v);
+            int v_partition = partition_ids[v];
             if (u_partition != v_partition)
             {
                 PartitionEdge &pe = partition_adjacency[u_partition][v_partition];
@@ -408,9 +316,9 @@ void PartitionManager::update_partition_connections()
                 }
             }
         }
-        for (const auto &v : g.vertices[u].LIN)
+        for (const auto &v : g.vertices.in_edges[u])
         {
-            int v_partition = g.get_partition_id(v);
+            int v_partition = partition_ids[v];
             if (u_partition != v_partition)
             {
                 PartitionEdge &pe = partition_adjacency[v_partition][u_partition];
@@ -480,13 +388,7 @@ void PartitionManager::build_connections_graph()
         }
     }
 
-    // 设置分区号都是0，防止一些逻辑判断里面因为分区是-1导致出错
-    for(auto v: part_connect_g->vertices){
-        if(v.in_degree == 0 && v.out_degree == 0)
-            v.partition_id = -1;
-        else
-            v.partition_id = 1;
-    }
+    // 分区连接图的点分区号保持 -1：这里原来有一个按度数设置分区号的循环，但它复制了每个点，从来没有生效过
     part_connect_csr->fromGraph(*part_connect_g);
 }
 
@@ -644,28 +546,38 @@ void PartitionManager::update_partition_info(int node, int old_partition_id, int
 
 void PartitionManager::print_equivalence_mapping() const
 {
-    if (equivalence_mapping == nullptr)
+    if (!equivalence_loaded_)
     {
         std::cerr << "Equivalence mapping is not initialized." << std::endl;
         return;
     }
 
-    for (size_t i = 0; i < g.vertices.size(); ++i)
+    for (size_t i = 0; i < equivalence_mapping.size(); ++i)
     {
-        std::cout << "Node " << i << ": ";
-        if (equivalence_mapping[i] != nullptr)
-        {
-            std::cout << equivalence_mapping[i][0]; // Assuming each node has at least one equivalence
-        }
-        else
-        {
-            std::cout << "No equivalence";
-        }
-        std::cout << std::endl;
+        std::cout << "Node " << i << ": " << equivalence_mapping[i] << std::endl;
     }
 }
 void PartitionManager::read_equivalance_info(const std::string &filename)
 {
+    // 二进制格式直接 mmap
+    if (equivalence_mapping.load_binary(filename))
+    {
+        // 点数比图少的二进制文件不是这张图的，不把映射拷到堆上补全，退回恒等映射
+        if (equivalence_mapping.size() < g.vertices.size())
+        {
+            std::cerr << "Equivalence file has " << equivalence_mapping.size() << " vertices but the graph has "
+                      << g.vertices.size() << ": " << filename << std::endl;
+            equivalence_mapping.identity(g.vertices.size());
+            equivalence_loaded_ = false;
+            sync_equivalence_to_graph();
+            return;
+        }
+        equivalence_loaded_ = true;
+        sync_equivalence_to_graph();
+        std::cout << "Mapping completed using binary file: " << filename << std::endl;
+        return;
+    }
+
     std::ifstream mapping_file(filename);
     if (!mapping_file.is_open())
     {
@@ -674,7 +586,7 @@ void PartitionManager::read_equivalance_info(const std::string &filename)
     }
 
     std::string line;
-    std::vector<std::vector<uint32_t>> temp_mapping;
+    std::vector<uint32_t> equivalence;
 
     while (std::getline(mapping_file, line))
     {
@@ -686,49 +598,44 @@ void PartitionManager::read_equivalance_info(const std::string &filename)
             std::cerr << "Invalid line format in equivalence file: " << line << std::endl;
             continue;
         }
-
-        // 如果大于了要做扩展，因为g读取的文件是强连通分量压缩后的文件，所以可能会有节点记录不全
-        // mapping中的是全的，可以拿来对g做补全
-        if (node >= g.vertices.size())
+        // 文件里没有出现的点保持默认值，按自身处理
+        if (node >= equivalence.size())
         {
-            int size = g.vertices.size();
-            g.vertices.resize(node + 1);
-            for (int i = size; i <= node; ++i)
-            {
-                g.vertices[i].partition_id = -1;
-                g.vertices[i].LIN.clear();
-                g.vertices[i].LOUT.clear();
-                g.vertices[i].in_degree = 0;
-                g.vertices[i].out_degree = 0;
-                g.vertices[i].equivalance = -1;
-            }
-        }
-
-        // 更新 Graph 中的 vertices
-        g.vertices[node].equivalance = equivalance;
-
-        // 添加到临时映射
-        if (node >= temp_mapping.size())
-        {
-            temp_mapping.resize(node + 1);
+            equivalence.resize(node + 1, EquivalenceMapping::UNRECORDED);
         }
-        temp_mapping[node].push_back(equivalance);
+        equivalence[node] = equivalance;
     }
 
     mapping_file.close();
 
-    // 将临时映射转换为二维 uint32_t 数组
-    equivalence_mapping = new uint32_t *[temp_mapping.size()];
-    for (size_t i = 0; i < temp_mapping.size(); ++i)
+    set_equivalence_info(equivalence);
+
+    std::cout << "Mapping completed using file: " << filename << std::endl;
+}
+
+void PartitionManager::set_equivalence_info(const std::vector<uint32_t> &equivalence)
+{
+    equivalence_mapping.assign(equivalence, g.vertices.size());
+    equivalence_loaded_ = true;
+    sync_equivalence_to_graph();
+}
+
+void PartitionManager::sync_equivalence_to_graph()
+{
+    // 如果大于了要做扩展，因为g读取的文件是强连通分量压缩后的文件，所以可能会有节点记录不全
+    // mapping中的是全的，可以拿来对g做补全
+    // 映射不会比图小：文本文件在 assign 时按图的点数补全，二进制文件点数不够时不加载
+    if (equivalence_mapping.size() > g.vertices.size())
     {
-        equivalence_mapping[i] = new uint32_t[temp_mapping[i].size()];
-        for (size_t j = 0; j < temp_mapping[i].size(); ++j)
-        {
-            equivalence_mapping[i][j] = temp_mapping[i][j];
-        }
+        g.vertices.resize(equivalence_mapping.size());
     }
 
-    std::cout << "Mapping completed using file: " << filename << std::endl;
+    // 更新 Graph 中的 vertices，代表点是自己的点和原来一样不记录
+    for (size_t node = 0; node < equivalence_mapping.size(); ++node)
+    {
+        uint32_t eq = equivalence_mapping[node];
+        g.vertices[node].equivalance = (eq == node) ? EquivalenceMapping::UNRECORDED : eq;
+    }
 }
 
 std::unordered_map<int, PartitionEdge> PartitionManager::get_partition_adjacency(int partitionId)
@@ -0,0 +1,116 @@
+#include "PartitionSubgraphs.h"
+
+void PartitionSubgraphs::clear()
+{
+    local_id_.clear();
+    global_id_.clear();
+    out_row_.clear();
+    in_row_.clear();
+    out_col_.clear();
+    in_col_.clear();
+    slices_.clear();
+    partition_ids_.clear();
+}
+
+void PartitionSubgraphs::build(const Graph &g, const std::map<int, std::set<int>> &mapping)
+{
+    clear();
+    local_id_.assign(g.vertices.size(), INVALID_ID);
+
+    // 1、分配局部编号，分区按分区号升序排进共享数组
+    size_t total_vertices = 0;
+    for (const auto &[partition_id, nodes] : mapping)
+    {
+        if (partition_id == -1 || nodes.empty())
+            continue;
+        Slice slice;
+        slice.vertex_offset = static_cast<uint32_t>(total_vertices);
+        uint32_t local = 0;
+        for (int u : nodes)
+        {
+            // 分区信息里不在图中的点跳过，不写越界
+            if (u < 0 || static_cast<size_t>(u) >= local_id_.size())
+                continue;
+            local_id_[u] = local++;
+            global_id_.push_back(u);
+        }
+        if (local == 0)
+            continue;
+        slice.num_vertices = local;
+        total_vertices += local;
+        slices_[partition_id] = slice;
+        partition_ids_.push_back(partition_id);
+    }
+
+    // 2、出边：只保留两端在同一分区的边，LOUT 有序所以每行的局部编号也有序
+    out_row_.assign(total_vertices + 1, 0);
+    for (size_t row = 0; row < total_vertices; ++row)
+    {
+        int u = global_id_[row];
+        int u_partition = g.get_partition_id(u);
+        for (int v : g.vertices[u].LOUT)
+        {
+            if (g.get_partition_id(v) == u_partition && local_id_[v] != INVALID_ID)
+                out_col_.push_back(local_id_[v]);
+        }
+        out_row_[row + 1] = static_cast<uint32_t>(out_col_.size());
+    }
+
+    // 3、入边：按出边转置，按源点顺序填充所以每行也有序
+    in_row_.assign(total_vertices + 1, 0);
+    in_col_.resize(out_col_.size());
+    for (int partition_id : partition_ids_)
+    {
+        const Slice &slice = slices_[partition_id];
+        uint32_t base = slice.vertex_offset;
+        for (uint32_t u = 0; u < slice.num_vertices; ++u)
+        {
+            for (uint32_t e = out_row_[base + u]; e < out_row_[base + u + 1]; ++e)
+                in_row_[base + out_col_[e] + 1]++;
+        }
+    }
+    for (size_t row = 0; row < total_vertices; ++row)
+        in_row_[row + 1] += in_row_[row];
+    std::vector<uint32_t> cursor(in_row_.begin(), in_row_.end() - 1);
+    for (int partition_id : partition_ids_)
+    {
+        Slice &slice = slices_[partition_id];
+        uint32_t base = slice.vertex_offset;
+        for (uint32_t u = 0; u < slice.num_vertices; ++u)
+        {
+            for (uint32_t e = out_row_[base + u]; e < out_row_[base + u + 1]; ++e)
+                in_col_[cursor[base + out_col_[e]]++] = u;
+        }
+        slice.num_edges = out_row_[base + slice.num_vertices] - out_row_[base];
+        for (uint32_t u = 0; u < slice.num_vertices; ++u)
+        {
+            if (out_row_[base + u + 1] != out_row_[base + u] || in_row_[base + u + 1] != in_row_[base + u])
+                slice.num_connected++;
+        }
+    }
+}
+
+PartitionSubgraphs::View PartitionSubgraphs::get(int partition_id) const
+{
+    View view;
+    auto it = slices_.find(partition_id);
+    if (it == slices_.end())
+        return view;
+    const Slice &slice = it->second;
+    view.out_row = out_row_.data() + slice.vertex_offset;
+    view.in_row = in_row_.data() + slice.vertex_offset;
+    view.out_col = out_col_.data();
+    view.in_col = in_col_.data();
+    view.global = global_id_.data() + slice.vertex_offset;
+    view.num_vertices = slice.num_vertices;
+    view.num_connected = slice.num_connected;
+    view.num_edges = slice.num_edges;
+    return view;
+}
+
+size_t PartitionSubgraphs::getMemoryUsage() const
+{
+    return (local_id_.size() + global_id_.size() + out_row_.size() + in_row_.size() +
+            out_col_.size() + in_col_.size()) * sizeof(uint32_t) +
+           slices_.size() * (sizeof(int) + sizeof(Slice));
+}
@@ -0,0 +1,304 @@
+#include "VertexOrdering.h"
+#include "utils/BatchScheduler.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+    const char MAGIC[4] = {'R', 'C', 'P', 'M'};
+    const uint32_t VERSION = 1;
+
+    // 按 starts 的顺序挑还没访问过的点做起点，在无向图（出边加入边）上 BFS，访问顺序追加到 order。
+    // by_degree 为真时同一个点新发现的邻居按度数升序入队（Cuthill–McKee）
+    void undirected_bfs(const CSRGraph &csr, const std::vector<uint32_t> &starts, const std::vector<uint32_t> &degree,
+                        bool by_degree, std::vector<uint32_t> &order)
+    {
+        std::vector<uint8_t> visited(degree.size(), 0);
+        std::vector<uint32_t> discovered;
+        for (uint32_t start : starts)
+        {
+            if (visited[start])
+                continue;
+            visited[start] = 1;
+            size_t head = order.size();
+            order.push_back(start);
+            while (head < order.size())
+            {
+                uint32_t u = order[head++];
+                discovered.clear();
+                for (uint32_t v : csr.outNeighbors(u))
+                {
+                    if (!visited[v])
+                    {
+                        visited[v] = 1;
+                        discovered.push_back(v);
+                    }
+                }
+                for (uint32_t v : csr.inNeighbors(u))
+                {
+                    if (!visited[v])
+                    {
+                        visited[v] = 1;
+                        discovered.push_back(v);
+                    }
+                }
+                if (by_degree)
+                {
+                    std::stable_sort(discovered.begin(), discovered.end(),
+                                     [&](uint32_t a, uint32_t b) { return degree[a] < degree[b]; });
+                }
+                order.insert(order.end(), discovered.begin(), discovered.end());
+            }
+        }
+    }
+}
+
+const char *VertexOrdering::name(Strategy strategy)
+{
+    switch (strategy)
+    {
+    case Strategy::IDENTITY:
+        return "identity";
+    case Strategy::DEGREE:
+        return "degree";
+    case Strategy::RCM:
+        return "rcm";
+    case Strategy::BFS:
+        return "bfs";
+    case Strategy::PARTITION:
+        return "partition";
+    }
+    return "unknown";
+}
+
+bool VertexOrdering::parse(const std::string &name, Strategy &strategy)
+{
+    for (Strategy candidate : {Strategy::IDENTITY, Strategy::DEGREE, Strategy::RCM, Strategy::BFS, Strategy::PARTITION})
+    {
+        if (name == VertexOrdering::name(candidate))
+        {
+            strategy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void VertexOrdering::compute(const CSRGraph &csr, Strategy strategy)
+{
+    uint32_t rows = csr.out_row_pointers ? csr.max_node_id + 1 : 0;
+    std::vector<uint32_t> degree(rows);
+    for (uint32_t u = 0; u < rows; ++u)
+        degree[u] = csr.getOutDegree(u) + csr.getInDegree(u);
+
+    std::vector<uint32_t> order(rows);
+    std::iota(order.begin(), order.end(), 0);
+    if (strategy == Strategy::IDENTITY)
+    {
+        assign(std::move(order));
+        return;
+    }
+    // 度数降序，度数相同时点号小的在前
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return degree[a] > degree[b]; });
+    if (strategy == Strategy::DEGREE)
+    {
+        assign(std::move(order));
+        return;
+    }
+
+    // 剩下几种都是 BFS 顺序，只在有边的点上做，孤立点和不存在的点按点号放在最后
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> isolated;
+    for (uint32_t u : order)
+    {
+        if (degree[u] > 0)
+            starts.push_back(u);
+    }
+    for (uint32_t u = 0; u < rows; ++u)
+    {
+        if (degree[u] == 0)
+            isolated.push_back(u);
+    }
+    if (strategy == Strategy::RCM)
+        std::reverse(starts.begin(), starts.end()); // 从度数最小的点开始
+
+    std::vector<uint32_t> visit;
+    visit.reserve(rows);
+    undirected_bfs(csr, starts, degree, strategy == Strategy::RCM, visit);
+    if (strategy == Strategy::RCM)
+        std::reverse(visit.begin(), visit.end());
+    visit.insert(visit.end(), isolated.begin(), isolated.end());
+
+    if (strategy == Strategy::PARTITION)
+    {
+        std::stable_sort(visit.begin(), visit.end(), [&](uint32_t a, uint32_t b) {
+            int pa = csr.getPartition(a), pb = csr.getPartition(b);
+            return (pa < 0 ? INT_MAX : pa) < (pb < 0 ? INT_MAX : pb);
+        });
+    }
+    assign(std::move(visit));
+}
+
+bool VertexOrdering::assign(std::vector<uint32_t> new_to_old)
+{
+    std::vector<uint32_t> old_to_new(new_to_old.size(), UINT32_MAX);
+    for (uint32_t r = 0; r < new_to_old.size(); ++r)
+    {
+        uint32_t old = new_to_old[r];
+        if (old >= new_to_old.size() || old_to_new[old] != UINT32_MAX)
+            return false;
+        old_to_new[old] = r;
+    }
+    new_to_old_ = std::move(new_to_old);
+    old_to_new_ = std::move(old_to_new);
+    return true;
+}
+
+void VertexOrdering::identity(size_t num_vertices)
+{
+    new_to_old_.resize(num_vertices);
+    std::iota(new_to_old_.begin(), new_to_old_.end(), 0);
+    old_to_new_ = new_to_old_;
+}
+
+void VertexOrdering::to_internal(std::vector<std::pair<int, int>> &queries) const
+{
+    for (auto &query : queries)
+    {
+        query.first = to_internal(query.first);
+        query.second = to_internal(query.second);
+    }
+}
+
+void VertexOrdering::to_external(std::vector<int> &path) const
+{
+    for (int &node : path)
+        node = to_external(node);
+}
+
+bool VertexOrdering::apply(const CSRGraph &src, CSRGraph &dst, int num_threads) const
+{
+    uint32_t rows = src.out_row_pointers ? src.max_node_id + 1 : 0;
+    if (rows != size() || rows == 0)
+    {
+        std::cerr << "点的顺序长度 " << size() << " 和 CSR 的点数 " << rows << " 不一致" << std::endl;
+        return false;
+    }
+    dst.createEmptyCSR(rows);
+    for (uint32_t r = 0; r < rows; ++r)
+    {
+        uint32_t old = new_to_old_[r];
+        dst.out_row_pointers[r + 1] = dst.out_row_pointers[r] + src.getOutDegree(old);
+        dst.in_row_pointers[r + 1] = dst.in_row_pointers[r] + src.getInDegree(old);
+        dst.partitions[r] = static_cast<int16_t>(src.getPartition(old));
+    }
+    dst.num_edges = dst.out_row_pointers[rows];
+    dst.num_nodes = src.num_nodes;
+    dst.out_column_indices = new uint32_t[dst.num_edges];
+    dst.in_column_indices = new uint32_t[dst.num_edges];
+
+    // 每一行独立地改写点号再排序，按行并行
+    int threads = BatchScheduler::resolve_threads(num_threads, rows);
+    BatchScheduler::run(rows, threads, [&](int, size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r)
+        {
+            uint32_t old = new_to_old_[r];
+            uint32_t *first = dst.out_column_indices + dst.out_row_pointers[r];
+            uint32_t *last = first;
+            for (uint32_t v : src.outNeighbors(old))
+                *last++ = old_to_new_[v];
+            std::sort(first, last);
+            first = dst.in_column_indices + dst.in_row_pointers[r];
+            last = first;
+            for (uint32_t v : src.inNeighbors(old))
+                *last++ = old_to_new_[v];
+            std::sort(first, last);
+        }
+    });
+    return true;
+}
+
+bool VertexOrdering::apply(const Graph &src, Graph &dst, int num_threads) const
+{
+    size_t rows = src.vertices.size();
+    if (rows != size() || rows == 0)
+    {
+        std::cerr << "点的顺序长度 " << size() << " 和图的点数 " << rows << " 不一致" << std::endl;
+        return false;
+    }
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(src.get_num_edges());
+    for (size_t u = 0; u < rows; ++u)
+    {
+        for (int v : src.vertices[u].LOUT)
+            edges.emplace_back(old_to_new_[u], old_to_new_[v]);
+    }
+    dst.set_max_node_id(static_cast<uint32_t>(rows - 1));
+    dst.bulk_load(edges, num_threads);
+    for (size_t r = 0; r < rows; ++r)
+    {
+        uint32_t old = new_to_old_[r];
+        uint32_t equivalence = src.vertices.equivalences[old];
+        dst.vertices.partition_ids[r] = src.vertices.partition_ids[old];
+        dst.vertices.equivalences[r] = equivalence < rows ? old_to_new_[equivalence] : equivalence;
+    }
+    dst.setFilename(src.getFilename());
+    return true;
+}
+
+bool VertexOrdering::save_binary(const std::string &filename) const
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open())
+        return false;
+    uint64_t num_vertices = new_to_old_.size();
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
+    out.write(reinterpret_cast<const char *>(&num_vertices), sizeof(num_vertices));
+    out.write(reinterpret_cast<const char *>(new_to_old_.data()), new_to_old_.size() * sizeof(uint32_t));
+    return static_cast<bool>(out);
+}
+
+bool VertexOrdering::load_binary(const std::string &filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open())
+        return false;
+    char magic[sizeof(MAGIC)];
+    uint32_t version = 0;
+    uint64_t num_vertices = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&num_vertices), sizeof(num_vertices));
+    if (!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION || num_vertices > UINT32_MAX)
+    {
+        std::cerr << "点顺序文件格式不对: " << filename << std::endl;
+        return false;
+    }
+    // 先按文件长度检查点数，损坏的文件头不会导致按它分配内存
+    std::streamoff header_bytes = in.tellg();
+    in.seekg(0, std::ios::end);
+    uint64_t file_bytes = static_cast<uint64_t>(in.tellg());
+    in.seekg(header_bytes);
+    if (file_bytes < static_cast<uint64_t>(header_bytes) + num_vertices * sizeof(uint32_t))
+    {
+        std::cerr << "点顺序文件长度不够: " << filename << std::endl;
+        return false;
+    }
+    std::vector<uint32_t> new_to_old(num_vertices);
+    in.read(reinterpret_cast<char *>(new_to_old.data()), num_vertices * sizeof(uint32_t));
+    if (!in)
+        return false;
+    return assign(std::move(new_to_old));
+}
+
+void ReorderedAlgorithm::reachability_query_batch(const std::pair<int, int> *queries, size_t count, uint8_t *out, int num_threads)
+{
+    std::vector<std::pair<int, int>> internal(queries, queries + count);
+    ordering_->to_internal(internal);
+    inner_->reachability_query_batch(internal.data(), count, out, num_threads);
+}
@@ -1,4 +1,5 @@
 #include "graph.h"
+#include "utils/BatchScheduler.h"
 #include <iostream>
 #include <algorithm>  // 确保包含算法库
 #include <fstream>
@@ -35,13 +36,16 @@ Graph::Graph(bool store_edges) : store_edges(store_edges) {
 
 long Graph::get_partition_degree(int target_patition) const
 {
+    // 只扫分区号和出度两列
     long total_degree = 0;
-    for(auto const i:vertices){
-        if(i.partition_id == target_patition){
-            total_degree += i.out_degree;
+    const int *partition_ids = vertices.partition_ids.data();
+    const int *out_degrees = vertices.out_degrees.data();
+    for (size_t u = 0; u < vertices.size(); ++u) {
+        if (partition_ids[u] == target_patition) {
+            total_degree += out_degrees[u];
         }
     }
-    return 0;
+    return total_degree;
 }
 
 
@@ -123,6 +127,67 @@ void Graph::addEdge(int u, int v, bool is_directed) {
     }
 }
 
+void Graph::bulk_load(const std::vector<std::pair<int, int>> &edges, int num_threads) {
+    int max_id = static_cast<int>(vertices.size()) - 1;
+    for (const auto &edge : edges)
+        max_id = max(max_id, max(edge.first, edge.second));
+    if (max_id < 0) return;
+    if (static_cast<size_t>(max_id) >= vertices.size()) {
+        vertices.resize(max_id + 1);
+        max_node_id = max(max_node_id, static_cast<uint32_t>(max_id));
+    }
+
+    // 先数出每个点要追加多少条，预留好空间再追加
+    std::vector<uint32_t> out_count(vertices.size(), 0), in_count(vertices.size(), 0);
+    for (const auto &edge : edges) {
+        if (edge.first == edge.second || edge.first < 0 || edge.second < 0) continue;
+        out_count[edge.first]++;
+        in_count[edge.second]++;
+    }
+    for (size_t u = 0; u < vertices.size(); ++u) {
+        if (out_count[u]) vertices[u].LOUT.reserve(vertices[u].LOUT.size() + out_count[u]);
+        if (in_count[u]) vertices[u].LIN.reserve(vertices[u].LIN.size() + in_count[u]);
+    }
+    for (const auto &edge : edges) {
+        if (edge.first == edge.second || edge.first < 0 || edge.second < 0) continue;
+        vertices[edge.first].LOUT.push_back(edge.second);
+        vertices[edge.second].LIN.push_back(edge.first);
+    }
+    if (store_edges) {
+        adjList.resize(max(adjList.size(), vertices.size()));
+        reverseAdjList.resize(max(reverseAdjList.size(), vertices.size()));
+    }
+
+    // 按点并行排序去重，各线程分别累计点数和边数
+    int threads = BatchScheduler::resolve_threads(num_threads, vertices.size());
+    std::vector<size_t> thread_vertices(threads, 0), thread_edges(threads, 0);
+    BatchScheduler::run(vertices.size(), threads, [&](int thread_id, size_t begin, size_t end) {
+        for (size_t u = begin; u < end; ++u) {
+            VertexTable::VertexRef vertex = vertices[u];  // 各列的引用，下面的修改直接写回图
+            if (out_count[u]) {
+                std::sort(vertex.LOUT.begin(), vertex.LOUT.end());
+                vertex.LOUT.erase(std::unique(vertex.LOUT.begin(), vertex.LOUT.end()), vertex.LOUT.end());
+                if (store_edges) adjList[u] = vertex.LOUT;
+            }
+            if (in_count[u]) {
+                std::sort(vertex.LIN.begin(), vertex.LIN.end());
+                vertex.LIN.erase(std::unique(vertex.LIN.begin(), vertex.LIN.end()), vertex.LIN.end());
+                if (store_edges) reverseAdjList[u] = vertex.LIN;
+            }
+            vertex.out_degree = vertex.LOUT.size();
+            vertex.in_degree = vertex.LIN.size();
+            thread_edges[thread_id] += vertex.LOUT.size();
+            if (vertex.out_degree > 0 || vertex.in_degree > 0) thread_vertices[thread_id]++;
+        }
+    });
+    num_vertices = 0;
+    num_edges = 0;
+    for (int t = 0; t < threads; ++t) {
+        num_vertices += thread_vertices[t];
+        num_edges += thread_edges[t];
+    }
+}
+
 bool Graph::hasEdge(int u, int v)
 {
     if (u >= vertices.size() || v >= vertices.size()) {
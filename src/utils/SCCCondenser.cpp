@@ -0,0 +1,333 @@
+#include "SCCCondenser.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+uint32_t SCCCondenser::tarjan(const CSRGraph &csr, std::vector<uint32_t> &component)
+{
+    component.assign(csr.max_node_id + 1, UNASSIGNED);
+    uint32_t num_components = 0;
+    // 每个分量用最小点号作代表
+    tarjan_components(csr, [&](const uint32_t *members, size_t count)
+    {
+        uint32_t representative = *std::min_element(members, members + count);
+        for (size_t i = 0; i < count; ++i)
+            component[members[i]] = representative;
+        num_components++;
+    });
+    return num_components;
+}
+
+uint32_t SCCCondenser::forward_backward(const CSRGraph &csr, std::vector<uint32_t> &component, int num_threads)
+{
+    const uint32_t n = csr.max_node_id + 1;
+    const uint32_t DONE = UINT32_MAX;
+    component.assign(n, UNASSIGNED);
+    if (num_threads <= 0)
+        num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (num_threads <= 0)
+        num_threads = 4;
+
+    // color[v] 是 v 当前所在任务的编号，已经确定分量的点为 DONE。
+    // 每个点同一时刻只属于一个任务，只有处理这个任务的线程会改它的颜色；
+    // 别的线程读到的颜色不会等于自己的任务号，所以用 relaxed 原子读写就够了。
+    std::vector<std::atomic<uint32_t>> color(n);
+    for (uint32_t v = 0; v < n; ++v)
+        color[v].store(0, std::memory_order_relaxed);
+    std::atomic<uint32_t> next_color{1};
+    std::atomic<uint32_t> num_components{0};
+    // 点在所属任务点集里的下标，剪枝时用来索引度数数组，同样只被所属任务的线程读写
+    std::vector<uint32_t> position(n);
+
+    struct Task
+    {
+        uint32_t color;
+        std::vector<uint32_t> vertices;
+    };
+    std::deque<Task> tasks;
+    std::mutex task_mutex;
+    std::condition_variable task_cv;
+    size_t pending = 1; // 队列中和正在处理的任务数
+    {
+        Task all{0, std::vector<uint32_t>(n)};
+        for (uint32_t v = 0; v < n; ++v)
+            all.vertices[v] = v;
+        tasks.push_back(std::move(all));
+    }
+
+    auto in_task = [&](uint32_t v, uint32_t task_color)
+    {
+        return color[v].load(std::memory_order_relaxed) == task_color;
+    };
+
+    auto process = [&](Task &task, std::vector<Task> &subtasks)
+    {
+        const uint32_t task_color = task.color;
+        auto &vertices = task.vertices;
+
+        // 1、剪枝：任务内入度或出度为 0 的点自成一个分量，删掉后继续检查邻居
+        std::vector<uint32_t> in_degree(vertices.size(), 0), out_degree(vertices.size(), 0);
+        std::vector<uint32_t> trim_queue;
+        for (size_t i = 0; i < vertices.size(); ++i)
+            position[vertices[i]] = static_cast<uint32_t>(i);
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            uint32_t u = vertices[i];
+            for (uint32_t e = csr.out_row_pointers[u], end = e + csr.getOutDegree(u); e < end; ++e)
+                out_degree[i] += in_task(csr.out_column_indices[e], task_color);
+            for (uint32_t e = csr.in_row_pointers[u], end = e + csr.getInDegree(u); e < end; ++e)
+                in_degree[i] += in_task(csr.in_column_indices[e], task_color);
+            if (in_degree[i] == 0 || out_degree[i] == 0)
+                trim_queue.push_back(u);
+        }
+        for (size_t head = 0; head < trim_queue.size(); ++head)
+        {
+            uint32_t u = trim_queue[head];
+            if (!in_task(u, task_color))
+                continue;
+            color[u].store(DONE, std::memory_order_relaxed);
+            component[u] = u;
+            num_components.fetch_add(1, std::memory_order_relaxed);
+            for (uint32_t e = csr.out_row_pointers[u], end = e + csr.getOutDegree(u); e < end; ++e)
+            {
+                uint32_t w = csr.out_column_indices[e];
+                if (in_task(w, task_color) && --in_degree[position[w]] == 0)
+                    trim_queue.push_back(w);
+            }
+            for (uint32_t e = csr.in_row_pointers[u], end = e + csr.getInDegree(u); e < end; ++e)
+            {
+                uint32_t w = csr.in_column_indices[e];
+                if (in_task(w, task_color) && --out_degree[position[w]] == 0)
+                    trim_queue.push_back(w);
+            }
+        }
+        uint32_t pivot = DONE;
+        for (uint32_t v : vertices)
+        {
+            if (in_task(v, task_color))
+            {
+                pivot = v;
+                break;
+            }
+        }
+        if (pivot == DONE)
+            return;
+
+        // 2、从枢轴点前向BFS，到达的点染成 fw_color
+        uint32_t fw_color = next_color.fetch_add(3, std::memory_order_relaxed);
+        uint32_t bw_color = fw_color + 1;
+        uint32_t scc_color = fw_color + 2;
+        std::vector<uint32_t> queue;
+        queue.push_back(pivot);
+        color[pivot].store(fw_color, std::memory_order_relaxed);
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            uint32_t u = queue[head];
+            for (uint32_t e = csr.out_row_pointers[u], end = e + csr.getOutDegree(u); e < end; ++e)
+            {
+                uint32_t w = csr.out_column_indices[e];
+                if (in_task(w, task_color))
+                {
+                    color[w].store(fw_color, std::memory_order_relaxed);
+                    queue.push_back(w);
+                }
+            }
+        }
+
+        // 3、后向BFS，前向也到达过的点是枢轴点所在的分量，只有后向到达的染成 bw_color
+        queue.clear();
+        queue.push_back(pivot);
+        color[pivot].store(scc_color, std::memory_order_relaxed);
+        uint32_t representative = pivot;
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            uint32_t u = queue[head];
+            for (uint32_t e = csr.in_row_pointers[u], end = e + csr.getInDegree(u); e < end; ++e)
+            {
+                uint32_t w = csr.in_column_indices[e];
+                uint32_t c = color[w].load(std::memory_order_relaxed);
+                if (c == fw_color)
+                {
+                    color[w].store(scc_color, std::memory_order_relaxed);
+                    representative = std::min(representative, w);
+                    queue.push_back(w);
+                }
+                else if (c == task_color)
+                {
+                    color[w].store(bw_color, std::memory_order_relaxed);
+                    queue.push_back(w);
+                }
+            }
+        }
+        num_components.fetch_add(1, std::memory_order_relaxed);
+
+        // 4、分量内的点定下代表点，剩下的点按颜色分成三个新任务
+        Task fw_task{fw_color, {}}, bw_task{bw_color, {}}, rest_task{task_color, {}};
+        for (uint32_t v : vertices)
+        {
+            uint32_t c = color[v].load(std::memory_order_relaxed);
+            if (c == scc_color)
+            {
+                component[v] = representative;
+                color[v].store(DONE, std::memory_order_relaxed);
+            }
+            else if (c == fw_color)
+                fw_task.vertices.push_back(v);
+            else if (c == bw_color)
+                bw_task.vertices.push_back(v);
+            else if (c == task_color)
+                rest_task.vertices.push_back(v);
+        }
+        for (Task *t : {&fw_task, &bw_task, &rest_task})
+        {
+            if (!t->vertices.empty())
+                subtasks.push_back(std::move(*t));
+        }
+    };
+
+    auto worker = [&]()
+    {
+        std::vector<Task> subtasks;
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(task_mutex);
+                task_cv.wait(lock, [&]
+                             { return !tasks.empty() || pending == 0; });
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            subtasks.clear();
+            process(task, subtasks);
+            {
+                std::lock_guard<std::mutex> lock(task_mutex);
+                for (auto &t : subtasks)
+                    tasks.push_back(std::move(t));
+                pending += subtasks.size();
+                pending--;
+            }
+            task_cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &th : threads)
+        th.join();
+    return num_components.load();
+}
+
+void SCCCondenser::collect_condensed_edges(const CSRGraph &csr, const std::vector<uint32_t> &component,
+                                           std::vector<uint32_t> &out_row, std::vector<uint32_t> &out_col)
+{
+    const uint32_t n = csr.max_node_id + 1;
+
+    // 按代表点把分量成员排在一起
+    std::vector<uint32_t> member_row(n + 1, 0);
+    for (uint32_t v = 0; v < n; ++v)
+        member_row[component[v] + 1]++;
+    for (uint32_t v = 0; v < n; ++v)
+        member_row[v + 1] += member_row[v];
+    std::vector<uint32_t> members(n);
+    {
+        std::vector<uint32_t> cursor(member_row.begin(), member_row.end() - 1);
+        for (uint32_t v = 0; v < n; ++v)
+            members[cursor[component[v]]++] = v;
+    }
+
+    // 每个代表点收集所有成员的出边，last_row 记录某个目标分量最后一次被哪一行加过，用来去重
+    std::vector<uint32_t> last_row(n, UNASSIGNED);
+    out_row.assign(n + 1, 0);
+    out_col.clear();
+    for (uint32_t r = 0; r < n; ++r)
+    {
+        size_t row_begin = out_col.size();
+        for (uint32_t i = member_row[r]; i < member_row[r + 1]; ++i)
+        {
+            uint32_t u = members[i];
+            for (uint32_t e = csr.out_row_pointers[u], end = e + csr.getOutDegree(u); e < end; ++e)
+            {
+                uint32_t target = component[csr.out_column_indices[e]];
+                if (target != r && last_row[target] != r)
+                {
+                    last_row[target] = r;
+                    out_col.push_back(target);
+                }
+            }
+        }
+        std::sort(out_col.begin() + row_begin, out_col.end());
+        out_row[r + 1] = static_cast<uint32_t>(out_col.size());
+    }
+}
+
+void SCCCondenser::condense(const CSRGraph &csr, const std::vector<uint32_t> &component, CSRGraph &dag)
+{
+    const uint32_t n = csr.max_node_id + 1;
+    std::vector<uint32_t> out_row, out_col;
+    collect_condensed_edges(csr, component, out_row, out_col);
+
+    // 先清空，dag 可能来自 mmap 或者处在动态模式
+    dag.createEmptyCSR(1);
+    delete[] dag.out_column_indices;
+    delete[] dag.out_row_pointers;
+    delete[] dag.in_column_indices;
+    delete[] dag.in_row_pointers;
+    delete[] dag.partitions;
+
+    dag.max_node_id = csr.max_node_id;
+    dag.num_edges = static_cast<uint32_t>(out_col.size());
+    dag.out_row_pointers = new uint32_t[n + 1];
+    dag.in_row_pointers = new uint32_t[n + 1];
+    dag.out_column_indices = new uint32_t[out_col.size()];
+    dag.in_column_indices = new uint32_t[out_col.size()];
+    dag.partitions = new int16_t[n];
+    std::copy(out_row.begin(), out_row.end(), dag.out_row_pointers);
+    std::copy(out_col.begin(), out_col.end(), dag.out_column_indices);
+
+    // 入边按出边转置，按源点升序填充，每行自然有序
+    std::memset(dag.in_row_pointers, 0, (n + 1) * sizeof(uint32_t));
+    for (uint32_t target : out_col)
+        dag.in_row_pointers[target + 1]++;
+    for (uint32_t v = 0; v < n; ++v)
+        dag.in_row_pointers[v + 1] += dag.in_row_pointers[v];
+    std::vector<uint32_t> cursor(dag.in_row_pointers, dag.in_row_pointers + n);
+    for (uint32_t u = 0; u < n; ++u)
+    {
+        for (uint32_t e = out_row[u]; e < out_row[u + 1]; ++e)
+            dag.in_column_indices[cursor[out_col[e]]++] = u;
+    }
+
+    // 点数只算代表点
+    dag.num_nodes = 0;
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        dag.partitions[v] = -1;
+        if (component[v] == v)
+            dag.num_nodes++;
+    }
+}
+
+void SCCCondenser::condense(const CSRGraph &csr, const std::vector<uint32_t> &component, Graph &dag)
+{
+    std::vector<uint32_t> out_row, out_col;
+    collect_condensed_edges(csr, component, out_row, out_col);
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(out_col.size());
+    for (uint32_t u = 0; u + 1 < out_row.size(); ++u)
+    {
+        for (uint32_t e = out_row[u]; e < out_row[u + 1]; ++e)
+            edges.emplace_back(u, out_col[e]);
+    }
+    // 一次批量加边，不逐条有序插入
+    dag.set_max_node_id(csr.max_node_id);
+    dag.bulk_load(edges);
+}
@@ -0,0 +1,80 @@
+// 把 Edges/ 下的文本边集转换成二进制 CSR 文件，之后用 CSRGraph::fromBinary 直接 mmap 加载
+// 用法: convert_csr [输入文件或目录] [输出目录]
+// 默认输入 Edges/，输出 Edges/CSR/，保持相对路径，文件名加 .csr 后缀
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include "CSR.h"
+
+namespace fs = std::filesystem;
+
+// 超图、映射文件和已经转换过的文件不是 "u v" 边集，跳过
+static bool should_skip(const fs::path &path)
+{
+    for (const auto &part : path)
+    {
+        if (part == "Hyper" || part == "CSR" || part == "DAGmapping")
+            return true;
+    }
+    std::string name = path.filename().string();
+    auto ends_with = [&](const std::string &suffix)
+    {
+        return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    return ends_with("_mapping") || ends_with(".csr") || name[0] == '.';
+}
+
+static bool convert(const fs::path &input, const fs::path &output)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    CSRGraph csr;
+    if (!csr.fromFile(input.string()))
+        return false;
+    fs::create_directories(output.parent_path());
+    if (!csr.saveBinary(output.string()))
+        return false;
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << input.string() << " -> " << output.string()
+              << "  nodes " << csr.num_nodes << "  edges " << csr.num_edges
+              << "  " << fs::file_size(output) << " bytes  "
+              << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    fs::path root(PROJECT_ROOT_DIR);
+    fs::path input = argc > 1 ? fs::path(argv[1]) : root / "Edges";
+    fs::path output_dir = argc > 2 ? fs::path(argv[2]) : root / "Edges" / "CSR";
+
+    if (!fs::exists(input))
+    {
+        std::cerr << "输入不存在: " << input << std::endl;
+        return 1;
+    }
+
+    int failed = 0;
+    if (fs::is_regular_file(input))
+    {
+        failed += !convert(input, output_dir / (input.filename().string() + ".csr"));
+        return failed;
+    }
+
+    for (const auto &entry : fs::recursive_directory_iterator(input))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        fs::path relative = fs::relative(entry.path(), input);
+        if (should_skip(relative))
+            continue;
+        fs::path output = output_dir / relative;
+        output += ".csr";
+        if (!convert(entry.path(), output))
+        {
+            std::cerr << "转换失败: " << entry.path() << std::endl;
+            failed++;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
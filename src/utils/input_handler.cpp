@@ -1,6 +1,5 @@
 #include "utils/InputHandler.h"
-#include <fstream>
-#include <sstream>
+#include "utils/TextParser.h"
 #include <iostream>
 #include <algorithm>
 using namespace std;
@@ -8,38 +7,17 @@ InputHandler::InputHandler(const std::string& input_file) : input_file(input_fil
 
 // 从文件中读取边集并构建图
 void InputHandler::readGraph(Graph& g) {
-    std::ifstream infile(input_file);
-    if (!infile.is_open()) {
+    cout<<"开始读取文件"<<endl;
+    // 文件 mmap 后多线程解析，再一次性加到图里，避免逐条有序插入
+    std::vector<std::pair<int, int>> edges;
+    if (!TextParser::parse_edges(input_file, edges)) {
         std::cerr << "Error opening input file: " << input_file << std::endl;
         return;
     }
-    int num = 0;
-    std::string line;
-    cout<<"开始读取文件"<<endl;
-    uint32_t max_node_id = 0;
-    while(getline(infile, line)){
-        std::istringstream iss(line);
-        uint32_t u, v;
-        if (!(iss >> u >> v)) {
-            continue;  // 跳过无效行
-        }
-        max_node_id = max(max_node_id, max(u, v));
-    }
-    g.set_max_node_id(max_node_id);
-    infile.clear();
-    infile.seekg(0);
-    while (std::getline(infile, line)) {
-        std::istringstream iss(line);
-        int u, v;
-        if (!(iss >> u >> v)) {
-            continue;  // 跳过无效行
-        }
-        g.addEdge(u, v);
 #ifdef DEBUG
-        if(++num % 10000 == 0)cout<<"已经添加"<<num<<"条边"<<endl;
+    cout<<"已经读取"<<edges.size()<<"条边"<<endl;
 #endif
-    }
-    infile.close();
+    g.bulk_load(edges);
     cout<<"读取文件结束"<<endl;
     cout<<"节点数量为"<<g.get_num_vertices()<<endl;
     cout<<"边数量为"<<g.get_num_edges()<<endl;
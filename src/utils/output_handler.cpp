@@ -8,9 +8,8 @@
 // 静态方法：输出图的信息到控制台
 void OutputHandler::printGraphInfo(const Graph& graph) {
     std::cout << "source target" << std::endl;
-    for (const auto& vertex : graph.vertices) {
-        int source = &vertex - &graph.vertices[0];  // 获取节点的索引
-        for (int target : vertex.LOUT) {
+    for (size_t source = 0; source < graph.vertices.size(); ++source) {
+        for (int target : graph.vertices.out_edges[source]) {
             std::cout << source << " " << target << std::endl;
         }
     }
@@ -147,9 +146,8 @@ void OutputHandler::writeGraphInfo(const Graph& graph) {
 
     // 写入图的边信息
     outfile << "source target" << std::endl;
-    for (const auto& vertex : graph.vertices) {
-        int source = &vertex - &graph.vertices[0];  // 获取节点的索引
-        for (int target : vertex.LOUT) {
+    for (size_t source = 0; source < graph.vertices.size(); ++source) {
+        for (int target : graph.vertices.out_edges[source]) {
             outfile << source << " " << target << std::endl;
         }
     }
@@ -191,17 +189,17 @@ void OutputHandler::writeInOutSets(const PLL &pll) {
         return;
     }
 
-    for (int i = 0; i < pll.IN.size(); ++i) {
+    for (int i = 0; i < pll.num_label_vertices(); ++i) {
         outfile << "Node " << i << " IN_set: ";
-        for (int inNode : pll.IN[i]) {
-            outfile << inNode << " ";
-        }
+        pll.for_each_in_label(i, [&](int inNode) {
+            outfile << pll.landmark(inNode) << " ";
+        });
         outfile << std::endl;
 
         outfile << "Node " << i << " OUT_set: ";
-        for (int outNode : pll.OUT[i]) {
-            outfile << outNode << " ";
-        }
+        pll.for_each_out_label(i, [&](int outNode) {
+            outfile << pll.landmark(outNode) << " ";
+        });
         outfile << std::endl;
     }
     outfile.close();
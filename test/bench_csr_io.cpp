@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include "CSR.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+// CSR 构建和插边的性能对比，不注册到 CTest，需要时手动运行
+
+// 从边文件建 CSR，1 个线程和 8 个线程的耗时；点号稀疏时走原子计数，稠密时走线程局部直方图
+TEST(CSRParallelBuildBenchmark, FromFile)
+{
+    std::string path = ::testing::TempDir() + "bench_csr_parallel_edges.txt";
+    for (uint32_t max_id : {50000u, 3000000u})
+    {
+        std::mt19937 rng(41);
+        {
+            std::ofstream out(path);
+            for (int i = 0; i < 600000; i++)
+                out << rng() % max_id << " " << rng() % max_id << "\n";
+        }
+        CSRGraph serial, parallel;
+        auto start = std::chrono::high_resolution_clock::now();
+        ASSERT_TRUE(serial.fromFile(path, 1));
+        auto middle = std::chrono::high_resolution_clock::now();
+        ASSERT_TRUE(parallel.fromFile(path, 8));
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "max id " << max_id << "  1 thread " << std::chrono::duration<double>(middle - start).count()
+                  << " s, 8 threads " << std::chrono::duration<double>(end - middle).count() << " s" << std::endl;
+    }
+    std::remove(path.c_str());
+}
+
+// 从空图开始流式插边的耗时，动态模式下每次插入均摊 O(log^2 |V| + 度数)，不是 O(|V| + |E|)
+TEST(CSRDynamicBenchmark, StreamingInserts)
+{
+    const uint32_t n = 200000;
+    CSRGraph csr;
+    csr.createEmptyCSR(n);
+    std::mt19937 rng(53);
+    size_t inserted = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 300000; i++)
+    {
+        uint32_t u = rng() % n, v = rng() % (n / 100);
+        inserted += csr.addEdge(u, v);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << inserted << " inserts in " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+}
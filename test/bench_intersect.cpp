@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "utils/SetIntersection.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+
+// 性能对比，不注册到 CTest，需要时手动运行
+
+namespace
+{
+    // 生成 size 个不重复的升序元素，取值范围 [0, range)
+    std::vector<int> random_sorted_set(std::mt19937 &rng, size_t size, int range)
+    {
+        std::set<int> s;
+        std::uniform_int_distribution<int> dist(0, range - 1);
+        while (s.size() < size)
+            s.insert(dist(rng));
+        return std::vector<int>(s.begin(), s.end());
+    }
+
+    // 原来 PLL::query 里的双重循环，作为对比基线
+    bool nested_loop(const std::vector<int> &a, const std::vector<int> &b)
+    {
+        for (auto x : a)
+            for (auto y : b)
+                if (x == y)
+                    return true;
+        return false;
+    }
+}
+
+// 不同标签大小分布下和双重循环对比，只输出加速比，不做断言
+TEST(SetIntersectionBenchmark, NestedLoopVsKernel)
+{
+    struct Case
+    {
+        const char *name;
+        size_t size_a;
+        size_t size_b;
+        int range;
+    };
+    std::vector<Case> cases = {
+        {"small-small", 8, 8, 1000},
+        {"small-large", 8, 256, 100000},
+        {"medium-medium", 64, 64, 100000},
+        {"large-large", 512, 512, 1000000},
+    };
+    std::cout << "kernel: " << SetIntersection::kernel_name() << std::endl;
+    std::mt19937 rng(9);
+    for (auto &c : cases)
+    {
+        const int num_pairs = 200;
+        std::vector<std::vector<int>> as, bs;
+        for (int i = 0; i < num_pairs; i++)
+        {
+            as.push_back(random_sorted_set(rng, c.size_a, c.range));
+            bs.push_back(random_sorted_set(rng, c.size_b, c.range));
+        }
+        int repeat = static_cast<int>(std::max<size_t>(1, 200000 / (c.size_a * c.size_b)));
+        size_t hits_loop = 0, hits_kernel = 0;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < repeat; r++)
+            for (int i = 0; i < num_pairs; i++)
+                hits_loop += nested_loop(as[i], bs[i]);
+        auto mid = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < repeat; r++)
+            for (int i = 0; i < num_pairs; i++)
+                hits_kernel += SetIntersection::intersect(as[i], bs[i]);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        EXPECT_EQ(hits_loop, hits_kernel);
+        double loop_ns = std::chrono::duration<double, std::nano>(mid - start).count() / (repeat * num_pairs);
+        double kernel_ns = std::chrono::duration<double, std::nano>(end - mid).count() / (repeat * num_pairs);
+        std::cout << c.name << "  nested loop: " << loop_ns << " ns  kernel: " << kernel_ns
+                  << " ns  speedup: " << loop_ns / kernel_ns << "x" << std::endl;
+    }
+}
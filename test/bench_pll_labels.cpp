@@ -0,0 +1,176 @@
+#include "gtest/gtest.h"
+#include "graph.h"
+#include "pll.h"
+#include "LandmarkOrdering.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+// PLL 构建和查询的性能对比，不注册到 CTest，需要时手动运行
+
+namespace
+{
+    // n 个点 m 条随机边，dag 为真时边都从小号指向大号
+    void random_graph(Graph &g, int n, int m, bool dag, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<std::pair<int, int>> edges;
+        for (int i = 0; i < m; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            if (u == v)
+                continue;
+            if (dag && u > v)
+                std::swap(u, v);
+            edges.emplace_back(u, v);
+        }
+        g.set_max_node_id(n - 1);
+        g.bulk_load(edges);
+    }
+
+    size_t label_count(const PLL &pll)
+    {
+        size_t total = 0;
+        for (size_t u = 0; u < pll.IN.size(); u++)
+            total += pll.IN[u].size() + pll.OUT[u].size();
+        return total;
+    }
+}
+
+// 1 到硬件线程数的构建耗时和标签数，只输出不做断言
+TEST(PLLParallelBenchmark, Scalability)
+{
+    Graph g(true);
+    random_graph(g, 20000, 60000, false, 47);
+    auto start = std::chrono::high_resolution_clock::now();
+    PLL sequential(g);
+    sequential.buildPLLLabels();
+    auto end = std::chrono::high_resolution_clock::now();
+    double base = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "sequential: " << base << " ms, " << label_count(sequential) << " labels" << std::endl;
+
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        start = std::chrono::high_resolution_clock::now();
+        PLL parallel(g);
+        parallel.buildPLLLabelsParallel(threads);
+        end = std::chrono::high_resolution_clock::now();
+        double time = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << threads << " threads: " << time << " ms (x" << base / time << "), "
+                  << label_count(parallel) << " labels" << std::endl;
+    }
+}
+
+// 不同位并行组数下的标签数、索引大小、构建和查询耗时，和普通 PLL 对比，只输出不做断言
+TEST(PLLBitParallelBenchmark, LabelSizeAndLatency)
+{
+    Graph g(true);
+    random_graph(g, 20000, 60000, false, 61);
+    std::mt19937 rng(67);
+    std::vector<std::pair<int, int>> queries;
+    for (int i = 0; i < 200000; i++)
+        queries.emplace_back(rng() % 20000, rng() % 20000);
+
+    double base_query = 0;
+    for (int roots : {0, 2, 4, 16})
+    {
+        PLL pll(g);
+        pll.set_bit_parallel_roots(roots);
+        auto start = std::chrono::high_resolution_clock::now();
+        pll.offline_industry();
+        auto end = std::chrono::high_resolution_clock::now();
+        double build = std::chrono::duration<double, std::milli>(end - start).count();
+
+        size_t reachable = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (const auto &query : queries)
+            reachable += pll.reachability_query(query.first, query.second);
+        end = std::chrono::high_resolution_clock::now();
+        double query = std::chrono::duration<double, std::nano>(end - start).count() / queries.size();
+        if (roots == 0)
+            base_query = query;
+
+        size_t bytes = label_count(pll) * sizeof(int) + pll.num_bit_parallel_roots() * g.vertices.size() * 2 * sizeof(uint64_t);
+        std::cout << roots << " bit-parallel roots: " << label_count(pll) << " labels, " << bytes << " bytes, build "
+                  << build << " ms, query " << query << " ns (x" << base_query / query << ", " << reachable << " reachable)"
+                  << std::endl;
+    }
+}
+
+// 各种路标点顺序的标签数、字节数、构建和查询耗时，只输出不做断言
+TEST(LandmarkOrderingBenchmark, Report)
+{
+    for (bool dag : {false, true})
+    {
+        Graph g(true);
+        random_graph(g, 20000, dag ? 80000 : 60000, dag, dag ? 83 : 89);
+        std::mt19937 rng(97);
+        std::vector<std::pair<int, int>> queries;
+        for (int i = 0; i < 200000; i++)
+            queries.emplace_back(rng() % 20000, rng() % 20000);
+        std::cout << (dag ? "DAG" : "cyclic") << std::endl;
+        auto evaluations = LandmarkOrdering::evaluate(g, LandmarkOrdering::all(), queries);
+        for (const auto &line : LandmarkOrdering::format_report(evaluations))
+            std::cout << line << std::endl;
+    }
+}
+
+// 压缩前后的标签内存、查询耗时，以及写文件和 mmap 加载的耗时，只输出不做断言
+TEST(PLLLabelStoreBenchmark, MemoryAndColdStart)
+{
+    std::string file = ::testing::TempDir() + "test_pll_labels_bench.pll";
+    Graph g(true);
+    random_graph(g, 20000, 80000, true, 107);
+    std::mt19937 rng(109);
+    std::vector<std::pair<int, int>> queries;
+    for (int i = 0; i < 200000; i++)
+        queries.emplace_back(rng() % 20000, rng() % 20000);
+    auto time_queries = [&](PLL &pll, size_t &reachable) {
+        reachable = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const auto &query : queries)
+            reachable += pll.reachability_query(query.first, query.second);
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / queries.size();
+    };
+
+    PLL pll(g);
+    auto start = std::chrono::high_resolution_clock::now();
+    pll.offline_industry();
+    auto end = std::chrono::high_resolution_clock::now();
+    double build = std::chrono::duration<double, std::milli>(end - start).count();
+    size_t vector_bytes = 0;
+    for (size_t v = 0; v < pll.IN.size(); v++)
+        vector_bytes += (pll.IN[v].capacity() + pll.OUT[v].capacity()) * sizeof(int) + 2 * sizeof(std::vector<int>);
+    size_t reachable;
+    double plain_query = time_queries(pll, reachable);
+    std::cout << "vectors: " << vector_bytes << " bytes, build " << build << " ms, query " << plain_query << " ns ("
+              << reachable << " reachable)" << std::endl;
+
+    pll.compress_labels();
+    ASSERT_TRUE(pll.save_labels(file));
+    size_t compressed_bytes = 0;
+    for (const auto &entry : pll.getIndexSizes())
+    {
+        if (entry.first.rfind("compressed", 0) == 0)
+            compressed_bytes += std::stoull(entry.second);
+    }
+    double compressed_query = time_queries(pll, reachable);
+    std::cout << "compressed: " << compressed_bytes << " bytes (x" << double(vector_bytes) / compressed_bytes
+              << " smaller), query " << compressed_query << " ns (" << reachable << " reachable)" << std::endl;
+
+    PLL loaded(g);
+    start = std::chrono::high_resolution_clock::now();
+    ASSERT_TRUE(loaded.load_labels(file));
+    end = std::chrono::high_resolution_clock::now();
+    double load = std::chrono::duration<double, std::milli>(end - start).count();
+    double first_query = time_queries(loaded, reachable);
+    std::cout << "mmap load: " << load << " ms, first pass query " << first_query << " ns (" << reachable
+              << " reachable)" << std::endl;
+    std::remove(file.c_str());
+}
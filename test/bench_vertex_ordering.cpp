@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+#include "graph.h"
+#include "CSR.h"
+#include "pll.h"
+#include "BiBFSCSR.h"
+#include "VertexOrdering.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+// 性能对比，不注册到 CTest，需要时手动运行
+
+namespace
+{
+    const VertexOrdering::Strategy ALL_STRATEGIES[] = {
+        VertexOrdering::Strategy::IDENTITY, VertexOrdering::Strategy::DEGREE, VertexOrdering::Strategy::RCM,
+        VertexOrdering::Strategy::BFS, VertexOrdering::Strategy::PARTITION};
+
+    // rows x cols 的网格，边指向右和下，再加少量随机的长边，点号随机打乱，和真实边集一样没有局部性
+    void shuffled_grid(Graph &g, int rows, int cols, int extra, unsigned seed)
+    {
+        int n = rows * cols;
+        std::mt19937 rng(seed);
+        std::vector<int> label(n);
+        std::iota(label.begin(), label.end(), 0);
+        std::shuffle(label.begin(), label.end(), rng);
+        std::vector<std::pair<int, int>> edges;
+        for (int r = 0; r < rows; r++)
+        {
+            for (int c = 0; c < cols; c++)
+            {
+                int u = r * cols + c;
+                if (c + 1 < cols)
+                    edges.emplace_back(label[u], label[u + 1]);
+                if (r + 1 < rows)
+                    edges.emplace_back(label[u], label[u + cols]);
+            }
+        }
+        for (int i = 0; i < extra; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            edges.emplace_back(label[std::min(u, v)], label[std::max(u, v)]);
+        }
+        g.bulk_load(edges);
+        for (int u = 0; u < n; u++)
+            g.set_partition_id(label[u], u / cols * 4 / rows);
+    }
+}
+
+// 各种顺序下 BiBFSCSR 查询和 PLL 构建的耗时，只输出相对原始点号的加速比，不做断言
+TEST(VertexOrderingBenchmark, QueryAndBuild)
+{
+    Graph query_graph{true}, build_graph{true};
+    shuffled_grid(query_graph, 300, 300, 20000, 79);
+    shuffled_grid(build_graph, 40, 50, 400, 83);
+    CSRGraph query_csr, build_csr;
+    query_csr.fromGraph(query_graph);
+    build_csr.fromGraph(build_graph);
+
+    std::mt19937 rng(89);
+    std::vector<std::pair<int, int>> queries;
+    int n = static_cast<int>(query_graph.vertices.size());
+    for (int i = 0; i < 1000; i++)
+        queries.emplace_back(rng() % n, rng() % n);
+
+    double base_query = 0, base_build = 0;
+    for (auto strategy : ALL_STRATEGIES)
+    {
+        auto ordering = std::make_shared<VertexOrdering>();
+        ordering->compute(query_csr, strategy);
+        auto relabeled = std::make_shared<CSRGraph>();
+        ordering->apply(query_csr, *relabeled);
+        ReorderedAlgorithm bibfs(ordering, std::make_unique<BiBFSCSR>(relabeled));
+        std::vector<uint8_t> out;
+        auto start = std::chrono::high_resolution_clock::now();
+        bibfs.reachability_query_batch(queries, out, 1);
+        auto end = std::chrono::high_resolution_clock::now();
+        size_t reachable = std::count(out.begin(), out.end(), 1);
+        double query_time = std::chrono::duration<double, std::milli>(end - start).count();
+
+        VertexOrdering build_ordering;
+        build_ordering.compute(build_csr, strategy);
+        Graph relabeled_graph{true};
+        build_ordering.apply(build_graph, relabeled_graph);
+        start = std::chrono::high_resolution_clock::now();
+        PLL pll(relabeled_graph);
+        pll.offline_industry();
+        end = std::chrono::high_resolution_clock::now();
+        double build_time = std::chrono::duration<double, std::milli>(end - start).count();
+
+        if (strategy == VertexOrdering::Strategy::IDENTITY)
+        {
+            base_query = query_time;
+            base_build = build_time;
+        }
+        std::cout << VertexOrdering::name(strategy) << ": BiBFSCSR " << queries.size() << " queries "
+                  << query_time << " ms (x" << base_query / query_time << ", " << reachable << " reachable)"
+                  << ", PLL build " << build_time << " ms (x" << base_build / build_time << ")" << std::endl;
+    }
+}
@@ -0,0 +1,335 @@
+#include "gtest/gtest.h"
+#include "graph.h"
+#include "pll.h"
+#include "BiBFSCSR.h"
+#include "BitmapBiBFS.h"
+#include "BidirectionalBFS.h"
+#include "BloomFilter.h"
+#include "TreeCover.h"
+#include "CompressedSearch.h"
+#include "utils/BatchScheduler.h"
+#include "SearchContext.h"
+#include "MultiSourceBFS.h"
+#include "ReachRatio.h"
+#include <atomic>
+#include <random>
+
+// 批量查询和逐个查询的结果要一致
+class BatchQueryTest : public ::testing::Test
+{
+protected:
+    Graph g{true};
+    int n = 80;
+    std::vector<std::pair<int, int>> queries;
+
+    virtual void SetUp()
+    {
+        std::mt19937 rng(11);
+        for (int i = 0; i < 240; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            if (u < v)
+                g.addEdge(u, v);
+            else if (v < u)
+                g.addEdge(v, u);
+        }
+        for (int i = 0; i < 5000; i++)
+            queries.emplace_back(rng() % n, rng() % n);
+    }
+
+    void expect_same(Algorithm &algorithm, int num_threads)
+    {
+        std::vector<uint8_t> out;
+        algorithm.reachability_query_batch(queries, out, num_threads);
+        ASSERT_EQ(out.size(), queries.size());
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            EXPECT_EQ(out[i], algorithm.reachability_query(queries[i].first, queries[i].second) ? 1 : 0)
+                << queries[i].first << " -> " << queries[i].second;
+        }
+    }
+};
+
+TEST_F(BatchQueryTest, PLL)
+{
+    PLL pll(g);
+    pll.offline_industry();
+    expect_same(pll, 4);
+    expect_same(pll, 1);
+}
+
+TEST_F(BatchQueryTest, BiBFSCSR)
+{
+    BiBFSCSR bibfs(g);
+    BidirectionalBFS bfs(g);
+    std::vector<uint8_t> out;
+    bibfs.reachability_query_batch(queries, out, 4);
+    for (size_t i = 0; i < queries.size(); i++)
+        EXPECT_EQ(out[i], bfs.reachability_query(queries[i].first, queries[i].second) ? 1 : 0);
+}
+
+// 稀疏图基本走自顶向下，稠密图的当前层很快变大会切到自底向上；两种存储上结果都和邻接表上的 BFS 一致，路径的每一步都是边
+TEST(BitmapBiBFSTest, MatchesBidirectionalBFS)
+{
+    for (int edges : {300, 12000})
+    {
+        SCOPED_TRACE(edges);
+        Graph g(true);
+        int n = 400;
+        std::mt19937 rng(edges);
+        for (int i = 0; i < edges; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            if (u != v)
+                g.addEdge(u, v);
+        }
+        CSRGraph csr;
+        csr.fromGraph(g);
+        CompressedCSR compressed;
+        ASSERT_TRUE(compressed.fromCSR(csr));
+        BitmapBiBFS<CSRGraph> on_csr(csr);
+        BitmapBiBFS<CompressedCSR> on_compressed(compressed);
+        BidirectionalBFS bfs(g);
+        for (int i = 0; i < 3000; i++)
+        {
+            int s = rng() % n, t = rng() % n;
+            bool expected = bfs.reachability_query(s, t);
+            ASSERT_EQ(on_csr.reachable(s, t), expected) << s << " -> " << t;
+            ASSERT_EQ(on_compressed.reachable(s, t), expected) << s << " -> " << t;
+            auto path = on_csr.find_path(s, t);
+            ASSERT_EQ(path.empty(), !expected) << s << " -> " << t;
+            if (!expected)
+                continue;
+            EXPECT_EQ(path.front(), s);
+            EXPECT_EQ(path.back(), t);
+            for (size_t k = 0; k + 1 < path.size(); k++)
+                ASSERT_TRUE(g.hasEdge(path[k], path[k + 1])) << path[k] << " -> " << path[k + 1];
+            ASSERT_EQ(on_compressed.find_path(s, t).size(), path.size()) << s << " -> " << t;
+        }
+    }
+}
+
+// 一个 SearchContext 在不同大小的图、不同算法之间交替使用，结果和每次新建一份的一致；多线程时各用各的
+TEST(SearchContextTest, ReusedAcrossQueriesAndGraphs)
+{
+    Graph small(true), large(true);
+    std::mt19937 rng(23);
+    for (int i = 0; i < 120; i++)
+        small.addEdge(rng() % 40, rng() % 40);
+    for (int i = 0; i < 900; i++)
+        large.addEdge(rng() % 300, rng() % 300);
+    BidirectionalBFS small_bfs(small), large_bfs(large);
+    BiBFSCSR small_csr(small), large_csr(large);
+
+    SearchContext context;
+    for (int i = 0; i < 4000; i++)
+    {
+        bool use_large = i % 3 == 0;
+        int n = use_large ? 300 : 40;
+        int s = rng() % n, t = rng() % n;
+        BidirectionalBFS &bfs = use_large ? large_bfs : small_bfs;
+        BiBFSCSR &csr = use_large ? large_csr : small_csr;
+        SearchContext fresh;
+        bool expected = bfs.reachability_query(s, t, fresh);
+        ASSERT_EQ(bfs.reachability_query(s, t, context), expected) << s << " -> " << t;
+        ASSERT_EQ(csr.reachability_query(s, t, context), expected) << s << " -> " << t;
+        ASSERT_EQ(bfs.findPath(s, t, -1, context), bfs.findPath(s, t, -1, fresh)) << s << " -> " << t;
+        ASSERT_EQ(csr.findPath(s, t, -1, context).empty(), !expected) << s << " -> " << t;
+    }
+
+    // count_reachable 多线程调用不带 context 的 reachability_query，每个线程用自己的 SearchContext::local()
+    uint32_t expected = 0;
+    for (int s = 0; s < 300; s++)
+    {
+        if (large.vertices[s].LOUT.empty())
+            continue;
+        for (int t = 0; t < 300; t++)
+        {
+            if (!large.vertices[t].LIN.empty() && large_bfs.reachability_query(s, t, context))
+                expected++;
+        }
+    }
+    EXPECT_EQ(large_bfs.count_reachable(), expected);
+}
+
+// 多源 BFS 每个起点到达的点集和单独 BFS 一样，沿入边、带过滤条件、起点重复、超过 64 个起点分组时都成立
+TEST(MultiSourceBFSTest, MatchesSingleSourceBFS)
+{
+    Graph g(true);
+    int n = 500;
+    std::mt19937 rng(31);
+    for (int i = 0; i < 1200; i++)
+        g.addEdge(rng() % n, rng() % n);
+    for (int u = 0; u < n; u++)
+        g.set_partition_id(u, u % 3);
+    CSRGraph csr;
+    csr.fromGraph(g);
+
+    std::vector<uint32_t> sources;
+    for (int i = 0; i < 150; i++)
+        sources.push_back(rng() % n);
+    sources.push_back(sources.front());
+
+    // 只走分区号和起点相同的点，起点自己总是算进去
+    auto single = [&](uint32_t s, bool forward, bool same_partition) {
+        std::vector<uint8_t> seen(n, 0);
+        std::vector<uint32_t> queue{s};
+        seen[s] = 1;
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            const auto &neighbors = forward ? g.vertices[queue[head]].LOUT : g.vertices[queue[head]].LIN;
+            for (int v : neighbors)
+            {
+                if (seen[v] || (same_partition && g.get_partition_id(v) != g.get_partition_id(s)))
+                    continue;
+                seen[v] = 1;
+                queue.push_back(v);
+            }
+        }
+        return seen;
+    };
+
+    for (bool forward : {true, false})
+    {
+        SCOPED_TRACE(forward);
+        std::vector<std::vector<uint8_t>> reached(sources.size(), std::vector<uint8_t>(n, 0));
+        MultiSourceBFS<CSRGraph>::for_each_group(csr, forward, sources, 3,
+            [&](int, const uint32_t *group, uint32_t v, uint64_t mask) {
+                for (; mask; mask &= mask - 1)
+                {
+                    auto &row = reached[group - sources.data() + __builtin_ctzll(mask)];
+                    ASSERT_EQ(row[v], 0) << "visited twice: " << v;
+                    row[v] = 1;
+                }
+            });
+        uint64_t total = 0;
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            ASSERT_EQ(reached[i], single(sources[i], forward, false)) << sources[i];
+            total += std::count(reached[i].begin(), reached[i].end(), 1);
+        }
+        EXPECT_EQ(MultiSourceBFS<CSRGraph>::total_reach(csr, forward, sources, 2), total);
+
+        // 过滤条件里拿不到起点，只能每个分区的起点单独跑一遍
+        for (int partition = 0; partition < 3; partition++)
+        {
+            std::vector<uint32_t> in_partition;
+            for (uint32_t s : sources)
+            {
+                if (g.get_partition_id(s) == partition)
+                    in_partition.push_back(s);
+            }
+            std::vector<uint64_t> counts;
+            GraphAdjacency adjacency(g);
+            MultiSourceBFS<GraphAdjacency>::reach_counts(adjacency, forward, in_partition, counts, 2,
+                                                         [&](uint32_t v) { return g.get_partition_id(v) == partition; });
+            for (size_t i = 0; i < in_partition.size(); i++)
+            {
+                auto seen = single(in_partition[i], forward, true);
+                ASSERT_EQ(counts[i], static_cast<uint64_t>(std::count(seen.begin(), seen.end(), 1))) << in_partition[i];
+            }
+        }
+    }
+
+    // 全图可达比例的几种算法结果一致
+    uint64_t pairs = 0;
+    for (int s = 0; s < n; s++)
+    {
+        auto seen = single(s, true, false);
+        pairs += std::count(seen.begin(), seen.end(), 1) - 1;
+    }
+    double expected = static_cast<double>(pairs) / (static_cast<double>(g.get_num_vertices()) * (g.get_num_vertices() - 1));
+    EXPECT_NEAR(compute_reach_ratio(g), expected, 1e-6);
+    EXPECT_NEAR(compute_reach_ratio_bfs(g), expected, 1e-6);
+}
+
+// 256 位宽的 AVX2 版本和 64 位的版本每个起点到达的点集一样，最后一组不满、带过滤条件时也成立
+TEST(MultiSourceBFSTest, WideLanesMatchWordLanes)
+{
+#ifdef SET_INTERSECTION_X86
+    if (!SetIntersection::has_avx2())
+        GTEST_SKIP() << "no avx2";
+    Graph g(true);
+    int n = 800;
+    std::mt19937 rng(37);
+    for (int i = 0; i < 2000; i++)
+        g.addEdge(rng() % n, rng() % n);
+    CSRGraph csr;
+    csr.fromGraph(g);
+    std::vector<uint32_t> sources;
+    for (int i = 0; i < 600; i++)
+        sources.push_back(rng() % n);
+    auto accept = [](uint32_t v) { return v % 7 != 0; };
+
+    for (bool forward : {true, false})
+    {
+        SCOPED_TRACE(forward);
+        std::vector<std::vector<uint8_t>> narrow(sources.size(), std::vector<uint8_t>(n, 0)), wide = narrow;
+        MultiSourceBFS<CSRGraph> engine(csr, forward);
+        for (size_t begin = 0; begin < sources.size(); begin += 64)
+        {
+            engine.run(sources.data() + begin, std::min<size_t>(64, sources.size() - begin), [&](uint32_t v, uint64_t mask) {
+                for (; mask; mask &= mask - 1)
+                    narrow[begin + __builtin_ctzll(mask)][v] = 1;
+            }, accept);
+        }
+        WideMultiSourceBFS<CSRGraph>::for_each_group(csr, forward, sources, 2,
+            [&](int, const uint32_t *group, uint32_t v, uint64_t mask) {
+                for (; mask; mask &= mask - 1)
+                {
+                    auto &row = wide[group - sources.data() + __builtin_ctzll(mask)];
+                    ASSERT_EQ(row[v], 0) << "visited twice: " << v;
+                    row[v] = 1;
+                }
+            }, accept);
+        for (size_t i = 0; i < sources.size(); i++)
+            ASSERT_EQ(wide[i], narrow[i]) << sources[i];
+    }
+#else
+    GTEST_SKIP() << "not x86";
+#endif
+}
+
+TEST_F(BatchQueryTest, Filters)
+{
+    TreeCover tree_cover(g);
+    tree_cover.offline_industry();
+    expect_same(tree_cover, 4);
+    BloomFilter bloom(g);
+    bloom.offline_industry();
+    expect_same(bloom, 4);
+}
+
+TEST_F(BatchQueryTest, CompressedSearch)
+{
+    // 跨分区查询会枚举分区路径，图稠密时很慢，这里单独用一个稀疏一点的图
+    Graph sparse(true);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 150; i++)
+    {
+        int u = rng() % 60, v = rng() % 60;
+        if (u < v)
+            sparse.addEdge(u, v);
+        else if (v < u)
+            sparse.addEdge(v, u);
+    }
+    queries.resize(500);
+    for (auto &query : queries)
+        query = {query.first % 60, query.second % 60};
+    CompressedSearch comp(sparse, "Random");
+    comp.offline_industry(200, 0.3, "");
+    expect_same(comp, 4);
+}
+
+TEST(BatchSchedulerTest, CoversEveryIndexOnce)
+{
+    size_t count = 100003;
+    std::vector<std::atomic<int>> hits(count);
+    int num_threads = BatchScheduler::resolve_threads(8, count, 64);
+    BatchScheduler::run(count, num_threads, [&](int, size_t begin, size_t end)
+                        {
+        for (size_t i = begin; i < end; ++i)
+            hits[i]++; }, 64);
+    for (size_t i = 0; i < count; i++)
+        ASSERT_EQ(hits[i].load(), 1) << i;
+}
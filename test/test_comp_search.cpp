@@ -0,0 +1,305 @@
+#include "gtest/gtest.h"
+#include "graph.h"
+#include "CompressedSearch.h"
+#include "BidirectionalBFS.h"
+#include "QueryTrace.h"
+#include <map>
+#include <random>
+#include <fstream>
+#include <cstdio>
+
+// 在小的随机DAG上和双向BFS对比结果，不依赖数据集文件
+class CompSearchTest : public ::testing::Test
+{
+protected:
+    Graph g{true};
+    int n = 60;
+
+    virtual void SetUp()
+    {
+        std::mt19937 rng(7);
+        for (int i = 0; i < 150; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            if (u < v)
+                g.addEdge(u, v);
+            else if (v < u)
+                g.addEdge(v, u);
+        }
+    }
+
+    // 按点号每 15 个点分成一块，写成 ImportPartitioner 读取的分区文件，返回文件路径
+    std::string write_block_partitions(const std::string &name)
+    {
+        std::string partition_file = std::string(PROJECT_ROOT_DIR) + "/Partitions/" + name + "_partitions_mincut.txt";
+        std::ofstream out(partition_file);
+        for (int u = 0; u < n; u++)
+            out << u << " " << u / 15 << "\n";
+        return partition_file;
+    }
+};
+
+TEST_F(CompSearchTest, MatchesBiBFS)
+{
+    BidirectionalBFS bfs(g);
+    CompressedSearch comp(g, "Random");
+    comp.offline_industry(200, 0.3, "");
+
+    for (int s = 0; s < n; s += 3)
+    {
+        for (int t = 0; t < n; t += 5)
+        {
+            EXPECT_EQ(comp.reachability_query(s, t), bfs.reachability_query(s, t)) << s << " -> " << t;
+        }
+    }
+}
+
+// 不建分区索引时分区内查询走限定分区的双向BFS，结果也和整图BFS一致
+TEST_F(CompSearchTest, WithoutIndexMatchesBiBFS)
+{
+    BidirectionalBFS bfs(g);
+    CompressedSearch comp(g, "Random", false);
+    comp.offline_industry(200, 0.3, "");
+
+    for (int s = 0; s < n; s++)
+    {
+        for (int t = 0; t < n; t++)
+        {
+            EXPECT_EQ(comp.reachability_query(s, t), bfs.reachability_query(s, t)) << s << " -> " << t;
+        }
+    }
+}
+
+// 分区多、分区间连边多的时候跨分区查询也要在有限时间内完成
+TEST(CompSearchLargeTest, ManyPartitions)
+{
+    Graph g(true);
+    std::mt19937 rng(13);
+    int n = 1000;
+    for (int i = 0; i < 3000; i++)
+    {
+        int u = rng() % n, v = rng() % n;
+        if (u < v)
+            g.addEdge(u, v);
+        else if (v < u)
+            g.addEdge(v, u);
+    }
+    BidirectionalBFS bfs(g);
+    CompressedSearch comp(g, "Random");
+    comp.offline_industry(200, 0.3, "");
+    for (int i = 0; i < 2000; i++)
+    {
+        int s = rng() % n, t = rng() % n;
+        EXPECT_EQ(comp.reachability_query(s, t), bfs.reachability_query(s, t)) << s << " -> " << t;
+    }
+}
+
+// 多线程建分区索引，结果和BFS一致，每个建了索引的分区都有一条耗时记录
+TEST(CompSearchLargeTest, ParallelBuild)
+{
+    Graph g(true);
+    std::mt19937 rng(19);
+    int n = 1000;
+    for (int i = 0; i < 3000; i++)
+    {
+        int u = rng() % n, v = rng() % n;
+        if (u < v)
+            g.addEdge(u, v);
+        else if (v < u)
+            g.addEdge(v, u);
+    }
+    BidirectionalBFS bfs(g);
+    CompressedSearch comp(g, "Random");
+    comp.set_build_threads(4);
+    comp.offline_industry(3, 0.3, "");
+    for (int i = 0; i < 2000; i++)
+    {
+        int s = rng() % n, t = rng() % n;
+        EXPECT_EQ(comp.reachability_query(s, t), bfs.reachability_query(s, t)) << s << " -> " << t;
+    }
+
+    const auto &subgraphs = comp.get_partition_manager().partition_subgraphs;
+    size_t indexed = 0;
+    for (int partition_id : subgraphs.partition_ids())
+    {
+        if (subgraphs.get(partition_id).num_connected > 1)
+            indexed++;
+    }
+    // 前 3 行是按索引类型的汇总，第 4 行是表头
+    EXPECT_EQ(comp.get_build_report().size(), indexed + 4);
+}
+
+// 三种分区内索引（可达矩阵、PLL、不可达表）都要和BFS结果一致
+// 随机分区太碎，这里按点号分成连续的 4 块导入，每块都有足够的分区内边
+TEST_F(CompSearchTest, AllIntraIndexKinds)
+{
+    std::string name = "test_comp_search_blocks";
+    std::string partition_file = write_block_partitions(name);
+    BidirectionalBFS bfs(g);
+    std::vector<std::pair<size_t, float>> configs = {{200, 0.3f}, {3, 1.1f}, {3, 0.0f}};
+    for (auto &[num_vertices, ratio] : configs)
+    {
+        // PLL 的标签压缩与否结果都一样
+        for (bool compress : {false, true})
+        {
+            Graph copy = g;
+            copy.setFilename(name);
+            CompressedSearch comp(copy, "Import");
+            comp.set_compress_labels(compress);
+            comp.offline_industry(num_vertices, ratio, "");
+            for (int s = 0; s < n; s++)
+            {
+                for (int t = 0; t < n; t++)
+                {
+                    EXPECT_EQ(comp.reachability_query(s, t), bfs.reachability_query(s, t))
+                        << s << " -> " << t << " num_vertices " << num_vertices << " ratio " << ratio
+                        << " compress " << compress;
+                }
+            }
+            // 压缩后的标签计入 PLL 的几行和 Total
+            std::map<std::string, unsigned long long> sizes;
+            for (const auto &entry : comp.getIndexSizes())
+                sizes[entry.first] = std::stoull(entry.second);
+            if (compress)
+            {
+                EXPECT_GT(sizes["PLL_compressed_offsets"], 0u);
+                EXPECT_GE(sizes["Total"], sizes["PLL_compressed_labels"] + sizes["PLL_compressed_offsets"]);
+            }
+            else
+            {
+                EXPECT_EQ(sizes["PLL_compressed_offsets"], 0u);
+            }
+        }
+    }
+    std::remove(partition_file.c_str());
+}
+
+// 分区内有环时可达矩阵按强连通分量计算闭包，结果也要和BFS一致
+TEST_F(CompSearchTest, SmallIndexWithCycles)
+{
+    std::string name = "test_comp_search_cycles";
+    std::string partition_file = write_block_partitions(name);
+    std::mt19937 rng(17);
+    for (int i = 0; i < 20; i++)
+    {
+        // 块内加反向边形成环
+        int block = rng() % 4;
+        int u = block * 15 + rng() % 15, v = block * 15 + rng() % 15;
+        if (u > v)
+            g.addEdge(u, v);
+    }
+    g.addEdge(5, 5);
+    g.setFilename(name);
+    BidirectionalBFS bfs(g);
+    CompressedSearch comp(g, "Import");
+    comp.offline_industry(200, 0.3, "");
+    for (int s = 0; s < n; s++)
+    {
+        for (int t = 0; t < n; t++)
+        {
+            EXPECT_EQ(comp.reachability_query(s, t), bfs.reachability_query(s, t)) << s << " -> " << t;
+        }
+    }
+    std::remove(partition_file.c_str());
+}
+
+TEST_F(CompSearchTest, SubgraphsUseLocalIds)
+{
+    CompressedSearch comp(g, "Random");
+    comp.offline_industry(200, 0.3, "");
+    auto &pm = comp.get_partition_manager();
+    const auto &subgraphs = pm.partition_subgraphs;
+    size_t total = 0;
+    for (int partition_id : subgraphs.partition_ids())
+    {
+        auto view = subgraphs.get(partition_id);
+        total += view.num_vertices;
+        for (uint32_t u = 0; u < view.num_vertices; u++)
+        {
+            int global_u = view.global_id(u);
+            EXPECT_EQ(subgraphs.local_id(global_u), u);
+            EXPECT_EQ(g.get_partition_id(global_u), partition_id);
+            uint32_t degree;
+            const uint32_t *neighbors = view.out_neighbors(u, degree);
+            for (uint32_t i = 0; i < degree; i++)
+            {
+                EXPECT_LT(neighbors[i], view.num_vertices);
+                EXPECT_TRUE(g.hasEdge(global_u, view.global_id(neighbors[i])));
+            }
+        }
+    }
+    EXPECT_LE(total, g.vertices.size());
+}
+
+// 分区信息里不在图中的点跳过，只剩这种点的分区不建子图
+TEST(PartitionSubgraphsTest, SkipsIdsOutsideGraph)
+{
+    Graph small(true);
+    small.addEdge(0, 1);
+    small.addEdge(1, 2);
+    small.set_partition_id(0, 0);
+    small.set_partition_id(1, 0);
+    std::map<int, std::set<int>> mapping = {{0, {-3, 0, 1, 50}}, {5, {99}}};
+    PartitionSubgraphs subgraphs;
+    subgraphs.build(small, mapping);
+    ASSERT_EQ(subgraphs.partition_ids(), std::vector<int>({0}));
+    auto view = subgraphs.get(0);
+    ASSERT_EQ(view.num_vertices, 2u);
+    EXPECT_EQ(view.global_id(0), 0);
+    EXPECT_EQ(view.global_id(1), 1);
+    EXPECT_EQ(subgraphs.local_id(50), PartitionSubgraphs::INVALID_ID);
+    uint32_t degree;
+    const uint32_t *neighbors = view.out_neighbors(0, degree);
+    ASSERT_EQ(degree, 1u);
+    EXPECT_EQ(neighbors[0], 1u);
+}
+
+TEST_F(CompSearchTest, TraceRecordsStages)
+{
+    CompressedSearch comp(g, "Random");
+    comp.offline_industry(200, 0.3, "");
+    QueryTraceBuffer trace(64);
+    comp.set_query_trace(&trace);
+    for (int s = 0; s < n; s += 7)
+        comp.reachability_query(s, n - 1);
+    comp.set_query_trace(nullptr);
+#ifdef REACH_QUERY_TRACE
+    EXPECT_GT(trace.stage_count(QueryStage::EquivalenceMapping), 0u);
+#else
+    EXPECT_EQ(trace.total_records(), 0u);
+#endif
+}
+
+TEST(QueryTraceTest, RingOverwrite)
+{
+    QueryTraceBuffer trace(5);
+    EXPECT_EQ(trace.capacity(), 8u);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; i++)
+        trace.record(QueryStage::Filter, i, i + 1, TRACE_UNDECIDED, start);
+    EXPECT_EQ(trace.size(), 8u);
+    EXPECT_EQ(trace.total_records(), 10u);
+    // 最旧的两条被覆盖
+    EXPECT_EQ(trace.at(0).source, 2);
+    EXPECT_EQ(trace.at(7).source, 9);
+    EXPECT_EQ(trace.stage_count(QueryStage::Filter), 10u);
+    EXPECT_EQ(trace.stage_count(QueryStage::IntraIndexProbe), 0u);
+    trace.clear();
+    EXPECT_EQ(trace.size(), 0u);
+}
+
+TEST(QueryTraceTest, Callback)
+{
+    QueryTraceBuffer trace(4);
+    int calls = 0;
+    trace.set_callback([](const QueryTraceRecord &record, void *user_data)
+                       {
+                           if (record.stage == QueryStage::CrossPartitionSearch)
+                               ++*static_cast<int *>(user_data);
+                       },
+                       &calls);
+    auto start = std::chrono::steady_clock::now();
+    trace.record(QueryStage::CrossPartitionSearch, 0, 1, TRACE_REACHABLE, start);
+    trace.record(QueryStage::Filter, 0, 1, TRACE_UNDECIDED, start);
+    EXPECT_EQ(calls, 1);
+}
@@ -0,0 +1,471 @@
+#include "gtest/gtest.h"
+#include "graph.h"
+#include "CSR.h"
+#include "BiBFSCSR.h"
+#include "BidirectionalBFS.h"
+#include "CompressedCSR.h"
+#include "utils/TextParser.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <algorithm>
+
+// CSR 的文本和二进制读写，不依赖数据集文件
+class CSRIOTest : public ::testing::Test
+{
+protected:
+    Graph g{true};
+    int n = 200;
+    std::string text_file = ::testing::TempDir() + "test_csr_io_edges.txt";
+    std::string binary_file = ::testing::TempDir() + "test_csr_io_edges.csr";
+
+    virtual void SetUp()
+    {
+        std::mt19937 rng(31);
+        std::ofstream out(text_file);
+        for (int i = 0; i < 800; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            // 文本里保留自环和重复边，读进来要和 Graph::addEdge 的结果一样
+            out << u << " " << v << "\n";
+            if (i % 50 == 0)
+                out << u << " " << v << "\n";
+            g.addEdge(u, v);
+        }
+        g.vertices.resize(n);
+    }
+
+    virtual void TearDown()
+    {
+        std::remove(text_file.c_str());
+        std::remove(binary_file.c_str());
+    }
+
+    static void expect_same(const CSRGraph &a, const CSRGraph &b)
+    {
+        ASSERT_EQ(a.max_node_id, b.max_node_id);
+        ASSERT_EQ(a.num_edges, b.num_edges);
+        EXPECT_EQ(a.num_nodes, b.num_nodes);
+        for (uint32_t u = 0; u <= a.max_node_id + 1; u++)
+        {
+            ASSERT_EQ(a.out_row_pointers[u], b.out_row_pointers[u]) << u;
+            ASSERT_EQ(a.in_row_pointers[u], b.in_row_pointers[u]) << u;
+        }
+        for (uint32_t e = 0; e < a.num_edges; e++)
+        {
+            ASSERT_EQ(a.out_column_indices[e], b.out_column_indices[e]) << e;
+            ASSERT_EQ(a.in_column_indices[e], b.in_column_indices[e]) << e;
+        }
+        for (uint32_t u = 0; u <= a.max_node_id; u++)
+            ASSERT_EQ(a.partitions[u], b.partitions[u]) << u;
+    }
+};
+
+TEST_F(CSRIOTest, FromFileMatchesFromGraph)
+{
+    CSRGraph from_graph, from_file;
+    from_graph.fromGraph(g);
+    ASSERT_TRUE(from_file.fromFile(text_file));
+    expect_same(from_graph, from_file);
+}
+
+TEST_F(CSRIOTest, BinaryRoundTrip)
+{
+    CSRGraph csr;
+    csr.fromGraph(g);
+    csr.setPartition(3, 7);
+    ASSERT_TRUE(csr.saveBinary(binary_file));
+
+    CSRGraph mapped;
+    ASSERT_TRUE(mapped.fromBinary(binary_file));
+    EXPECT_TRUE(mapped.isMapped());
+    expect_same(csr, mapped);
+
+    // 私有映射，改分区号不会写回文件
+    mapped.setPartition(3, 9);
+    EXPECT_EQ(mapped.getPartition(3), 9);
+    CSRGraph again;
+    ASSERT_TRUE(again.fromBinary(binary_file));
+    EXPECT_EQ(again.getPartition(3), 7);
+
+    // 加边前会先复制到堆上
+    uint32_t u = 0, v = 1;
+    while (csr.getOutDegree(u) > 0 && u < csr.max_node_id)
+        u++;
+    mapped.addEdge(u, v);
+    EXPECT_FALSE(mapped.isMapped());
+    EXPECT_EQ(mapped.num_edges, csr.num_edges + 1);
+}
+
+TEST_F(CSRIOTest, RejectsOtherFiles)
+{
+    CSRGraph csr;
+    EXPECT_FALSE(csr.fromBinary(text_file));
+    EXPECT_FALSE(csr.fromBinary(binary_file));
+
+    // 最后一个出边行指针和边数对不上时不加载
+    CSRGraph source;
+    source.fromGraph(g);
+    ASSERT_TRUE(source.saveBinary(binary_file));
+    uint64_t out_row_offset;
+    {
+        std::ifstream in(binary_file, std::ios::binary);
+        in.seekg(32);
+        in.read(reinterpret_cast<char *>(&out_row_offset), sizeof(out_row_offset));
+    }
+    {
+        std::fstream io(binary_file, std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t bad = source.num_edges + 1000;
+        io.seekp(out_row_offset + uint64_t(source.max_node_id + 1) * sizeof(uint32_t));
+        io.write(reinterpret_cast<const char *>(&bad), sizeof(bad));
+    }
+    EXPECT_FALSE(csr.fromBinary(binary_file));
+
+    // 中间的行指针倒退，或者列号超过 max_node_id 时也不加载
+    auto corrupt = [&](uint64_t header_field, uint64_t index, uint32_t value) {
+        ASSERT_TRUE(source.saveBinary(binary_file));
+        uint64_t offset;
+        {
+            std::ifstream in(binary_file, std::ios::binary);
+            in.seekg(header_field);
+            in.read(reinterpret_cast<char *>(&offset), sizeof(offset));
+        }
+        std::fstream io(binary_file, std::ios::binary | std::ios::in | std::ios::out);
+        io.seekp(offset + index * sizeof(uint32_t));
+        io.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+    ASSERT_GT(source.num_edges, 0u);
+    corrupt(32, 1, source.num_edges + 1);
+    EXPECT_FALSE(csr.fromBinary(binary_file));
+    corrupt(48, 0, source.max_node_id + 1);
+    EXPECT_FALSE(csr.fromBinary(binary_file));
+    ASSERT_TRUE(source.saveBinary(binary_file));
+    EXPECT_TRUE(csr.fromBinary(binary_file));
+}
+
+TEST_F(CSRIOTest, SearchOnMappedCSR)
+{
+    CSRGraph csr;
+    csr.fromGraph(g);
+    ASSERT_TRUE(csr.saveBinary(binary_file));
+    auto mapped = std::make_shared<CSRGraph>();
+    ASSERT_TRUE(mapped->fromBinary(binary_file));
+
+    BiBFSCSR from_graph(g);
+    BiBFSCSR from_binary(mapped);
+    std::mt19937 rng(37);
+    for (int i = 0; i < 2000; i++)
+    {
+        int s = rng() % n, t = rng() % n;
+        EXPECT_EQ(from_binary.reachability_query(s, t), from_graph.reachability_query(s, t)) << s << " -> " << t;
+    }
+}
+
+// 按排序去重后的边表检查出边和入边的 CSR
+static void expect_matches_edges(const CSRGraph &csr, std::vector<std::pair<uint32_t, uint32_t>> edges)
+{
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [](const std::pair<uint32_t, uint32_t> &e)
+                               { return e.first == e.second; }),
+                edges.end());
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    ASSERT_EQ(csr.num_edges, edges.size());
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        ASSERT_GE(i, csr.out_row_pointers[edges[i].first]);
+        ASSERT_LT(i, csr.out_row_pointers[edges[i].first + 1]);
+        ASSERT_EQ(csr.out_column_indices[i], edges[i].second) << i;
+    }
+    for (auto &e : edges)
+        std::swap(e.first, e.second);
+    std::sort(edges.begin(), edges.end());
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        ASSERT_GE(i, csr.in_row_pointers[edges[i].first]);
+        ASSERT_LT(i, csr.in_row_pointers[edges[i].first + 1]);
+        ASSERT_EQ(csr.in_column_indices[i], edges[i].second) << i;
+    }
+}
+
+// 边数足够多时才会真的开多个线程；点号稀疏时走原子计数，稠密时走线程局部直方图
+TEST(CSRParallelBuildTest, MatchesSerialBuild)
+{
+    std::string path = ::testing::TempDir() + "test_csr_parallel_edges.txt";
+    for (uint32_t max_id : {50000u, 3000000u})
+    {
+        std::mt19937 rng(41);
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        {
+            std::ofstream out(path);
+            for (int i = 0; i < 600000; i++)
+            {
+                uint32_t u = rng() % max_id, v = i % 10 == 0 ? u : rng() % max_id;
+                edges.emplace_back(u, v);
+                out << u << " " << v << "\n";
+                // 重复边
+                if (i % 7 == 0)
+                {
+                    edges.emplace_back(u, v);
+                    out << u << " " << v << "\n";
+                }
+            }
+        }
+        CSRGraph serial, parallel;
+        ASSERT_TRUE(serial.fromFile(path, 1));
+        ASSERT_TRUE(parallel.fromFile(path, 8));
+
+        expect_matches_edges(serial, edges);
+        ASSERT_EQ(serial.max_node_id, parallel.max_node_id);
+        ASSERT_EQ(serial.num_nodes, parallel.num_nodes);
+        expect_matches_edges(parallel, edges);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(CSRParallelBuildTest, FromGraph)
+{
+    Graph g(true);
+    int n = 40000;
+    std::mt19937 rng(43);
+    for (int i = 0; i < 600000; i++)
+        g.addEdge(rng() % n, rng() % n);
+    g.vertices.resize(n);
+    g.vertices[5].partition_id = 3;
+
+    CSRGraph serial, parallel;
+    serial.fromGraph(g, 1);
+    parallel.fromGraph(g, 8);
+    EXPECT_EQ(parallel.getPartition(5), 3);
+    ASSERT_EQ(serial.num_edges, g.get_num_edges());
+    ASSERT_EQ(serial.max_node_id, parallel.max_node_id);
+    ASSERT_EQ(serial.num_edges, parallel.num_edges);
+    EXPECT_EQ(serial.num_nodes, parallel.num_nodes);
+    EXPECT_TRUE(std::equal(serial.out_row_pointers, serial.out_row_pointers + n + 1, parallel.out_row_pointers));
+    EXPECT_TRUE(std::equal(serial.in_row_pointers, serial.in_row_pointers + n + 1, parallel.in_row_pointers));
+    EXPECT_TRUE(std::equal(serial.out_column_indices, serial.out_column_indices + serial.num_edges, parallel.out_column_indices));
+    EXPECT_TRUE(std::equal(serial.in_column_indices, serial.in_column_indices + serial.num_edges, parallel.in_column_indices));
+    for (int u = 0; u < n; u += 97)
+    {
+        uint32_t degree;
+        uint32_t *out = parallel.getOutgoingEdges(u, degree);
+        ASSERT_EQ(degree, g.vertices[u].LOUT.size());
+        for (uint32_t i = 0; i < degree; i++)
+            EXPECT_EQ(static_cast<int>(out[i]), g.vertices[u].LOUT[i]);
+    }
+}
+
+// 随机增删边，动态模式下每行的内容、点数边数和搜索结果都要和 Graph 一致
+TEST_F(CSRIOTest, DynamicUpdates)
+{
+    auto csr = std::make_shared<CSRGraph>();
+    csr->fromGraph(g);
+    EXPECT_FALSE(csr->isDynamic());
+    std::mt19937 rng(47);
+    for (int i = 0; i < 20000; i++)
+    {
+        int u = rng() % n, v = rng() % n;
+        bool exists = std::binary_search(g.vertices[u].LOUT.begin(), g.vertices[u].LOUT.end(), v);
+        // 删边少一些，图会越来越稠密，中间会多次扩容
+        if (rng() % 3 == 0)
+        {
+            ASSERT_EQ(csr->removeEdge(u, v), exists) << u << " " << v;
+            if (exists)
+                g.removeEdge(u, v);
+        }
+        else
+        {
+            ASSERT_EQ(csr->addEdge(u, v), !exists && u != v) << u << " " << v;
+            g.addEdge(u, v);
+        }
+    }
+    EXPECT_TRUE(csr->isDynamic());
+    ASSERT_EQ(csr->num_edges, g.get_num_edges());
+    EXPECT_EQ(csr->num_nodes, csr->getNodesNum());
+    for (int u = 0; u < n; u++)
+    {
+        uint32_t degree;
+        uint32_t *out = csr->getOutgoingEdges(u, degree);
+        ASSERT_EQ(std::vector<int>(out, out + degree), g.vertices[u].LOUT) << u;
+        uint32_t *in = csr->getIncomingEdges(u, degree);
+        ASSERT_EQ(std::vector<int>(in, in + degree), g.vertices[u].LIN) << u;
+    }
+
+    BiBFSCSR on_graph(g);
+    BiBFSCSR on_dynamic(csr);
+    for (int i = 0; i < 2000; i++)
+    {
+        int s = rng() % n, t = rng() % n;
+        EXPECT_EQ(on_dynamic.reachability_query(s, t), on_graph.reachability_query(s, t)) << s << " -> " << t;
+    }
+
+    // 写文件和压紧之后和重新构建的结果一样
+    CSRGraph rebuilt;
+    rebuilt.fromGraph(g);
+    ASSERT_TRUE(csr->saveBinary(binary_file));
+    CSRGraph mapped;
+    ASSERT_TRUE(mapped.fromBinary(binary_file));
+    expect_same(rebuilt, mapped);
+    csr->compact();
+    EXPECT_FALSE(csr->isDynamic());
+    expect_same(rebuilt, *csr);
+}
+
+// 从空图开始流式插边，去掉重复边后 compact 的结果和插入的边集一致
+TEST(CSRDynamicTest, StreamingInserts)
+{
+    const uint32_t n = 200000;
+    CSRGraph csr;
+    csr.createEmptyCSR(n);
+    std::mt19937 rng(53);
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (int i = 0; i < 300000; i++)
+    {
+        uint32_t u = rng() % n, v = rng() % (n / 100);
+        if (csr.addEdge(u, v))
+            edges.emplace_back(u, v);
+    }
+
+    ASSERT_EQ(csr.num_edges, edges.size());
+    csr.compact();
+    expect_matches_edges(csr, edges);
+}
+
+// 压缩的 CSR 解压后不变，搜索结果和普通 CSR、邻接表一致
+TEST_F(CSRIOTest, CompressedCSR)
+{
+    CSRGraph csr;
+    csr.fromGraph(g);
+    csr.setPartition(4, 2);
+    auto compressed = std::make_shared<CompressedCSR>();
+    ASSERT_TRUE(compressed->fromCSR(csr));
+    EXPECT_EQ(compressed->num_edges, csr.num_edges);
+    EXPECT_EQ(compressed->getPartition(4), 2);
+    EXPECT_LT(compressed->getMemoryUsage(), csr.getMemoryUsage());
+    for (uint32_t u = 0; u <= csr.max_node_id; u++)
+    {
+        ASSERT_EQ(compressed->getOutDegree(u), csr.getOutDegree(u));
+        ASSERT_EQ(compressed->getInDegree(u), csr.getInDegree(u));
+        auto range = csr.outNeighbors(u);
+        std::vector<uint32_t> expected(range.begin(), range.end()), actual;
+        for (uint32_t v : compressed->outNeighbors(u))
+            actual.push_back(v);
+        ASSERT_EQ(actual, expected) << u;
+    }
+    CSRGraph restored;
+    compressed->toCSR(restored);
+    expect_same(csr, restored);
+
+    BiBFSCSR on_csr(g);
+    BiBFSCSR on_compressed(compressed);
+    BidirectionalBFS on_lists(g), on_compressed_lists(g);
+    on_compressed_lists.compress_adjacency();
+    std::mt19937 rng(61);
+    for (int i = 0; i < 2000; i++)
+    {
+        int s = rng() % n, t = rng() % n;
+        bool expected = on_csr.reachability_query(s, t);
+        ASSERT_EQ(on_compressed.reachability_query(s, t), expected) << s << " -> " << t;
+        ASSERT_EQ(on_compressed_lists.reachability_query(s, t), on_lists.reachability_query(s, t)) << s << " -> " << t;
+        ASSERT_EQ(on_compressed.findPath(s, t).empty(), !expected);
+        ASSERT_EQ(on_compressed_lists.findPath(s, t), on_lists.findPath(s, t));
+    }
+}
+
+// 点号跨度大的稀疏行需要多字节的 varint，动态模式的 CSR 也能直接压缩
+TEST(CompressedCSRTest, WideIdsAndDynamicSource)
+{
+    CSRGraph csr;
+    csr.createEmptyCSR(200000);
+    std::mt19937 rng(67);
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (int i = 0; i < 5000; i++)
+    {
+        uint32_t u = rng() % 200000, v = rng() % 200000;
+        if (csr.addEdge(u, v))
+            edges.emplace_back(u, v);
+    }
+    CompressedCSR compressed;
+    ASSERT_TRUE(compressed.fromCSR(csr));
+    CSRGraph restored;
+    compressed.toCSR(restored);
+    expect_matches_edges(restored, edges);
+}
+
+// 默认构造的 CSRGraph 没有行指针，压缩成空的，解压也不越界
+TEST(CompressedCSRTest, EmptySource)
+{
+    CSRGraph empty;
+    CompressedCSR compressed;
+    ASSERT_TRUE(compressed.fromCSR(empty));
+    EXPECT_EQ(compressed.num_edges, 0u);
+    EXPECT_EQ(compressed.getOutDegree(0), 0u);
+    EXPECT_TRUE(compressed.inNeighbors(0).empty());
+    EXPECT_EQ(compressed.getPartition(0), -1);
+    CSRGraph restored;
+    compressed.toCSR(restored);
+    EXPECT_EQ(restored.num_edges, 0u);
+    EXPECT_EQ(restored.getOutDegree(0), 0u);
+}
+
+// 注释、表头、制表符、逗号、\r\n 和末尾没有换行都能处理，和逐行 istringstream 的结果一致
+TEST(TextParserTest, EdgesAndRows)
+{
+    std::string file = ::testing::TempDir() + "test_text_parser.txt";
+    {
+        std::ofstream out(file);
+        out << "% header line\n# comment\n1 2\n3\t4\r\n5,6 0.5\n\n-1 7\n8\n9 10 11";
+    }
+    std::vector<std::pair<int, int>> edges;
+    ASSERT_TRUE(TextParser::parse_edges(file, edges));
+    std::vector<std::pair<int, int>> expected = {{1, 2}, {3, 4}, {5, 6}, {-1, 7}, {9, 10}};
+    EXPECT_EQ(edges, expected);
+
+    // 无符号时负数那一行跳过
+    std::vector<std::pair<uint32_t, uint32_t>> unsigned_edges;
+    ASSERT_TRUE(TextParser::parse_edges(file, unsigned_edges));
+    EXPECT_EQ(unsigned_edges.size(), 4u);
+
+    std::vector<size_t> offsets;
+    std::vector<int> values;
+    ASSERT_TRUE(TextParser::parse_rows(file, offsets, values));
+    std::vector<size_t> expected_offsets = {0, 2, 4, 7, 9, 10, 13};
+    std::vector<int> expected_values = {1, 2, 3, 4, 5, 6, 0, -1, 7, 8, 9, 10, 11};
+    EXPECT_EQ(offsets, expected_offsets);
+    EXPECT_EQ(values, expected_values);
+
+    std::remove(file.c_str());
+    EXPECT_FALSE(TextParser::parse_edges(file, edges));
+}
+
+// 大文件切成多块并行解析，结果和单线程的顺序完全一样，fromFile 和 readGraph 都走这条路径
+TEST(TextParserTest, ParallelMatchesSerial)
+{
+    std::string file = ::testing::TempDir() + "test_text_parser_large.txt";
+    std::mt19937 rng(97);
+    {
+        std::ofstream out(file);
+        for (int i = 0; i < 400000; i++)
+        {
+            out << rng() % 100000 << (i % 3 ? " " : "\t") << rng() % 100000 << "\n";
+            if (i % 1000 == 0)
+                out << "# " << i << "\n";
+        }
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> serial, parallel;
+    ASSERT_TRUE(TextParser::parse_edges(file, serial, 1));
+    ASSERT_TRUE(TextParser::parse_edges(file, parallel, 4));
+    ASSERT_EQ(serial.size(), 400000u);
+    EXPECT_EQ(serial, parallel);
+
+    std::vector<size_t> serial_offsets, parallel_offsets;
+    std::vector<uint32_t> serial_values, parallel_values;
+    ASSERT_TRUE(TextParser::parse_rows(file, serial_offsets, serial_values, 1));
+    ASSERT_TRUE(TextParser::parse_rows(file, parallel_offsets, parallel_values, 4));
+    EXPECT_EQ(serial_offsets, parallel_offsets);
+    EXPECT_EQ(serial_values, parallel_values);
+
+    CSRGraph csr;
+    ASSERT_TRUE(csr.fromFile(file, 4));
+    expect_matches_edges(csr, serial);
+    std::remove(file.c_str());
+}
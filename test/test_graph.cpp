@@ -1,7 +1,10 @@
 #include "gtest/gtest.h"
 #include "graph.h"
 #include "SetSearch.h"
+#include "PartitionManager.h"
+#include "partitioner/LouvainPartitioner.h"
 #include <algorithm>  // 确保包含算法库
+#include <random>
 #include "utils/InputHandler.h"
 #include "utils/OutputHandler.h"
 
@@ -41,4 +44,102 @@ TEST_F(GraphTest, setTest) {
     g.addEdge(0,1);
     SetSearch set_search(g);
 
-}
\ No newline at end of file
+}
+// 批量加边和逐条 addEdge 的结果一致，包括已有的边、自环和重复边
+TEST(GraphBulkLoadTest, MatchesAddEdge)
+{
+    std::mt19937 rng(59);
+    int n = 3000;
+    std::vector<std::pair<int, int>> first, second;
+    for (int i = 0; i < 40000; i++)
+    {
+        // 一半的边落在几个热点上
+        int u = i % 2 ? rng() % 5 : rng() % n, v = rng() % n;
+        (i < 10000 ? first : second).emplace_back(u, v);
+        if (i % 9 == 0)
+            second.emplace_back(u, v);
+    }
+    second.emplace_back(n + 10, n + 10);
+
+    Graph expected(true), loaded(true);
+    for (auto &e : first)
+        expected.addEdge(e.first, e.second);
+    for (auto &e : second)
+        expected.addEdge(e.first, e.second);
+    for (auto &e : first)
+        loaded.addEdge(e.first, e.second);
+    loaded.bulk_load(second, 4);
+
+    EXPECT_EQ(loaded.get_num_edges(), expected.get_num_edges());
+    EXPECT_EQ(loaded.get_num_vertices(), expected.get_num_vertices());
+    ASSERT_EQ(loaded.vertices.size(), static_cast<size_t>(n + 11));
+    for (size_t u = 0; u < expected.vertices.size(); u++)
+    {
+        ASSERT_EQ(loaded.vertices[u].LOUT, expected.vertices[u].LOUT) << u;
+        ASSERT_EQ(loaded.vertices[u].LIN, expected.vertices[u].LIN) << u;
+        EXPECT_EQ(loaded.vertices[u].out_degree, expected.vertices[u].out_degree);
+        EXPECT_EQ(loaded.vertices[u].in_degree, expected.vertices[u].in_degree);
+        EXPECT_EQ(loaded.adjList[u], expected.vertices[u].LOUT);
+        EXPECT_EQ(loaded.reverseAdjList[u], expected.vertices[u].LIN);
+    }
+}
+
+// 点集按列存储，vertices[u] 的写法和各列看到的是同一份数据
+TEST(GraphVertexTableTest, ColumnsMatchAccessor)
+{
+    Graph g;
+    g.addEdge(0, 1);
+    g.addEdge(0, 2);
+    g.addEdge(3, 1);
+    g.vertices.resize(6);
+    EXPECT_EQ(g.vertices.size(), 6u);
+    EXPECT_EQ(g.vertices.partition_ids[5], -1);
+    EXPECT_EQ(g.vertices.equivalences[5], VertexTable::NO_EQUIVALENCE);
+
+    g.vertices[0].partition_id = 2;
+    g.set_partition_id(3, 2);
+    g.vertices[4].equivalance = 1;
+    EXPECT_EQ(g.vertices.partition_ids[0], 2);
+    EXPECT_EQ(g.vertices.partition_ids[3], 2);
+    EXPECT_EQ(g.vertices.equivalences[4], 1u);
+    EXPECT_EQ(g.vertices.out_degrees[0], 2);
+    EXPECT_EQ(g.vertices.in_degrees[1], 2);
+    EXPECT_EQ(&g.vertices[0].LOUT, &g.vertices.out_edges[0]);
+    EXPECT_EQ(g.vertices[3].LOUT, std::vector<int>({1}));
+
+    // 遍历得到的是各列的引用，用 auto && 接，和原来 for (auto &vertex : vertices) 一样能改
+    int edges = 0;
+    for (auto &&vertex : g.vertices)
+    {
+        edges += vertex.out_degree;
+        vertex.partition_id = 7;
+    }
+    EXPECT_EQ(edges, 3);
+    EXPECT_EQ(std::count(g.vertices.partition_ids.begin(), g.vertices.partition_ids.end(), 7), 6);
+
+    // 整个图复制时各列一起复制
+    Graph copy = g;
+    copy.vertices[0].LOUT.clear();
+    EXPECT_EQ(g.vertices[0].LOUT.size(), 2u);
+}
+
+// 模块度增益里用的是目标分区的出度之和，不是 0
+TEST(LouvainPartitionerTest, GainUsesPartitionDegree)
+{
+    // 两个三角形 0-1-2 和 3-4-5，2 -> 3 相连，共 7 条边
+    Graph g;
+    std::vector<std::pair<int, int>> edges = {{0, 1}, {1, 2}, {2, 0}, {3, 4}, {4, 5}, {5, 3}, {2, 3}};
+    for (auto &[u, v] : edges)
+        g.addEdge(u, v);
+    for (int u = 0; u < 6; u++)
+        g.set_partition_id(u, u < 3 ? 0 : 1);
+    EXPECT_EQ(g.get_partition_degree(0), 4);
+    EXPECT_EQ(g.get_partition_degree(1), 3);
+
+    PartitionManager pm(g);
+    LouvainPartitioner louvain;
+    double m = 7.0;
+    // 点 2 出度 2 入度 1，连到分区 0 的边有 2 条，连到分区 1 的有 1 条
+    EXPECT_DOUBLE_EQ(louvain.compute_gain(2, 0, g, pm, m), 2.0 / m - 3.0 * 4 / (2.0 * m * m));
+    EXPECT_DOUBLE_EQ(louvain.compute_gain(2, 1, g, pm, m), 1.0 / m - 3.0 * 3 / (2.0 * m * m));
+}
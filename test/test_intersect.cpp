@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+#include "utils/SetIntersection.h"
+#include <algorithm>
+#include <random>
+#include <set>
+
+namespace
+{
+    // 生成 size 个不重复的升序元素，取值范围 [0, range)
+    std::vector<int> random_sorted_set(std::mt19937 &rng, size_t size, int range)
+    {
+        std::set<int> s;
+        std::uniform_int_distribution<int> dist(0, range - 1);
+        while (s.size() < size)
+            s.insert(dist(rng));
+        return std::vector<int>(s.begin(), s.end());
+    }
+
+    // 原来 PLL::query 里的双重循环，作为对比基线
+    bool nested_loop(const std::vector<int> &a, const std::vector<int> &b)
+    {
+        for (auto x : a)
+            for (auto y : b)
+                if (x == y)
+                    return true;
+        return false;
+    }
+}
+
+TEST(SetIntersectionTest, KernelsAgree)
+{
+    std::mt19937 rng(3);
+    for (int round = 0; round < 2000; round++)
+    {
+        size_t na = rng() % 40, nb = rng() % 40;
+        int range = 20 + rng() % 400;
+        auto a = random_sorted_set(rng, std::min<size_t>(na, range), range);
+        auto b = random_sorted_set(rng, std::min<size_t>(nb, range), range);
+        bool expected = nested_loop(a, b);
+        EXPECT_EQ(SetIntersection::intersect_scalar(a.data(), a.size(), b.data(), b.size()), expected);
+        EXPECT_EQ(SetIntersection::intersect(a, b), expected);
+#ifdef SET_INTERSECTION_X86
+        if (SetIntersection::has_sse())
+        {
+            EXPECT_EQ(SetIntersection::intersect_sse(a.data(), a.size(), b.data(), b.size()), expected);
+        }
+        if (SetIntersection::has_avx2())
+        {
+            EXPECT_EQ(SetIntersection::intersect_avx2(a.data(), a.size(), b.data(), b.size()), expected);
+        }
+#endif
+    }
+}
+
+TEST(SetIntersectionTest, ThresholdKernelsAgree)
+{
+    std::mt19937 rng(5);
+    for (int round = 0; round < 2000; round++)
+    {
+        auto ka = random_sorted_set(rng, rng() % 30, 200);
+        auto kb = random_sorted_set(rng, rng() % 30, 200);
+        std::vector<std::pair<int, int>> a, b;
+        for (auto k : ka)
+            a.emplace_back(k, rng() % 10);
+        for (auto k : kb)
+            b.emplace_back(k, rng() % 10);
+        int threshold = rng() % 10;
+        bool expected = SetIntersection::intersect_with_threshold_scalar(a.data(), a.size(), b.data(), b.size(), threshold);
+        EXPECT_EQ(SetIntersection::intersect_with_threshold(a, b, threshold), expected);
+    }
+}
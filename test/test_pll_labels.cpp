@@ -0,0 +1,390 @@
+#include "gtest/gtest.h"
+#include "graph.h"
+#include "pll.h"
+#include "LandmarkOrdering.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <random>
+
+namespace
+{
+    // n 个点 m 条随机边，dag 为真时边都从小号指向大号
+    void random_graph(Graph &g, int n, int m, bool dag, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<std::pair<int, int>> edges;
+        for (int i = 0; i < m; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            if (u == v)
+                continue;
+            if (dag && u > v)
+                std::swap(u, v);
+            edges.emplace_back(u, v);
+        }
+        g.set_max_node_id(n - 1);
+        g.bulk_load(edges);
+    }
+
+    std::vector<std::vector<uint8_t>> closure(const Graph &g)
+    {
+        int n = static_cast<int>(g.vertices.size());
+        std::vector<std::vector<uint8_t>> reach(n, std::vector<uint8_t>(n, 0));
+        for (int s = 0; s < n; s++)
+        {
+            std::vector<int> queue{s};
+            reach[s][s] = 1;
+            for (size_t head = 0; head < queue.size(); head++)
+            {
+                for (int v : g.vertices[queue[head]].LOUT)
+                {
+                    if (!reach[s][v])
+                    {
+                        reach[s][v] = 1;
+                        queue.push_back(v);
+                    }
+                }
+            }
+        }
+        return reach;
+    }
+
+    size_t label_count(const PLL &pll)
+    {
+        size_t total = 0;
+        for (size_t u = 0; u < pll.IN.size(); u++)
+            total += pll.IN[u].size() + pll.OUT[u].size();
+        return total;
+    }
+}
+
+// 分批并行构建的查询结果和逐个构建一致，不同线程数得到的标签完全一样
+TEST(PLLParallelTest, MatchesSequential)
+{
+    for (bool dag : {false, true})
+    {
+        SCOPED_TRACE(dag);
+        Graph g(true);
+        random_graph(g, 400, dag ? 1200 : 700, dag, dag ? 41 : 43);
+        auto reach = closure(g);
+
+        PLL sequential(g);
+        sequential.offline_industry();
+        PLL reference(g);
+        reference.buildPLLLabelsParallel(1);
+        for (int threads : {2, 3, 8})
+        {
+            PLL parallel(g);
+            parallel.buildPLLLabelsParallel(threads);
+            ASSERT_EQ(parallel.OUT.size(), reference.OUT.size());
+            for (size_t u = 0; u < g.vertices.size(); u++)
+            {
+                ASSERT_TRUE(std::is_sorted(parallel.IN[u].begin(), parallel.IN[u].end())) << u;
+                ASSERT_EQ(parallel.IN[u], reference.IN[u]) << threads << " threads, vertex " << u;
+                ASSERT_EQ(parallel.OUT[u], reference.OUT[u]) << threads << " threads, vertex " << u;
+            }
+        }
+
+        PLL parallel(g);
+        parallel.set_build_threads(4);
+        parallel.offline_industry();
+        for (int s = 0; s < 400; s++)
+        {
+            for (int t = 0; t < 400; t++)
+            {
+                bool expected = sequential.reachability_query(s, t);
+                ASSERT_EQ(parallel.reachability_query(s, t), expected) << s << " -> " << t;
+                // PLL 对没有出边的起点或没有入边的终点直接返回不可达，s == t 时也是
+                if (!g.vertices[s].LOUT.empty() && !g.vertices[t].LIN.empty())
+                {
+                    ASSERT_EQ(expected, reach[s][t] == 1) << s << " -> " << t;
+                }
+            }
+        }
+    }
+}
+
+// 标签存的是秩：每个点的标签严格升序，秩和点号能互换，查询结果和传递闭包一致
+TEST(PLLRankTest, LabelsAreAppendedInRankOrder)
+{
+    for (int threads : {1, 4})
+    {
+        SCOPED_TRACE(threads);
+        Graph g(true);
+        random_graph(g, 300, 600, false, 71);
+        auto reach = closure(g);
+        PLL pll(g);
+        pll.set_build_threads(threads);
+        pll.offline_industry();
+        for (int v = 0; v < 300; v++)
+        {
+            ASSERT_EQ(pll.landmark(pll.rank(v)), v);
+            ASSERT_TRUE(std::adjacent_find(pll.IN[v].begin(), pll.IN[v].end(), std::greater_equal<int>()) == pll.IN[v].end()) << v;
+            ASSERT_TRUE(std::adjacent_find(pll.OUT[v].begin(), pll.OUT[v].end(), std::greater_equal<int>()) == pll.OUT[v].end()) << v;
+        }
+        for (int s = 0; s < 300; s++)
+        {
+            for (int t = 0; t < 300; t++)
+            {
+                if (s != t && !g.vertices[s].LOUT.empty() && !g.vertices[t].LIN.empty())
+                {
+                    ASSERT_EQ(pll.reachability_query(s, t), reach[s][t] == 1) << s << " -> " << t;
+                }
+            }
+        }
+    }
+}
+
+// 位并行路标的查询结果和普通 PLL 一样，普通标签变少；逐个构建和分批并行构建都适用
+TEST(PLLBitParallelTest, MatchesPlainPLL)
+{
+    for (bool dag : {false, true})
+    {
+        SCOPED_TRACE(dag);
+        Graph g(true);
+        random_graph(g, 400, dag ? 1200 : 700, dag, dag ? 53 : 59);
+        PLL plain(g);
+        plain.offline_industry();
+        for (int roots : {1, 4, 16, 1000})
+        {
+            SCOPED_TRACE(roots);
+            for (int threads : {1, 4})
+            {
+                PLL bit_parallel(g);
+                bit_parallel.set_bit_parallel_roots(roots);
+                bit_parallel.set_build_threads(threads);
+                bit_parallel.offline_industry();
+                EXPECT_GT(bit_parallel.num_bit_parallel_roots(), 0);
+                EXPECT_LE(bit_parallel.num_bit_parallel_roots(), roots);
+                // 组太少时跳过组员会打乱路标顺序，标签数不一定更少
+                if (roots >= 16)
+                {
+                    EXPECT_LT(label_count(bit_parallel), label_count(plain));
+                }
+                for (int s = 0; s < 400; s++)
+                {
+                    for (int t = 0; t < 400; t++)
+                        ASSERT_EQ(bit_parallel.reachability_query(s, t), plain.reachability_query(s, t)) << s << " -> " << t;
+                }
+            }
+        }
+    }
+}
+
+// 每种路标点顺序都是有边的点的一个排列，建出的 PLL 查询结果和传递闭包一致
+TEST(LandmarkOrderingTest, AllStrategiesGiveCorrectLabels)
+{
+    for (bool dag : {false, true})
+    {
+        SCOPED_TRACE(dag);
+        Graph g(true);
+        random_graph(g, 300, dag ? 900 : 500, dag, dag ? 73 : 79);
+        auto reach = closure(g);
+        std::vector<int> with_edges;
+        for (int v = 0; v < 300; v++)
+        {
+            if (!g.vertices[v].LOUT.empty() || !g.vertices[v].LIN.empty())
+                with_edges.push_back(v);
+        }
+        for (auto strategy : LandmarkOrdering::all())
+        {
+            SCOPED_TRACE(LandmarkOrdering::name(strategy));
+            LandmarkOrdering::Strategy parsed;
+            ASSERT_TRUE(LandmarkOrdering::parse(LandmarkOrdering::name(strategy), parsed));
+            EXPECT_EQ(parsed, strategy);
+
+            std::vector<int> order = LandmarkOrdering::compute(g, strategy, 64, 1, 2);
+            std::vector<int> sorted = order;
+            std::sort(sorted.begin(), sorted.end());
+            ASSERT_EQ(sorted, with_edges);
+
+            PLL pll(g);
+            pll.set_landmark_strategy(strategy);
+            pll.offline_industry();
+            for (int s = 0; s < 300; s++)
+            {
+                for (int t = 0; t < 300; t++)
+                {
+                    if (s != t && !g.vertices[s].LOUT.empty() && !g.vertices[t].LIN.empty())
+                    {
+                        ASSERT_EQ(pll.reachability_query(s, t), reach[s][t] == 1) << s << " -> " << t;
+                    }
+                }
+            }
+        }
+
+        // 指定的顺序不全时补上其余有边的点，越界和重复的点去掉
+        std::vector<int> partial{with_edges.back(), -1, 100000, with_edges.back(), with_edges.front()};
+        std::vector<int> completed = LandmarkOrdering::complete(g, partial);
+        ASSERT_EQ(completed.size(), with_edges.size());
+        EXPECT_EQ(completed[0], with_edges.back());
+        EXPECT_EQ(completed[1], with_edges.front());
+        PLL custom(g);
+        custom.set_landmark_order(partial);
+        custom.offline_industry();
+        for (int s = 0; s < 300; s++)
+        {
+            for (int t = 0; t < 300; t++)
+            {
+                if (s != t && !g.vertices[s].LOUT.empty() && !g.vertices[t].LIN.empty())
+                {
+                    ASSERT_EQ(custom.reachability_query(s, t), reach[s][t] == 1) << s << " -> " << t;
+                }
+            }
+        }
+    }
+}
+
+// evaluate 的标签数和可达数和单独建的 PLL 一致，各种顺序可达数相同；format_report 每种顺序一行，表头在第一行
+TEST(LandmarkOrderingTest, ReportListsEveryStrategy)
+{
+    Graph g(true);
+    random_graph(g, 200, 500, false, 113);
+    std::mt19937 rng(127);
+    std::vector<std::pair<int, int>> queries;
+    for (int i = 0; i < 500; i++)
+        queries.emplace_back(rng() % 200, rng() % 200);
+    auto strategies = LandmarkOrdering::all();
+    auto evaluations = LandmarkOrdering::evaluate(g, strategies, queries);
+    ASSERT_EQ(evaluations.size(), strategies.size());
+    auto lines = LandmarkOrdering::format_report(evaluations);
+    ASSERT_EQ(lines.size(), strategies.size() + 1);
+    EXPECT_EQ(lines[0], "strategy  labels  bytes  order_ms  build_ms  query_ns  reachable");
+    for (size_t i = 0; i < strategies.size(); i++)
+    {
+        SCOPED_TRACE(LandmarkOrdering::name(strategies[i]));
+        PLL pll(g);
+        pll.set_landmark_strategy(strategies[i]);
+        pll.offline_industry();
+        EXPECT_EQ(evaluations[i].strategy, strategies[i]);
+        EXPECT_EQ(evaluations[i].labels, label_count(pll));
+        EXPECT_EQ(evaluations[i].bytes, label_count(pll) * sizeof(int));
+        size_t reachable = 0;
+        for (const auto &query : queries)
+            reachable += pll.reachability_query(query.first, query.second);
+        EXPECT_EQ(evaluations[i].reachable, reachable);
+        EXPECT_EQ(evaluations[i].reachable, evaluations[0].reachable);
+        std::string suffix = "  " + std::to_string(reachable);
+        ASSERT_GE(lines[i + 1].size(), suffix.size());
+        EXPECT_EQ(lines[i + 1].substr(lines[i + 1].size() - suffix.size()), suffix) << lines[i + 1];
+        std::string prefix = std::string(LandmarkOrdering::name(strategies[i])) + "  " +
+                             std::to_string(evaluations[i].labels) + "  " + std::to_string(evaluations[i].bytes) + "  ";
+        EXPECT_EQ(lines[i + 1].compare(0, prefix.size(), prefix), 0) << lines[i + 1];
+    }
+}
+
+// 压缩后、写文件再 mmap 加载后的查询结果都和原来的标签一样，位并行的字也跟着保存
+TEST(PLLLabelStoreTest, CompressSaveAndLoad)
+{
+    std::string file = ::testing::TempDir() + "test_pll_labels.pll";
+    for (int roots : {0, 4})
+    {
+        SCOPED_TRACE(roots);
+        Graph g(true);
+        random_graph(g, 400, 900, false, 101);
+        PLL plain(g);
+        plain.set_bit_parallel_roots(roots);
+        plain.offline_industry();
+        ASSERT_TRUE(plain.save_labels(file));
+        EXPECT_FALSE(plain.labels_compressed());
+
+        PLL compressed(g);
+        compressed.set_bit_parallel_roots(roots);
+        compressed.offline_industry();
+        compressed.compress_labels();
+        EXPECT_TRUE(compressed.labels_compressed());
+        EXPECT_TRUE(compressed.IN.empty());
+
+        PLL loaded(g);
+        ASSERT_TRUE(loaded.load_labels(file));
+        EXPECT_EQ(loaded.num_bit_parallel_roots(), plain.num_bit_parallel_roots());
+        for (int v = 0; v < 400; v++)
+        {
+            std::vector<int> in, out;
+            loaded.for_each_in_label(v, [&](int r) { in.push_back(r); });
+            loaded.for_each_out_label(v, [&](int r) { out.push_back(r); });
+            ASSERT_EQ(in, plain.IN[v]) << v;
+            ASSERT_EQ(out, plain.OUT[v]) << v;
+            ASSERT_EQ(loaded.landmark(plain.rank(v)), v);
+        }
+        for (int s = 0; s < 400; s++)
+        {
+            for (int t = 0; t < 400; t++)
+            {
+                bool expected = plain.reachability_query(s, t);
+                ASSERT_EQ(compressed.reachability_query(s, t), expected) << s << " -> " << t;
+                ASSERT_EQ(loaded.reachability_query(s, t), expected) << s << " -> " << t;
+            }
+        }
+
+        // 压缩后的标签和偏移比原来的 vector 省内存，差值编码本身也比每个秩 4 字节小；位并行的字两边都原样存，不算
+        size_t vector_bytes = 0;
+        for (size_t v = 0; v < plain.IN.size(); v++)
+            vector_bytes += (plain.IN[v].capacity() + plain.OUT[v].capacity()) * sizeof(int) + 2 * sizeof(std::vector<int>);
+        size_t label_bytes = 0, offset_bytes = 0;
+        for (const auto &entry : compressed.getIndexSizes())
+        {
+            if (entry.first == "compressed_labels")
+                label_bytes = std::stoull(entry.second);
+            if (entry.first == "compressed_offsets")
+                offset_bytes = std::stoull(entry.second);
+        }
+        EXPECT_LT(label_bytes + offset_bytes, vector_bytes);
+        EXPECT_LT(label_bytes, label_count(plain) * sizeof(int));
+
+        // 压缩或加载之后秩不再保存，重新建标签时丢掉压缩的标签，结果和原来一样
+        EXPECT_EQ(compressed.rank(0), -1);
+        EXPECT_EQ(loaded.rank(0), -1);
+        for (PLL *rebuilt : {&compressed, &loaded})
+        {
+            rebuilt->set_bit_parallel_roots(roots);
+            rebuilt->offline_industry();
+            EXPECT_FALSE(rebuilt->labels_compressed());
+            EXPECT_EQ(rebuilt->IN, plain.IN);
+            EXPECT_EQ(rebuilt->OUT, plain.OUT);
+            EXPECT_EQ(rebuilt->rank(7), plain.rank(7));
+        }
+
+        // 偏移倒退或者一行的最后一个字节还带续位时加载失败，不会解码越界
+        auto read_u64 = [&](std::fstream &f, uint64_t pos) {
+            uint64_t value;
+            f.seekg(pos);
+            f.read(reinterpret_cast<char *>(&value), sizeof(value));
+            return value;
+        };
+        {
+            std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+            uint64_t in_offsets_offset = read_u64(f, 40);
+            uint64_t huge = uint64_t(1) << 40;
+            f.seekp(in_offsets_offset + sizeof(uint64_t));
+            f.write(reinterpret_cast<const char *>(&huge), sizeof(huge));
+        }
+        PLL corrupted(g);
+        EXPECT_FALSE(corrupted.load_labels(file));
+        ASSERT_TRUE(plain.save_labels(file));
+        {
+            std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+            uint64_t in_size = read_u64(f, 24);
+            uint64_t in_bytes_offset = read_u64(f, 56);
+            ASSERT_GT(in_size, 0u);
+            char last;
+            f.seekg(in_bytes_offset + in_size - 1);
+            f.read(&last, 1);
+            last = static_cast<char>(last | 0x80);
+            f.seekp(in_bytes_offset + in_size - 1);
+            f.write(&last, 1);
+        }
+        EXPECT_FALSE(corrupted.load_labels(file));
+    }
+
+    // 点数不一致或者不是标签文件时加载失败
+    Graph other(true);
+    random_graph(other, 100, 200, false, 103);
+    PLL mismatched(other);
+    EXPECT_FALSE(mismatched.load_labels(file));
+    std::ofstream(file) << "not a label file\n";
+    EXPECT_FALSE(mismatched.load_labels(file));
+    std::remove(file.c_str());
+}
@@ -0,0 +1,235 @@
+#include "gtest/gtest.h"
+#include "graph.h"
+#include "CSR.h"
+#include "SCCCondenser.h"
+#include "EquivalenceMapping.h"
+#include "PartitionManager.h"
+#include "BidirectionalBFS.h"
+#include "CompressedSearch.h"
+#include <random>
+#include <fstream>
+#include <cstdio>
+
+// 随机有环图，强连通分量和压缩结果都要和BFS一致，不依赖数据集文件
+class SCCTest : public ::testing::Test
+{
+protected:
+    Graph g{true};
+    CSRGraph csr;
+    int n = 300;
+
+    virtual void SetUp()
+    {
+        std::mt19937 rng(23);
+        for (int i = 0; i < 900; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            if (u < v)
+                g.addEdge(u, v);
+            else if (v < u)
+                g.addEdge(v, u);
+        }
+        // 跨度较小的反向边形成环
+        for (int i = 0; i < 60; i++)
+        {
+            int u = rng() % n, span = 1 + rng() % 30;
+            if (u >= span)
+                g.addEdge(u, u - span);
+        }
+        g.vertices.resize(n);
+        csr.fromGraph(g);
+    }
+
+    // 从 source 出发能到达的点
+    std::vector<bool> reachable_from(const Graph &graph, int source)
+    {
+        std::vector<bool> visited(graph.vertices.size(), false);
+        std::vector<int> queue = {source};
+        visited[source] = true;
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            for (int w : graph.vertices[queue[head]].LOUT)
+            {
+                if (!visited[w])
+                {
+                    visited[w] = true;
+                    queue.push_back(w);
+                }
+            }
+        }
+        return visited;
+    }
+};
+
+TEST_F(SCCTest, TarjanMatchesMutualReachability)
+{
+    std::vector<uint32_t> component;
+    uint32_t num_components = SCCCondenser::tarjan(csr, component);
+    ASSERT_EQ(component.size(), static_cast<size_t>(n));
+
+    std::vector<std::vector<bool>> reach(n);
+    for (int u = 0; u < n; u++)
+        reach[u] = reachable_from(g, u);
+    uint32_t representatives = 0;
+    for (int u = 0; u < n; u++)
+    {
+        representatives += component[u] == static_cast<uint32_t>(u);
+        uint32_t smallest = u;
+        for (int v = 0; v < n; v++)
+        {
+            bool same = reach[u][v] && reach[v][u];
+            EXPECT_EQ(component[u] == component[v], same) << u << " " << v;
+            if (same)
+                smallest = std::min<uint32_t>(smallest, v);
+        }
+        // 代表点是分量内最小的点号
+        EXPECT_EQ(component[u], smallest);
+    }
+    EXPECT_EQ(num_components, representatives);
+    EXPECT_LT(num_components, static_cast<uint32_t>(n));
+}
+
+TEST_F(SCCTest, ForwardBackwardMatchesTarjan)
+{
+    std::vector<uint32_t> expected, component;
+    uint32_t expected_count = SCCCondenser::tarjan(csr, expected);
+    for (int threads : {1, 4})
+    {
+        uint32_t count = SCCCondenser::forward_backward(csr, component, threads);
+        EXPECT_EQ(count, expected_count);
+        EXPECT_EQ(component, expected);
+    }
+}
+
+// 很长的环，递归实现会爆栈
+TEST(SCCLongCycleTest, Iterative)
+{
+    Graph g(true);
+    int n = 200000;
+    for (int u = 0; u < n; u++)
+        g.addEdge(u, (u + 1) % n);
+    CSRGraph csr;
+    csr.fromGraph(g);
+    std::vector<uint32_t> component;
+    EXPECT_EQ(SCCCondenser::tarjan(csr, component), 1u);
+    for (int u = 0; u < n; u++)
+        ASSERT_EQ(component[u], 0u);
+}
+
+TEST_F(SCCTest, CondensePreservesReachability)
+{
+    std::vector<uint32_t> component;
+    SCCCondenser::tarjan(csr, component);
+    Graph dag(true);
+    SCCCondenser::condense(csr, component, dag);
+    CSRGraph dag_csr;
+    SCCCondenser::condense(csr, component, dag_csr);
+    EXPECT_FALSE(dag.hasCycle());
+    EXPECT_EQ(dag_csr.num_edges, dag.get_num_edges());
+
+    for (int u = 0; u < n; u++)
+    {
+        uint32_t degree;
+        uint32_t *out = dag_csr.getOutgoingEdges(u, degree);
+        ASSERT_EQ(degree, dag.vertices[u].LOUT.size());
+        for (uint32_t i = 0; i < degree; i++)
+            EXPECT_EQ(static_cast<int>(out[i]), dag.vertices[u].LOUT[i]);
+        if (component[u] != static_cast<uint32_t>(u))
+        {
+            EXPECT_TRUE(dag.vertices[u].LOUT.empty() && dag.vertices[u].LIN.empty());
+        }
+    }
+    for (int u = 0; u < n; u += 7)
+    {
+        auto expected = reachable_from(g, u);
+        auto actual = reachable_from(dag, component[u]);
+        for (int v = 0; v < n; v++)
+            EXPECT_EQ(actual[component[v]], expected[v]) << u << " -> " << v;
+    }
+}
+
+// 原图直接压缩后交给 CompressedSearch，等价信息不经过文件
+TEST_F(SCCTest, CompressedSearchFromRawGraph)
+{
+    std::vector<uint32_t> component;
+    SCCCondenser::forward_backward(csr, component, 4);
+    Graph dag(true);
+    SCCCondenser::condense(csr, component, dag);
+
+    BidirectionalBFS bfs(g);
+    CompressedSearch comp(dag, "Random");
+    comp.offline_industry(200, 0.3, component);
+    std::mt19937 rng(29);
+    for (int i = 0; i < 3000; i++)
+    {
+        int s = rng() % n, t = rng() % n;
+        EXPECT_EQ(comp.reachability_query(s, t), bfs.reachability_query(s, t)) << s << " -> " << t;
+    }
+}
+
+TEST(EquivalenceMappingTest, FlatArray)
+{
+    // 3 号点没有记录，5 号点越界，都按自身处理；数组比点数短的部分补成自身
+    std::vector<uint32_t> representative = {0, 0, 2, EquivalenceMapping::UNRECORDED, 2, 100};
+    EquivalenceMapping mapping;
+    mapping.assign(representative, 8);
+    ASSERT_EQ(mapping.size(), 8u);
+    std::vector<uint32_t> expected = {0, 0, 2, 3, 2, 5, 6, 7};
+    for (uint32_t u = 0; u < 8; u++)
+        EXPECT_EQ(mapping[u], expected[u]);
+    EXPECT_EQ(mapping.getMemoryUsage(), 8 * sizeof(uint32_t));
+}
+
+TEST_F(SCCTest, EquivalenceBinaryRoundTrip)
+{
+    std::vector<uint32_t> component;
+    SCCCondenser::tarjan(csr, component);
+    EquivalenceMapping mapping;
+    mapping.assign(component);
+    std::string path = ::testing::TempDir() + "test_scc_equivalence.bin";
+    ASSERT_TRUE(mapping.save_binary(path));
+
+    // 二进制文件通过 read_equivalance_info 读入时直接 mmap
+    Graph dag(true);
+    SCCCondenser::condense(csr, component, dag);
+    PartitionManager pm(dag);
+    EXPECT_FALSE(pm.has_equivalence_info());
+    EXPECT_EQ(pm.get_equivalence_mapping_size(), pm.equivalence_mapping.size() * sizeof(uint32_t));
+    EXPECT_EQ(pm.get_equivalance_mapping(5), 5u);
+    pm.read_equivalance_info(path);
+    EXPECT_TRUE(pm.has_equivalence_info());
+    EXPECT_TRUE(pm.equivalence_mapping.is_mapped());
+    for (int u = 0; u < n; u++)
+        ASSERT_EQ(pm.get_equivalance_mapping(u), component[u]);
+
+    // 点数比图少的二进制文件不加载，也不拷到堆上补全，映射保持恒等
+    EquivalenceMapping short_mapping;
+    short_mapping.identity(2);
+    ASSERT_TRUE(short_mapping.save_binary(path));
+    PartitionManager short_pm(dag);
+    short_pm.read_equivalance_info(path);
+    EXPECT_FALSE(short_pm.has_equivalence_info());
+    EXPECT_FALSE(short_pm.equivalence_mapping.is_mapped());
+    EXPECT_EQ(short_pm.equivalence_mapping.size(), dag.vertices.size());
+    EXPECT_EQ(short_pm.get_equivalance_mapping(n - 1), static_cast<uint32_t>(n - 1));
+
+    // 文件头不对时不加载
+    EquivalenceMapping broken;
+    {
+        std::ofstream out(path);
+        out << "0 0\n1 0\n";
+    }
+    EXPECT_FALSE(broken.load_binary(path));
+
+    // 点数乘 4 溢出成 0 的文件头也不加载
+    {
+        std::ofstream out(path, std::ios::binary);
+        uint32_t version = 1;
+        uint64_t num_vertices = 1ull << 62;
+        out.write("RCEQ", 4);
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char *>(&num_vertices), sizeof(num_vertices));
+    }
+    EXPECT_FALSE(broken.load_binary(path));
+    std::remove(path.c_str());
+}
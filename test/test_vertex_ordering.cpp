@@ -0,0 +1,210 @@
+#include "gtest/gtest.h"
+#include "graph.h"
+#include "CSR.h"
+#include "pll.h"
+#include "BiBFSCSR.h"
+#include "VertexOrdering.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+
+namespace
+{
+    const VertexOrdering::Strategy ALL_STRATEGIES[] = {
+        VertexOrdering::Strategy::IDENTITY, VertexOrdering::Strategy::DEGREE, VertexOrdering::Strategy::RCM,
+        VertexOrdering::Strategy::BFS, VertexOrdering::Strategy::PARTITION};
+
+    // rows x cols 的网格，边指向右和下，再加少量随机的长边，点号随机打乱，和真实边集一样没有局部性
+    void shuffled_grid(Graph &g, int rows, int cols, int extra, unsigned seed)
+    {
+        int n = rows * cols;
+        std::mt19937 rng(seed);
+        std::vector<int> label(n);
+        std::iota(label.begin(), label.end(), 0);
+        std::shuffle(label.begin(), label.end(), rng);
+        std::vector<std::pair<int, int>> edges;
+        for (int r = 0; r < rows; r++)
+        {
+            for (int c = 0; c < cols; c++)
+            {
+                int u = r * cols + c;
+                if (c + 1 < cols)
+                    edges.emplace_back(label[u], label[u + 1]);
+                if (r + 1 < rows)
+                    edges.emplace_back(label[u], label[u + cols]);
+            }
+        }
+        for (int i = 0; i < extra; i++)
+        {
+            int u = rng() % n, v = rng() % n;
+            edges.emplace_back(label[std::min(u, v)], label[std::max(u, v)]);
+        }
+        g.bulk_load(edges);
+        for (int u = 0; u < n; u++)
+            g.set_partition_id(label[u], u / cols * 4 / rows);
+    }
+
+    // 邻接矩阵的带宽：所有边两端点号之差的最大值
+    uint32_t bandwidth(const CSRGraph &csr)
+    {
+        uint32_t result = 0;
+        for (uint32_t u = 0; u <= csr.max_node_id; u++)
+        {
+            for (uint32_t v : csr.outNeighbors(u))
+                result = std::max(result, u > v ? u - v : v - u);
+        }
+        return result;
+    }
+}
+
+class VertexOrderingTest : public ::testing::Test
+{
+protected:
+    Graph g{true};
+    CSRGraph csr;
+    int rows = 30, cols = 40;
+
+    virtual void SetUp()
+    {
+        shuffled_grid(g, rows, cols, 50, 71);
+        // 留几个孤立点，它们应该排在最后
+        g.vertices.resize(rows * cols + 5);
+        csr.fromGraph(g);
+    }
+};
+
+// 每种顺序都是排列，重新编号后的 CSR 和原图同构，分区号跟着点走
+TEST_F(VertexOrderingTest, RelabelIsIsomorphic)
+{
+    for (auto strategy : ALL_STRATEGIES)
+    {
+        SCOPED_TRACE(VertexOrdering::name(strategy));
+        VertexOrdering ordering;
+        ordering.compute(csr, strategy);
+        ASSERT_EQ(ordering.size(), csr.max_node_id + 1);
+        CSRGraph relabeled;
+        ASSERT_TRUE(ordering.apply(csr, relabeled));
+        EXPECT_EQ(relabeled.num_edges, csr.num_edges);
+        EXPECT_EQ(relabeled.num_nodes, csr.num_nodes);
+        for (uint32_t u = 0; u <= csr.max_node_id; u++)
+        {
+            uint32_t r = ordering.to_internal(u);
+            ASSERT_EQ(ordering.to_external(r), u);
+            ASSERT_EQ(relabeled.getPartition(r), csr.getPartition(u));
+            std::vector<uint32_t> expected;
+            for (uint32_t v : csr.outNeighbors(u))
+                expected.push_back(ordering.to_internal(v));
+            std::sort(expected.begin(), expected.end());
+            auto range = relabeled.outNeighbors(r);
+            ASSERT_EQ(std::vector<uint32_t>(range.begin(), range.end()), expected) << u;
+            ASSERT_EQ(relabeled.getInDegree(r), csr.getInDegree(u)) << u;
+        }
+        if (strategy != VertexOrdering::Strategy::IDENTITY)
+        {
+            for (uint32_t r = rows * cols; r <= csr.max_node_id; r++)
+                EXPECT_FALSE(relabeled.nodeExist(r)) << r;
+        }
+    }
+}
+
+TEST_F(VertexOrderingTest, OrderProperties)
+{
+    VertexOrdering degree, rcm, partition;
+    degree.compute(csr, VertexOrdering::Strategy::DEGREE);
+    rcm.compute(csr, VertexOrdering::Strategy::RCM);
+    partition.compute(csr, VertexOrdering::Strategy::PARTITION);
+
+    CSRGraph by_degree, by_rcm, by_partition;
+    degree.apply(csr, by_degree);
+    rcm.apply(csr, by_rcm);
+    partition.apply(csr, by_partition);
+    for (uint32_t r = 0; r < by_degree.max_node_id; r++)
+    {
+        ASSERT_GE(by_degree.getOutDegree(r) + by_degree.getInDegree(r),
+                  by_degree.getOutDegree(r + 1) + by_degree.getInDegree(r + 1));
+        ASSERT_LE(by_partition.getPartition(r) < 0 ? 1 << 15 : by_partition.getPartition(r),
+                  by_partition.getPartition(r + 1) < 0 ? 1 << 15 : by_partition.getPartition(r + 1));
+    }
+    // 打乱之后带宽接近点数，RCM 应该把它压回网格宽度的量级
+    EXPECT_LT(bandwidth(by_rcm) * 4, bandwidth(csr));
+}
+
+TEST_F(VertexOrderingTest, SaveAndLoad)
+{
+    std::string file = ::testing::TempDir() + "test_vertex_ordering.perm";
+    VertexOrdering ordering, loaded;
+    ordering.compute(csr, VertexOrdering::Strategy::RCM);
+    ASSERT_TRUE(ordering.save_binary(file));
+    ASSERT_TRUE(loaded.load_binary(file));
+    EXPECT_EQ(loaded.new_to_old(), ordering.new_to_old());
+    EXPECT_EQ(loaded.old_to_new(), ordering.old_to_new());
+
+    // 不是排列时拒绝，内容不变
+    EXPECT_FALSE(loaded.assign({0, 0, 1}));
+    EXPECT_EQ(loaded.size(), ordering.size());
+
+    // 文件头里的点数比文件内容多时拒绝，不按它分配内存
+    {
+        std::ofstream out(file, std::ios::binary);
+        uint32_t version = 1;
+        uint64_t num_vertices = UINT32_MAX;
+        out.write("RCPM", 4);
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char *>(&num_vertices), sizeof(num_vertices));
+    }
+    EXPECT_FALSE(loaded.load_binary(file));
+    EXPECT_EQ(loaded.size(), ordering.size());
+    std::remove(file.c_str());
+    EXPECT_FALSE(loaded.load_binary(file));
+
+    VertexOrdering::Strategy strategy;
+    EXPECT_TRUE(VertexOrdering::parse("rcm", strategy));
+    EXPECT_EQ(strategy, VertexOrdering::Strategy::RCM);
+    EXPECT_FALSE(VertexOrdering::parse("random", strategy));
+}
+
+// 在重排后的图上建索引，用外部点号查询的结果和原图一致，路径转回外部点号后是原图里的路径
+TEST_F(VertexOrderingTest, TransparentQueries)
+{
+    auto ordering = std::make_shared<VertexOrdering>();
+    ordering->compute(csr, VertexOrdering::Strategy::BFS);
+    auto relabeled = std::make_shared<CSRGraph>();
+    ASSERT_TRUE(ordering->apply(csr, *relabeled));
+    Graph relabeled_graph{true};
+    ASSERT_TRUE(ordering->apply(g, relabeled_graph));
+    ASSERT_EQ(relabeled_graph.get_num_edges(), g.get_num_edges());
+
+    BiBFSCSR plain(g);
+    ReorderedAlgorithm bibfs(ordering, std::make_unique<BiBFSCSR>(relabeled));
+    ReorderedAlgorithm pll(ordering, std::make_unique<PLL>(relabeled_graph));
+    pll.offline_industry();
+
+    std::mt19937 rng(73);
+    int n = static_cast<int>(g.vertices.size());
+    std::vector<std::pair<int, int>> queries;
+    for (int i = 0; i < 3000; i++)
+        queries.emplace_back(rng() % n, rng() % n);
+    std::vector<uint8_t> batch;
+    bibfs.reachability_query_batch(queries, batch, 2);
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        int s = queries[i].first, t = queries[i].second;
+        bool expected = plain.reachability_query(s, t);
+        ASSERT_EQ(bibfs.reachability_query(s, t), expected) << s << " -> " << t;
+        ASSERT_EQ(pll.reachability_query(s, t), expected) << s << " -> " << t;
+        ASSERT_EQ(batch[i], expected ? 1 : 0);
+        if (expected && s != t)
+        {
+            auto path = static_cast<BiBFSCSR &>(bibfs.inner()).findPath(ordering->to_internal(s), ordering->to_internal(t));
+            ordering->to_external(path);
+            ASSERT_FALSE(path.empty());
+            EXPECT_EQ(path.front(), s);
+            EXPECT_EQ(path.back(), t);
+            for (size_t k = 0; k + 1 < path.size(); k++)
+                ASSERT_TRUE(g.hasEdge(path[k], path[k + 1])) << path[k] << " -> " << path[k + 1];
+        }
+    }
+}